@@ -5,6 +5,8 @@
 #include "front/ErrorStream.h"
 #include "common/string.h"
 #include "common/stacktrace.h"
+#include "common/stats.h"
+#include "common/content_hash.h"
 #include "execute/execute.h"
 #include "runtime/builtins.h"
 #include "cxxopts.h"
@@ -17,6 +19,7 @@
 #include <linenoise.h>
 #include <cstring>
 #include <fstream>
+#include <sstream>
 
 //static const char* examples[] = {
 //        "db", "hello", "hallo", "hans", "hansekogge", "seamann", "quetzalcoatl", "quit", "power", NULL
@@ -46,16 +49,75 @@ enum class Action : unsigned char {
 
 Action DesiredAction = Action::RunInteractive;
 std::string StartScriptFilename;
+//Modules that are compiled and executed before StartScriptFilename, in order.
+std::vector<std::string> LibraryFilenames;
+unsigned JobCount = 0;
+std::string ModuleCacheDirectory;
+anode::front::ast::FloatingPointMode FloatingPointMode = anode::front::ast::FloatingPointMode::Precise;
+unsigned OptimizationLevel = 0;
+bool TimePasses = false;
+bool ShowStatistics = false;
+std::string StatisticsJsonFilename;
+std::string ProfileFilename;
+std::string InstrumentationProfileFilename;
+
+/**
+ * A project manifest lists one source file per line.  Blank lines and lines beginning with '#' are ignored and relative
+ * paths are relative to the directory containing the manifest.  The first file listed is the main module, which is executed
+ * after all the others.
+ */
+void readProjectManifest(const std::string &manifestFilename) {
+    std::ifstream manifest{manifestFilename};
+    if(!manifest) {
+        throw cxxopts::OptionException("Couldn't open project manifest: " + manifestFilename);
+    }
+
+    std::string directory;
+    auto lastSlash = manifestFilename.rfind('/');
+    if(lastSlash != std::string::npos) {
+        directory = manifestFilename.substr(0, lastSlash + 1);
+    }
+
+    std::string line;
+    while(std::getline(manifest, line)) {
+        anode::string::trim(line);
+        if(line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::string filename = line[0] == '/' ? line : directory + line;
+        if(StartScriptFilename.empty()) {
+            StartScriptFilename = filename;
+        } else {
+            LibraryFilenames.push_back(filename);
+        }
+    }
+}
 
 void parseCmdLine(int argc, char **argv) {
     cxxopts::Options options("anode", "Anode REPL and JIT compiler/runtime.");
     options.add_options("")
         ("h,help", "Display this text and exit", cxxopts::value<bool>(), "")
-        ("e,execute", "Execute the specified file", cxxopts::value<std::string>(), "");
+        ("e,execute", "Execute the specified file after any additional files, which are parsed in parallel", cxxopts::value<std::string>(), "")
+        ("p,project", "Execute the files listed in the specified project manifest (the first listed is executed last)", cxxopts::value<std::string>(), "")
+        ("j,jobs", "Number of threads used to parse source files (default: one per hardware thread)", cxxopts::value<unsigned>(), "")
+        ("cache-dir", "Cache analyzed and compiled modules in the specified directory and reuse them while unchanged", cxxopts::value<std::string>(), "")
+        ("ffast-math", "Allow floating point arithmetic to be reassociated and contracted and assume there are no NaNs or infinities", cxxopts::value<bool>(), "")
+        ("ffp-contract", "Allow multiplications and additions to be fused (fast) or not (off, the default)", cxxopts::value<std::string>(), "")
+        ("O,opt-level", "Optimize at the specified level, 0-3 (default: 0)", cxxopts::value<unsigned>()->default_value("0"), "")
+        ("files", "Additional files to execute", cxxopts::value<std::vector<std::string>>(), "");
     options.add_options("diagnostics")
         //TODO:  the last argument to OptionsAdder doesn't seem to do anything and doesn't seem to be documented?
-        ("a,dumpast", "Display the AST of the specified file", cxxopts::value<std::string>(), "");
-
+        ("a,dumpast", "Display the AST of the specified file", cxxopts::value<std::string>(), "")
+        ("time-passes", "Display the wall time of each compiler phase and pass on exit", cxxopts::value<bool>(), "")
+        ("stats", "Display AST node, LLVM instruction and machine code counts per module and hardware counters per phase on exit", cxxopts::value<bool>(), "")
+        ("stats-json", "Write all timings and statistics to the specified file as JSON on exit", cxxopts::value<std::string>(), "")
+        ("profile", "Sample the call stacks of executing code and write them to the specified file as folded stacks on exit", cxxopts::value<std::string>(), "")
+        ("profile-frequency", "Samples per second of CPU time taken by --profile (default: 997)", cxxopts::value<unsigned>()->default_value("997"), "")
+        ("instrument", "Count function calls and branches and write the counts to the specified file on exit, for --profile-use", cxxopts::value<std::string>(), "")
+        ("profile-use", "Optimize according to the counts written by a previous run with --instrument", cxxopts::value<std::string>(), "");
+
+    options.parse_positional("files");
+    options.positional_help("[files...]");
     options.parse(argc, argv);
 
     if(options["help"].as<bool>()) {
@@ -70,11 +132,113 @@ void parseCmdLine(int argc, char **argv) {
         StartScriptFilename = temp;
     }
 
+    temp = options["project"].as<std::string>();
+    if(!temp.empty()) {
+        DesiredAction = Action::Execute;
+        readProjectManifest(temp);
+    }
+
+    if(options.count("files")) {
+        const auto &files = options["files"].as<std::vector<std::string>>();
+        LibraryFilenames.insert(LibraryFilenames.end(), files.begin(), files.end());
+    }
+    if(DesiredAction == Action::Execute && StartScriptFilename.empty()) {
+        throw cxxopts::OptionException("No file to execute was specified.");
+    }
+    JobCount = options["jobs"].as<unsigned>();
+    ModuleCacheDirectory = options["cache-dir"].as<std::string>();
+
+    //Functions may still specify their own mode with fpmode(...).
+    temp = options["ffp-contract"].as<std::string>();
+    if(temp == "fast") {
+        FloatingPointMode = anode::front::ast::FloatingPointMode::Contract;
+    } else if(!temp.empty() && temp != "off") {
+        throw cxxopts::OptionException("--ffp-contract must be 'fast' or 'off'.");
+    }
+    if(options["ffast-math"].as<bool>()) {
+        FloatingPointMode = anode::front::ast::FloatingPointMode::Fast;
+    }
+    OptimizationLevel = options["opt-level"].as<unsigned>();
+
     temp = options["dumpast"].as<std::string>();
     if(!temp.empty()) {
          DesiredAction = Action::DumpAst;
         StartScriptFilename = temp;
     }
+
+    TimePasses = options["time-passes"].as<bool>();
+    ShowStatistics = options["stats"].as<bool>();
+    StatisticsJsonFilename = options["stats-json"].as<std::string>();
+    anode::stats::global().setEnabled(TimePasses || ShowStatistics || !StatisticsJsonFilename.empty());
+    anode::stats::global().setHardwareCountersEnabled(ShowStatistics || !StatisticsJsonFilename.empty());
+
+    //Started before any execution context exists so that JIT compiled functions are recorded as they are loaded.
+    ProfileFilename = options["profile"].as<std::string>();
+    if(!ProfileFilename.empty()) {
+        anode::execute::startProfiler(options["profile-frequency"].as<unsigned>());
+    }
+
+    InstrumentationProfileFilename = options["instrument"].as<std::string>();
+    if(!InstrumentationProfileFilename.empty()) {
+        anode::execute::setInstrumentationEnabled(true);
+    }
+    temp = options["profile-use"].as<std::string>();
+    if(!temp.empty()) {
+        std::ifstream profileFile{temp};
+        if(!profileFile) {
+            throw cxxopts::OptionException("Couldn't open profile: " + temp);
+        }
+        try {
+            anode::execute::useInstrumentationProfile(profileFile);
+        } catch(anode::execute::ExecutionException &exception) {
+            throw cxxopts::OptionException(temp + ": " + exception.what());
+        }
+    }
+}
+
+void writeInstrumentationProfile() {
+    if(InstrumentationProfileFilename.empty()) {
+        return;
+    }
+    std::ofstream profileFile{InstrumentationProfileFilename};
+    if(!profileFile) {
+        std::cerr << "Couldn't open instrumentation profile output file: " << InstrumentationProfileFilename << "\n";
+        return;
+    }
+    anode::execute::writeInstrumentationProfile(profileFile);
+}
+
+void writeProfile() {
+    if(ProfileFilename.empty()) {
+        return;
+    }
+    std::ofstream profileFile{ProfileFilename};
+    if(!profileFile) {
+        std::cerr << "Couldn't open profile output file: " << ProfileFilename << "\n";
+        return;
+    }
+    size_t droppedCount = anode::execute::writeProfile(profileFile);
+    if(droppedCount) {
+        std::cerr << "Warning: " << droppedCount << " profiler samples were dropped.\n";
+    }
+}
+
+void writeStatistics() {
+    anode::stats::Statistics &statistics = anode::stats::global();
+    if(TimePasses) {
+        statistics.writeTimingReport(std::cerr);
+    }
+    if(ShowStatistics) {
+        statistics.writeStatisticsReport(std::cerr);
+    }
+    if(!StatisticsJsonFilename.empty()) {
+        std::ofstream jsonFile{StatisticsJsonFilename};
+        if(!jsonFile) {
+            std::cerr << "Couldn't open statistics output file: " << StatisticsJsonFilename << "\n";
+            return;
+        }
+        statistics.writeJson(jsonFile);
+    }
 }
 }
 
@@ -83,11 +247,14 @@ namespace anode {
 void executeLine(std::shared_ptr<execute::ExecutionContext> executionContext, std::string lineOfCode, std::string moduleName,
                  bool shouldExecute);
 
-bool executeScript(const std::string &startScriptFilename);
+bool executeScript(const std::string &startScriptFilename, const std::vector<std::string> &libraryFilenames, unsigned jobCount,
+                   const std::string &moduleCacheDirectory, ast::FloatingPointMode floatingPointMode,
+                   unsigned optimizationLevel);
 
 bool dumpAst(const std::string &startScriptFilename);
 
-bool runInteractive();
+bool runInteractive(const std::string &moduleCacheDirectory, ast::FloatingPointMode floatingPointMode,
+                    unsigned optimizationLevel);
 
 std::string getHistoryFilePath() {
     std::string home{getenv("HOME")};
@@ -110,6 +277,7 @@ void help() {
     std::cout << "/help             Displays this text.\n";
     std::cout << "/compile          Toggles compilation.  When disabled, the LLVM IR will not be generated.\n";
     std::cout << "/history          Displays command history.\n";
+    std::cout << "/load <file>      Executes the specified file.\n";
     std::cout << "/exit             Exits the anode REPL.\n\n";
     std::cout << "Valid anode statements may also be entered.\n";
 }
@@ -137,7 +305,11 @@ void resultCallback(execute::ExecutionContext *, type::PrimitiveType primitiveTy
     }
 }
 
-bool runInteractive() {
+bool loadFile(std::shared_ptr<execute::ExecutionContext> executionContext, const std::string &filename,
+              ContentHasher &history);
+
+bool runInteractive(const std::string &moduleCacheDirectory, ast::FloatingPointMode floatingPointMode,
+                    unsigned optimizationLevel) {
     if (!isatty(fileno(stdin))) {
         std::cout << "stdin is not a terminal\n";
         return true;
@@ -152,9 +324,15 @@ bool runInteractive() {
     std::shared_ptr<execute::ExecutionContext> executionContext = execute::createExecutionContext();
     executionContext->setPrettyPrintAst(true);
     executionContext->setDumpIROnLoad(true);
+    executionContext->setFloatingPointMode(floatingPointMode);
+    executionContext->setOptimizationLevel(optimizationLevel);
 
     executionContext->setResultCallback(resultCallback);
-
+    if(!moduleCacheDirectory.empty()) {
+        executionContext->setModuleCacheDirectory(moduleCacheDirectory);
+    }
+    //Everything executed so far, which determines what a file loaded with /load may reference.
+    ContentHasher history;
 
     const char *NUDGE = "Type '/help' for help or '/exit' to exit.";
     std::cout << "Welcome to the anode REPL. " << NUDGE << "\n";
@@ -172,6 +350,10 @@ bool runInteractive() {
                 shouldCompile = !shouldCompile;
             } else if (command == "help") {
                 help();
+            } else if (command.compare(0, 5, "load ") == 0) {
+                std::string filename = command.substr(5);
+                string::trim(filename);
+                loadFile(executionContext, filename, history);
             } else if (command == "exit") {
                 keepGoing = false;
             } else if (command == "history") {
@@ -187,6 +369,7 @@ bool runInteractive() {
             }
         } else {
             std::string moduleName = string::format("repl_line_%d", ++commandCount);
+            history.add(lineOfCode);
             executeLine(executionContext, lineOfCode, moduleName, shouldCompile);
         }
 
@@ -230,6 +413,54 @@ void executeLine(std::shared_ptr<execute::ExecutionContext> executionContext, st
     }
 }
 
+std::string readSourceFile(const std::string &filename) {
+    std::ifstream file{filename};
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+/**
+ * Executes a module which may have been cached, see ExecutionContext::setModuleCacheDirectory(...).  cacheKey must cover
+ * the module's source and everything executed before it.  If parsedModule is null the module is loaded from the cache or,
+ * failing that, parsed from sourceText.
+ */
+bool runFile(std::shared_ptr<execute::ExecutionContext> executionContext, const std::string &filename,
+             const std::string &sourceText, uint64_t cacheKey, ast::Module *parsedModule) {
+    if(!parsedModule) {
+        if(executionContext->executeCachedModule(filename, cacheKey)) {
+            return false;
+        }
+        try {
+            std::istringstream input{sourceText};
+            parsedModule = &anode::front::parseModule(input, filename);
+        } catch (anode::front::ParseAbortedException &e) {
+            std::cerr << "Parse aborted!\n";
+            std::cerr << e.what();
+            return true;
+        }
+    }
+
+    if(executionContext->prepareModule(parsedModule)) {
+        return true;
+    }
+    executionContext->executeAndCacheModule(parsedModule, sourceText, cacheKey);
+    return false;
+}
+
+bool loadFile(std::shared_ptr<execute::ExecutionContext> executionContext, const std::string &filename,
+              ContentHasher &history) {
+    std::ifstream file{filename};
+    if(!file) {
+        std::cerr << "Couldn't open " << filename << "\n";
+        return true;
+    }
+    std::string sourceText = readSourceFile(filename);
+    history.add(filename);
+    history.add(sourceText);
+    return runFile(executionContext, filename, sourceText, history.hash(), nullptr);
+}
+
 ast::Module *parseModule(const std::string &startScriptFilename) {
     try {
         return &anode::front::parseModule(startScriptFilename);
@@ -244,18 +475,64 @@ ast::Module *parseModule(const std::string &startScriptFilename) {
     return nullptr;
 }
 
-bool executeScript(const std::string &startScriptFilename) {
-    ast::Module *module = parseModule(startScriptFilename);
-    if (!module) {
-        return true;
-    }
-
+bool executeScript(const std::string &startScriptFilename, const std::vector<std::string> &libraryFilenames, unsigned jobCount,
+                   const std::string &moduleCacheDirectory, ast::FloatingPointMode floatingPointMode,
+                   unsigned optimizationLevel) {
     std::shared_ptr<execute::ExecutionContext> executionContext = execute::createExecutionContext();
     executionContext->setResultCallback(resultCallback);
+    executionContext->setFloatingPointMode(floatingPointMode);
+    executionContext->setOptimizationLevel(optimizationLevel);
+
+    std::vector<std::string> filenames{libraryFilenames};
+    filenames.push_back(startScriptFilename);
+
+    //Each module's cache key covers its own source and those of the modules executed before it, whose globals it may
+    //reference.  Cached modules are not parsed unless they turn out to be stale.
+    std::vector<std::string> sourceTexts(filenames.size());
+    std::vector<uint64_t> cacheKeys(filenames.size());
+    std::vector<bool> isCached(filenames.size());
+    std::vector<std::string> filenamesToParse;
+    if(!moduleCacheDirectory.empty()) {
+        executionContext->setModuleCacheDirectory(moduleCacheDirectory);
+        ContentHasher history;
+        for(size_t i = 0; i < filenames.size(); ++i) {
+            sourceTexts[i] = readSourceFile(filenames[i]);
+            history.add(filenames[i]);
+            history.add(sourceTexts[i]);
+            cacheKeys[i] = history.hash();
+            isCached[i] = executionContext->hasCachedModule(cacheKeys[i]);
+        }
+    }
+    for(size_t i = 0; i < filenames.size(); ++i) {
+        if(!isCached[i]) {
+            filenamesToParse.push_back(filenames[i]);
+        }
+    }
+
+    //Parsing and the passes which don't depend on other modules run concurrently, one task per file.
+    gc_ref_vector<ast::Module> modules;
+    try {
+        if(!filenamesToParse.empty()) {
+            modules = anode::front::parseModules(filenamesToParse, executionContext->world(), jobCount, std::cerr);
+        }
+    }
+    catch (anode::front::ParseAbortedException &e) {
+        std::cerr << e.what() << "\n";
+        return true;
+    }
 
-    bool failFlag = runModule(executionContext, module);
+    //Everything else, including merging each module's globals into the global scope, happens one module at a time.
+    bool failFlag = false;
+    size_t nextParsedModule = 0;
+    for(size_t i = 0; i < filenames.size(); ++i) {
+        ast::Module *parsedModule = isCached[i] ? nullptr : &modules[nextParsedModule++].get();
+        failFlag = runFile(executionContext, filenames[i], sourceTexts[i], cacheKeys[i], parsedModule);
+        if(failFlag) {
+            break;
+        }
+    }
     if (!failFlag && anode::runtime::AssertPassCount > 0) {
-        std::cerr << anode::runtime::AssertPassCount << " assertion(s) passed.\n";
+        std::cerr << anode::runtime::AssertPassCount.load() << " assertion(s) passed.\n";
     }
 
     return failFlag;
@@ -339,26 +616,32 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    bool failFlag = false;
     switch(CmdLine::DesiredAction) {
         case CmdLine::Action::JustExit:
             return 0;
         case CmdLine::Action::DumpAst:
-            if (anode::dumpAst(CmdLine::StartScriptFilename)) {
-                return -1;
-            }
+            failFlag = anode::dumpAst(CmdLine::StartScriptFilename);
             break;
         case CmdLine::Action::Execute:
-            if (anode::executeScript(CmdLine::StartScriptFilename)) {
-                return -1;
-            }
+            failFlag = anode::executeScript(
+                CmdLine::StartScriptFilename,
+                CmdLine::LibraryFilenames,
+                CmdLine::JobCount,
+                CmdLine::ModuleCacheDirectory,
+                CmdLine::FloatingPointMode,
+                CmdLine::OptimizationLevel);
             break;
         case CmdLine::Action::RunInteractive:
-            if (anode::runInteractive()) {
-                return -1;
-            }
+            failFlag = anode::runInteractive(
+                CmdLine::ModuleCacheDirectory, CmdLine::FloatingPointMode, CmdLine::OptimizationLevel);
             break;
     }
 
-    return 0;
+    CmdLine::writeStatistics();
+    CmdLine::writeProfile();
+    CmdLine::writeInstrumentationProfile();
+
+    return failFlag ? -1 : 0;
 }
 
@@ -22,9 +22,23 @@ class CompileContext {
     llvm::Function *assertFailFunc_ = nullptr;
     llvm::Function *assertPassFunc_ = nullptr;
     llvm::Function *mallocFunc_ = nullptr;
+    llvm::Function *spawnFunc_ = nullptr;
+    llvm::Function *joinFunc_ = nullptr;
+    llvm::Function *parallelForFunc_ = nullptr;
+    llvm::Function *newArrayFunc_ = nullptr;
+    llvm::Function *indexOutOfBoundsFunc_ = nullptr;
     std::unordered_map<std::string, llvm::Value*> stringConstants_;
 
     std::stack<front::ast::FuncDefStmt*> funcDefStack_;
+    const front::ast::FloatingPointMode moduleFloatingPointMode_;
+    front::ast::FloatingPointMode floatingPointMode_ = front::ast::FloatingPointMode::Precise;
+
+    const ProfileOptions profileOptions_;
+    /** Stands in for the array of counters until its size is known, see emitCounterRegistration(...). */
+    llvm::GlobalVariable *countersPlaceholder_ = nullptr;
+    std::vector<std::string> counterNames_;
+    /** The number of branches of each kind emitted so far within each function, keyed by their prefix. */
+    std::unordered_map<std::string, unsigned> branchOrdinals_;
 public:
     NO_COPY_NO_ASSIGN(CompileContext)
 
@@ -33,8 +47,16 @@ public:
         llvm::LLVMContext &llvmContext,
         llvm::Module &llvmModule,
         llvm::IRBuilder<> &irBuilder_,
-        TypeMap &typeMap)
-    : world_{world}, llvmContext_(llvmContext), llvmModule_(llvmModule), irBuilder_(irBuilder_), typeMap_{typeMap} {
+        TypeMap &typeMap,
+        front::ast::FloatingPointMode moduleFloatingPointMode,
+        const ProfileOptions &profileOptions)
+    : world_{world}, llvmContext_(llvmContext), llvmModule_(llvmModule), irBuilder_(irBuilder_), typeMap_{typeMap},
+      moduleFloatingPointMode_{
+          moduleFloatingPointMode == front::ast::FloatingPointMode::Default
+              ? front::ast::FloatingPointMode::Precise
+              : moduleFloatingPointMode},
+      profileOptions_{profileOptions} {
+        setFloatingPointMode(moduleFloatingPointMode_);
     }
 
     front::ast::AnodeWorld &world() { return world_; }
@@ -100,12 +122,150 @@ public:
         return mallocFunc_;
     }
 
+    /** The type of the functions emitted for spawn expressions, which take a pointer to the frame of the spawned call. */
+    llvm::FunctionType *taskFuncType() {
+        return llvm::FunctionType::get(
+            llvm::Type::getVoidTy(llvmContext()),
+            { llvm::Type::getInt8PtrTy(llvmContext()) },
+            /*isVarArg*/ false);
+    }
+
+    llvm::Function *spawnFunc() {
+        if(!spawnFunc_) {
+            spawnFunc_ = llvm::cast<llvm::Function>(llvmModule().getOrInsertFunction(
+                SPAWN_FUNC_NAME,
+                llvm::Type::getInt8PtrTy(llvmContext()),   //Return value is the task
+                taskFuncType()->getPointerTo(),           //Function which invokes the spawned function
+                llvm::Type::getInt8PtrTy(llvmContext())    //Frame of the spawned call
+            ));
+
+            auto paramItr = spawnFunc_->arg_begin();
+            llvm::Value *taskFunc = paramItr++;
+            taskFunc->setName("taskFunc");
+
+            llvm::Value *frame = paramItr;
+            frame->setName("frame");
+        }
+        return spawnFunc_;
+    }
+
+    llvm::Function *joinFunc() {
+        if(!joinFunc_) {
+            joinFunc_ = llvm::cast<llvm::Function>(llvmModule().getOrInsertFunction(
+                JOIN_FUNC_NAME,
+                llvm::Type::getInt8PtrTy(llvmContext()),   //Return value is the frame of the spawned call
+                llvm::Type::getInt8PtrTy(llvmContext())    //The task
+            ));
+
+            llvm::Value *task = joinFunc_->arg_begin();
+            task->setName("task");
+        }
+        return joinFunc_;
+    }
+
+    /**
+     * The type of the functions emitted for the bodies of parallel for expressions, which take a pointer to the variables
+     * they capture, the range of iterations to execute and a pointer to the partial result of a reduction.
+     */
+    llvm::FunctionType *loopChunkFuncType() {
+        return llvm::FunctionType::get(
+            llvm::Type::getVoidTy(llvmContext()),
+            {
+                llvm::Type::getInt8PtrTy(llvmContext()),
+                llvm::Type::getInt32Ty(llvmContext()),
+                llvm::Type::getInt32Ty(llvmContext()),
+                llvm::Type::getInt8PtrTy(llvmContext())
+            },
+            /*isVarArg*/ false);
+    }
+
+    /** The type of the functions which combine two partial results of a reduction. */
+    llvm::FunctionType *loopCombineFuncType() {
+        return llvm::FunctionType::get(
+            llvm::Type::getVoidTy(llvmContext()),
+            { llvm::Type::getInt8PtrTy(llvmContext()), llvm::Type::getInt8PtrTy(llvmContext()) },
+            /*isVarArg*/ false);
+    }
+
+    llvm::Function *parallelForFunc() {
+        if(!parallelForFunc_) {
+            parallelForFunc_ = llvm::cast<llvm::Function>(llvmModule().getOrInsertFunction(
+                PARALLEL_FOR_FUNC_NAME,
+                llvm::Type::getVoidTy(llvmContext()),      //Return type
+                loopChunkFuncType()->getPointerTo(),      //Function which executes a chunk of the iterations
+                loopCombineFuncType()->getPointerTo(),    //Function which combines partial results, or null
+                llvm::Type::getInt8PtrTy(llvmContext()),   //Pointers to the captured variables
+                llvm::Type::getInt32Ty(llvmContext()),     //Beginning of the range
+                llvm::Type::getInt32Ty(llvmContext()),     //End of the range (exclusive)
+                llvm::Type::getInt8PtrTy(llvmContext()),   //Result of the reduction, or null
+                llvm::Type::getInt32Ty(llvmContext())      //Size of the result, in bytes
+            ));
+
+            auto paramItr = parallelForFunc_->arg_begin();
+            (paramItr++)->setName("chunkFunc");
+            (paramItr++)->setName("combineFunc");
+            (paramItr++)->setName("context");
+            (paramItr++)->setName("begin");
+            (paramItr++)->setName("end");
+            (paramItr++)->setName("result");
+            paramItr->setName("resultSize");
+        }
+        return parallelForFunc_;
+    }
+
+    llvm::Function *newArrayFunc() {
+        if(!newArrayFunc_) {
+            newArrayFunc_ = llvm::cast<llvm::Function>(llvmModule().getOrInsertFunction(
+                NEW_ARRAY_FUNC_NAME,
+                llvm::Type::getInt8PtrTy(llvmContext()),   //Return value is the array
+                llvm::Type::getInt32Ty(llvmContext()),     //Number of elements
+                llvm::Type::getInt32Ty(llvmContext()),     //Size of each element, in bytes
+                llvm::Type::getInt32Ty(llvmContext()),     //Offset of the first element from the start of the array
+                llvm::Type::getInt1Ty(llvmContext())       //True if the elements contain pointers the GC must scan
+            ));
+
+            auto paramItr = newArrayFunc_->arg_begin();
+            (paramItr++)->setName("length");
+            (paramItr++)->setName("elementSize");
+            (paramItr++)->setName("elementsOffset");
+            paramItr->setName("containsPointers");
+        }
+        return newArrayFunc_;
+    }
+
+    llvm::Function *indexOutOfBoundsFunc() {
+        if(!indexOutOfBoundsFunc_) {
+            indexOutOfBoundsFunc_ = llvm::cast<llvm::Function>(llvmModule().getOrInsertFunction(
+                INDEX_OUT_OF_BOUNDS_FUNC_NAME,
+                llvm::Type::getVoidTy(llvmContext()),      //Return type
+                llvm::Type::getInt8PtrTy(llvmContext()),   //char * to source filename
+                llvm::Type::getInt32Ty(llvmContext()),     //line number
+                llvm::Type::getInt32Ty(llvmContext()),     //The index
+                llvm::Type::getInt32Ty(llvmContext())      //Length of the array
+            ));
+
+            auto paramItr = indexOutOfBoundsFunc_->arg_begin();
+            (paramItr++)->setName("filename");
+            (paramItr++)->setName("lineNo");
+            (paramItr++)->setName("index");
+            paramItr->setName("length");
+            //The runtime throws an exception, allowing the bounds checks to be treated as cold paths.
+            indexOutOfBoundsFunc_->setDoesNotReturn();
+        }
+        return indexOutOfBoundsFunc_;
+    }
+
     TypeMap &typeMap() { return typeMap_; }
 
     llvm::Constant *getDefaultValueForType(front::type::Type &type) {
-        if(type.isClass()) {
+        if(type.isClass()
+           || isInstanceOf<front::type::TaskType>(type.actualType())
+           || isInstanceOf<front::type::ArrayType>(type.actualType())) {
             return llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(typeMap_.toLlvmType(type)));
         }
+        if(isInstanceOf<front::type::VectorType>(type.actualType())) {
+            return llvm::Constant::getNullValue(typeMap_.toLlvmType(type));
+        }
         return getDefaultValueForType(type.primitiveType());
     }
 
@@ -147,6 +307,183 @@ public:
         funcDefStack_.pop();
     }
 
+    /** The mode of the floating point instructions currently being emitted, which is never FloatingPointMode::Default. */
+    front::ast::FloatingPointMode floatingPointMode() const { return floatingPointMode_; }
+
+    /**
+     * Sets the fast-math flags which the IRBuilder adds to the floating point instructions it creates according to the
+     * specified mode, or the module's if it is FloatingPointMode::Default.  Returns the previous mode.
+     */
+    front::ast::FloatingPointMode setFloatingPointMode(front::ast::FloatingPointMode mode) {
+        front::ast::FloatingPointMode previousMode = floatingPointMode_;
+        floatingPointMode_ = mode == front::ast::FloatingPointMode::Default ? moduleFloatingPointMode_ : mode;
+
+        llvm::FastMathFlags flags;
+        switch(floatingPointMode_) {
+            case front::ast::FloatingPointMode::Precise:
+                break;
+            case front::ast::FloatingPointMode::Contract:
+                flags.setAllowContract(true);
+                break;
+            case front::ast::FloatingPointMode::Fast:
+                flags.setUnsafeAlgebra();
+                flags.setAllowContract(true);
+                break;
+            default:
+                ASSERT_FAIL("Unhandled FloatingPointMode");
+        }
+        irBuilder_.setFastMathFlags(flags);
+        return previousMode;
+    }
+
+    /**
+     * Adds the attributes of the current floating point mode to a function so that the code generator may also make
+     * the same assumptions as the optimizer, i.e. when selecting instructions for the function's reductions.
+     */
+    void addFloatingPointAttributes(llvm::Function &function) {
+        if(floatingPointMode_ != front::ast::FloatingPointMode::Fast) {
+            return;
+        }
+        for(const char *attribute : { "unsafe-fp-math", "no-infs-fp-math", "no-nans-fp-math", "no-signed-zeros-fp-math" }) {
+            function.addFnAttr(attribute, "true");
+        }
+    }
+
+    const ProfileOptions &profileOptions() const { return profileOptions_; }
+
+    /**
+     * Counts the calls to a function, the body of which is about to be emitted, if the module is instrumented.  If the
+     * profile has the function's count it becomes the function's entry count and functions which were never called are
+     * marked cold, which makes the branches leading to calls to them unlikely so that those calls are moved out of the way.
+     */
+    void countFunctionEntry(llvm::Function &function) {
+        std::string name = counterPrefix(function) + "entry";
+        if(profileOptions_.instrument) {
+            incrementCounter(getLiteralCounterIndex(allocateCounter(name)));
+        }
+        if(profileOptions_.counts) {
+            auto found = profileOptions_.counts->find(name);
+            if(found != profileOptions_.counts->end()) {
+                function.setEntryCount(found->second);
+                if(found->second == 0) {
+                    function.addFnAttr(llvm::Attribute::Cold);
+                }
+            }
+        }
+    }
+
+    /**
+     * Emits a conditional branch of the specified kind (see ProfileOptions), which counts how many times each of its
+     * destinations is taken if the module is instrumented and is weighted by those counts if the profile has them.
+     */
+    llvm::BranchInst *createCondBr(
+        llvm::Value *condition,
+        llvm::BasicBlock *trueBlock,
+        llvm::BasicBlock *falseBlock,
+        const char *kind
+    ) {
+        if(!profileOptions_.instrument && !profileOptions_.counts) {
+            return irBuilder_.CreateCondBr(condition, trueBlock, falseBlock);
+        }
+
+        std::string site = counterPrefix(*irBuilder_.GetInsertBlock()->getParent()) + kind;
+        site += "." + std::to_string(branchOrdinals_[site]++);
+
+        if(profileOptions_.instrument) {
+            unsigned trueCounter = allocateCounter(site + ".true");
+            allocateCounter(site + ".false");
+            //Selecting which counter to increment leaves the destinations as they would be without instrumentation.
+            incrementCounter(irBuilder_.CreateSelect(
+                condition, getLiteralCounterIndex(trueCounter), getLiteralCounterIndex(trueCounter + 1)));
+        }
+
+        llvm::BranchInst *branch = irBuilder_.CreateCondBr(condition, trueBlock, falseBlock);
+        if(profileOptions_.counts) {
+            auto trueCount = profileOptions_.counts->find(site + ".true");
+            auto falseCount = profileOptions_.counts->find(site + ".false");
+            if(trueCount != profileOptions_.counts->end() && falseCount != profileOptions_.counts->end()) {
+                //Branch weights are 32 bits, so large counts are scaled down.  As clang does, 1 is added to each so
+                //that no destination is considered impossible.
+                uint64_t maxCount = std::max(trueCount->second, falseCount->second);
+                uint64_t scale = maxCount < UINT32_MAX ? 1 : maxCount / UINT32_MAX + 1;
+                branch->setMetadata(
+                    llvm::LLVMContext::MD_prof,
+                    llvm::MDBuilder(llvmContext_).createBranchWeights(
+                        (uint32_t)(trueCount->second / scale + 1),
+                        (uint32_t)(falseCount->second / scale + 1)));
+            }
+        }
+        return branch;
+    }
+
+    /**
+     * Allocates the counters of an instrumented module, now that all of them are known, and registers them with the
+     * runtime at the start of the module's initialization function.
+     */
+    void emitCounterRegistration(llvm::Function &initFunc) {
+        if(!countersPlaceholder_) {
+            return;
+        }
+        llvm::Type *counterType = llvm::Type::getInt64Ty(llvmContext_);
+        llvm::ArrayType *countersType = llvm::ArrayType::get(counterType, counterNames_.size());
+        auto counters = new llvm::GlobalVariable(
+            llvmModule_, countersType, /*isConstant*/ false, llvm::GlobalValue::InternalLinkage,
+            llvm::ConstantAggregateZero::get(countersType), "__counters__");
+        llvm::Constant *firstCounter = llvm::ConstantExpr::getBitCast(counters, counterType->getPointerTo());
+        countersPlaceholder_->replaceAllUsesWith(firstCounter);
+        countersPlaceholder_->eraseFromParent();
+        countersPlaceholder_ = nullptr;
+
+        std::string names;
+        for(const std::string &name : counterNames_) {
+            if(!names.empty()) names += '\n';
+            names += name;
+        }
+
+        auto registerCountersFunc = llvm::cast<llvm::Function>(llvmModule_.getOrInsertFunction(
+            REGISTER_COUNTERS_FUNC_NAME,
+            llvm::Type::getVoidTy(llvmContext_),         //Return type
+            llvm::Type::getInt8PtrTy(llvmContext_),      //Names of the counters, separated by newlines
+            counterType->getPointerTo(),                //The counters
+            llvm::Type::getInt32Ty(llvmContext_)         //Number of counters
+        ));
+
+        //First, so that the counts of a module whose initialization fails are still written.
+        llvm::BasicBlock &entryBlock = initFunc.getEntryBlock();
+        llvm::IRBuilder<> entryBuilder{&entryBlock, entryBlock.getFirstInsertionPt()};
+        entryBuilder.CreateCall(registerCountersFunc, {
+            entryBuilder.CreateGlobalStringPtr(names),
+            firstCounter,
+            llvm::ConstantInt::get(llvmContext_, llvm::APInt(32, counterNames_.size(), true))
+        });
+    }
+
+private:
+    /** See ProfileOptions. */
+    std::string counterPrefix(llvm::Function &function) {
+        return llvmModule_.getModuleIdentifier() + ";" + function.getName().str() + ";";
+    }
+
+    unsigned allocateCounter(const std::string &name) {
+        if(!countersPlaceholder_) {
+            countersPlaceholder_ = new llvm::GlobalVariable(
+                llvmModule_, llvm::Type::getInt64Ty(llvmContext_), /*isConstant*/ false,
+                llvm::GlobalValue::ExternalLinkage, nullptr, "__counters_placeholder__");
+        }
+        counterNames_.push_back(name);
+        return (unsigned)counterNames_.size() - 1;
+    }
+
+    llvm::Constant *getLiteralCounterIndex(unsigned index) {
+        return llvm::ConstantInt::get(llvmContext_, llvm::APInt(64, index, false));
+    }
+
+    /** The increment is not atomic, see runtime::instrumentation. */
+    void incrementCounter(llvm::Value *index) {
+        llvm::Value *counter = irBuilder_.CreateInBoundsGEP(countersPlaceholder_, index, "counter");
+        llvm::Value *count = irBuilder_.CreateLoad(counter);
+        irBuilder_.CreateStore(irBuilder_.CreateAdd(count, llvm::ConstantInt::get(count->getType(), 1)), counter);
+    }
 
 };
 
@@ -6,6 +6,50 @@
 namespace anode { namespace back {
 using namespace anode::front;
 
+/**
+ * Finds the variables of the enclosing function which are referenced by the body of a parallel for, i.e. the local
+ * variables and parameters which are referenced but not declared within it.  A reference to a field captures "this".
+ */
+class CapturedVariablesAstVisitor : public ast::AstVisitor {
+    CompileContext &cc_;
+    gc_unordered_set<scope::Symbol*> declared_;
+    gc_unordered_set<scope::Symbol*> found_;
+    gc_ref_vector<scope::Symbol> captured_;
+
+    void capture(scope::Symbol &symbol) {
+        if(found_.emplace(&symbol).second) {
+            captured_.emplace_back(symbol);
+        }
+    }
+
+public:
+    CapturedVariablesAstVisitor(CompileContext &cc, ast::ForExpr &forExpr) : cc_{cc} {
+        declared_.emplace(forExpr.inductionVar().symbol());
+    }
+
+    /** In the order in which they are first referenced. */
+    const gc_ref_vector<scope::Symbol> &captured() const { return captured_; }
+
+    void visitingVariableDeclExpr(ast::VariableDeclExpr &expr) override {
+        declared_.emplace(expr.symbol());
+    }
+
+    void visitVariableRefExpr(ast::VariableRefExpr &expr) override {
+        auto variable = tryUpcast<scope::VariableSymbol>(expr.symbol());
+        if(!variable) {
+            return;
+        }
+        if(variable->storageKind() == scope::StorageKind::Instance) {
+            capture(*cc_.currentFuncDefStmt()->symbol()->thisSymbol());
+        } else if((variable->storageKind() == scope::StorageKind::Local
+                   || variable->storageKind() == scope::StorageKind::Argument)
+                  && declared_.count(variable) == 0) {
+            //Parameters are copied to allocas of the enclosing function (see DefineFuncsAstVisitor) like locals.
+            capture(*variable);
+        }
+    }
+};
+
 class ExprStmtAstVisitor : public CompileAstVisitor {
 public:
     bool shouldVisitChildren() override { return false; }
@@ -85,9 +129,90 @@ public:
         setValue(result);
     }
 
+    /**
+     * Allocates a frame which holds the result of the spawned call followed by its arguments, stores the arguments in it
+     * and passes it to the runtime along with a function which executes the call, see emitTaskFunc(...).
+     */
+    void visitingSpawnExpr(ast::SpawnExpr &expr) override {
+        auto &callExpr = upcast<ast::FuncCallExpr>(expr.callExpr());
+        auto *spawnedFunc = llvm::cast<llvm::Function>(emitExpr(callExpr.funcExpr(), cc()));
+
+        bool hasResult = !spawnedFunc->getReturnType()->isVoidTy();
+        std::vector<llvm::Type *> frameFieldTypes;
+        if(hasResult) {
+            frameFieldTypes.push_back(spawnedFunc->getReturnType());
+        }
+        for(llvm::Type *paramType : spawnedFunc->getFunctionType()->params()) {
+            frameFieldTypes.push_back(paramType);
+        }
+        llvm::StructType *frameType = llvm::StructType::get(cc().llvmContext(), frameFieldTypes);
+        uint64_t frameSize = cc().llvmModule().getDataLayout().getTypeAllocSize(frameType);
+
+        std::vector<llvm::Value *> mallocArguments{ getLiteralUIntLLvmValue((unsigned int) frameSize) };
+        llvm::Value *frame = cc().irBuilder().CreateCall(cc().mallocFunc(), mallocArguments);
+        llvm::Value *typedFrame = cc().irBuilder().CreatePointerCast(frame, frameType->getPointerTo());
+
+        unsigned fieldIndex = hasResult ? 1 : 0;
+        for (auto arg : callExpr.arguments()) {
+            llvm::Value *argValue = emitExpr(arg.get(), cc());
+            cc().irBuilder().CreateStore(argValue, cc().irBuilder().CreateStructGEP(frameType, typedFrame, fieldIndex++));
+        }
+
+        std::vector<llvm::Value *> spawnArguments{ emitTaskFunc(spawnedFunc, frameType, hasResult), frame };
+        setValue(cc().irBuilder().CreateCall(cc().spawnFunc(), spawnArguments));
+    }
+
+    /** Waits for the task and loads the result of the spawned call from the frame returned by the runtime. */
+    void visitingJoinExpr(ast::JoinExpr &expr) override {
+        std::vector<llvm::Value *> arguments{ emitExpr(expr.taskExpr(), cc()) };
+        llvm::Value *frame = cc().irBuilder().CreateCall(cc().joinFunc(), arguments);
+
+        if(expr.exprType().isVoid()) {
+            setValue(nullptr);
+            return;
+        }
+        llvm::Type *resultType = cc().typeMap().toLlvmType(expr.exprType());
+        llvm::Value *resultPointer = cc().irBuilder().CreatePointerCast(frame, resultType->getPointerTo());
+        setValue(cc().irBuilder().CreateLoad(resultPointer));
+    }
+
+private:
+    /** Emits the function a task executes:  it loads the arguments from the frame, calls the function and stores the result. */
+    llvm::Function *emitTaskFunc(llvm::Function *spawnedFunc, llvm::StructType *frameType, bool hasResult) {
+        llvm::Function *taskFunc = llvm::Function::Create(
+            cc().taskFuncType(),
+            llvm::GlobalValue::InternalLinkage,
+            spawnedFunc->getName() + "__task__",
+            &cc().llvmModule());
+
+        //The spawn expression is in the middle of another function, to which we must return afterward.
+        llvm::IRBuilderBase::InsertPoint spawnInsertPoint = cc().irBuilder().saveIP();
+        cc().irBuilder().SetInsertPoint(llvm::BasicBlock::Create(cc().llvmContext(), "begin", taskFunc));
+
+        llvm::Value *typedFrame = cc().irBuilder().CreatePointerCast(&*taskFunc->arg_begin(), frameType->getPointerTo());
+        std::vector<llvm::Value *> args;
+        for(unsigned fieldIndex = hasResult ? 1 : 0; fieldIndex < frameType->getNumElements(); ++fieldIndex) {
+            args.push_back(cc().irBuilder().CreateLoad(cc().irBuilder().CreateStructGEP(frameType, typedFrame, fieldIndex)));
+        }
+        llvm::CallInst *result = cc().irBuilder().CreateCall(spawnedFunc, args);
+        if(hasResult) {
+            cc().irBuilder().CreateStore(result, cc().irBuilder().CreateStructGEP(frameType, typedFrame, 0));
+        }
+        cc().irBuilder().CreateRetVoid();
+
+        cc().irBuilder().restoreIP(spawnInsertPoint);
+        return taskFunc;
+    }
+
+public:
     void visitedCastExpr(ast::CastExpr &expr) override {
         llvm::Value *value = emitExpr(expr.valueExpr(), cc());
 
+        if(auto vectorType = tryUpcast<type::VectorType>(expr.exprType().actualType())) {
+            setValue(emitCastToVector(value, expr.valueExpr().exprType(), *vectorType));
+            return;
+        }
+
         ASSERT(expr.exprType().isPrimitive());
         ASSERT(expr.valueExpr().exprType().isPrimitive());
 
@@ -141,7 +266,30 @@ public:
         setValue(castedValue);
     }
 
+private:
+    /** Scalars are copied to every lane, the lanes of vectors are cast individually. */
+    llvm::Value *emitCastToVector(llvm::Value *value, type::Type &fromType, type::VectorType &toType) {
+        if(!isInstanceOf<type::VectorType>(fromType.actualType())) {
+            ASSERT(fromType.isSameType(&toType.elementType()));
+            return cc().irBuilder().CreateVectorSplat(toType.laneCount(), value);
+        }
+        llvm::Type *destLlvmType = cc().typeMap().toLlvmType(toType);
+        switch(toType.elementType().primitiveType()) {
+            case type::PrimitiveType::Float:
+                return cc().irBuilder().CreateSIToFP(value, destLlvmType);
+            case type::PrimitiveType::Int32:
+                return cc().irBuilder().CreateFPToSI(value, destLlvmType);
+            default:
+                ASSERT_FAIL("Unhandled element type");
+        }
+    }
+
+public:
     void visitingNewExpr(ast::NewExpr &expr) override {
+        if(expr.isArray()) {
+            emitNewArray(expr);
+            return;
+        }
         auto structType = cc().typeMap().toLlvmType(expr.exprType())->getPointerElementType();
         uint64_t size = cc().llvmModule().getDataLayout().getTypeAllocSize(structType);
 
@@ -153,10 +301,273 @@ public:
         setValue(castedValue);
     }
 
+private:
+    void emitNewArray(ast::NewExpr &expr) {
+        llvm::Value *length = emitExpr(*expr.lengthExpr(), cc());
+
+        auto arrayType = upcast<type::ArrayType>(expr.exprType().actualType());
+        llvm::Type *llvmArrayType = cc().typeMap().toLlvmType(*arrayType);
+        auto headerType = llvm::cast<llvm::StructType>(llvmArrayType->getPointerElementType());
+        const llvm::DataLayout &dataLayout = cc().llvmModule().getDataLayout();
+        uint64_t elementSize = dataLayout.getTypeAllocSize(headerType->getElementType(1)->getArrayElementType());
+        uint64_t elementsOffset = dataLayout.getStructLayout(headerType)->getElementOffset(1);
+
+        std::vector<llvm::Value *> arguments;
+        arguments.push_back(length);
+        arguments.push_back(getLiteralUIntLLvmValue((unsigned int) elementSize));
+        arguments.push_back(getLiteralUIntLLvmValue((unsigned int) elementsOffset));
+        arguments.push_back(llvm::ConstantInt::get(
+            cc().llvmContext(), llvm::APInt(1, (uint64_t) arrayType->elementsContainPointers(), false)));
+        llvm::Value *pointer = cc().irBuilder().CreateCall(cc().newArrayFunc(), arguments);
+
+        setValue(cc().irBuilder().CreatePointerCast(pointer, llvmArrayType));
+    }
+
+    /** Emits a load of the length stored in the header of the specified array. */
+    llvm::Value *emitArrayLength(llvm::Value *array) {
+        llvm::Value *lengthPtr = cc().irBuilder().CreateStructGEP(nullptr, array, 0, "lengthPtr");
+        return cc().irBuilder().CreateLoad(lengthPtr, "length");
+    }
+
+    /**
+     * Branches to a block which reports the index and length to the runtime (which throws) unless isInBounds is true.
+     * Continues emitting after the check.
+     */
+    void emitBoundsCheck(llvm::Value *isInBounds, llvm::Value *index, llvm::Value *length, const source::SourceSpan &span) {
+        llvm::Function *currentFunc = cc().irBuilder().GetInsertBlock()->getParent();
+        llvm::BasicBlock *inBoundsBlock = llvm::BasicBlock::Create(cc().llvmContext(), "inBounds");
+        llvm::BasicBlock *outOfBoundsBlock = llvm::BasicBlock::Create(cc().llvmContext(), "outOfBounds");
+        cc().irBuilder().CreateCondBr(isInBounds, inBoundsBlock, outOfBoundsBlock);
+
+        currentFunc->getBasicBlockList().push_back(outOfBoundsBlock);
+        cc().irBuilder().SetInsertPoint(outOfBoundsBlock);
+        std::vector<llvm::Value *> arguments;
+        arguments.push_back(cc().getDeduplicatedStringConstant(span.name()));
+        arguments.push_back(getLiteralUIntLLvmValue((unsigned int) span.start().line()));
+        arguments.push_back(index);
+        arguments.push_back(length);
+        cc().irBuilder().CreateCall(cc().indexOutOfBoundsFunc(), arguments);
+        cc().irBuilder().CreateUnreachable();
+
+        currentFunc->getBasicBlockList().push_back(inBoundsBlock);
+        cc().irBuilder().SetInsertPoint(inBoundsBlock);
+    }
+
+    llvm::Value *createElementGep(llvm::Value *array, llvm::Value *index) {
+        return cc().irBuilder().CreateInBoundsGEP(
+            array,
+            { getLiteralIntLlvmValue(0), getLiteralIntLlvmValue(1), index },
+            "elementPtr");
+    }
+
+    /** Lanes are extracted from the value of the vector, or for writes addressed within the vector itself. */
+    void emitLaneIndex(ast::IndexExpr &expr, type::VectorType &vectorType) {
+        llvm::Value *vector = emitExpr(expr.arrayExpr(), cc());
+        llvm::Value *index = emitExpr(expr.indexExpr(), cc());
+        llvm::Value *laneCount = getLiteralIntLlvmValue((int) vectorType.laneCount());
+        emitBoundsCheck(cc().irBuilder().CreateICmpULT(index, laneCount, "isInBounds"), index, laneCount, expr.sourceSpan());
+
+        if(expr.isWrite()) {
+            setValue(cc().irBuilder().CreateInBoundsGEP(vector, { getLiteralIntLlvmValue(0), index }, "lanePtr"));
+            return;
+        }
+        setValue(cc().irBuilder().CreateExtractElement(vector, index));
+    }
+
+public:
+    void visitingIndexExpr(ast::IndexExpr &expr) override {
+        if(auto vectorType = tryUpcast<type::VectorType>(expr.arrayExpr().exprType().actualType())) {
+            emitLaneIndex(expr, *vectorType);
+            return;
+        }
+        llvm::Value *array = emitExpr(expr.arrayExpr(), cc());
+        llvm::Value *index = emitExpr(expr.indexExpr(), cc());
+        llvm::Value *length = emitArrayLength(array);
+
+        //An unsigned comparison also catches negative indexes.
+        emitBoundsCheck(cc().irBuilder().CreateICmpULT(index, length, "isInBounds"), index, length, expr.sourceSpan());
+        llvm::Value *elementPtr = createElementGep(array, index);
+
+        if(expr.isWrite()) {
+            setValue(elementPtr);
+            return;
+        }
+        setValue(cc().irBuilder().CreateLoad(elementPtr));
+    }
+
+    void visitingIntrinsicCallExpr(ast::IntrinsicCallExpr &expr) override {
+        switch(expr.kind()) {
+            case ast::IntrinsicKind::MakeVector:
+                setValue(expr.isLoad() ? emitVectorLoad(expr) : emitMakeVector(expr));
+                break;
+            case ast::IntrinsicKind::Shuffle:
+                setValue(emitShuffle(expr));
+                break;
+            case ast::IntrinsicKind::Store:
+                emitVectorStore(expr);
+                setValue(nullptr);
+                break;
+            case ast::IntrinsicKind::ReduceLanes: {
+                llvm::Value *vector = emitExpr(expr.arguments().front(), cc());
+                auto &vectorType = upcast<type::VectorType>(*expr.arguments().front().get().exprType().actualType());
+                setValue(emitLaneReduction(expr.reduction(), vector, vectorType.laneCount()));
+                break;
+            }
+            default:
+                ASSERT(expr.isMath());
+                setValue(emitMath(expr));
+        }
+    }
+
+private:
+    /**
+     * Math intrinsics are emitted as calls to the corresponding LLVM intrinsics (which are overloaded for floats, doubles
+     * and vectors of them) so that they can be constant folded and vectorized like any other instruction.  Those which
+     * have no instruction on the target are lowered to calls to the C library by the code generator.
+     */
+    llvm::Value *emitMath(ast::IntrinsicCallExpr &expr) {
+        std::vector<llvm::Value*> arguments;
+        for(ast::ExprStmt &argument : expr.arguments()) {
+            arguments.push_back(emitExpr(argument, cc()));
+        }
+        llvm::Type *operandsType = arguments.front()->getType();
+
+        //llvm.minnum and llvm.maxnum only accept floating point values.
+        if(!operandsType->getScalarType()->isFloatingPointTy()) {
+            ASSERT(expr.kind() == ast::IntrinsicKind::Min || expr.kind() == ast::IntrinsicKind::Max);
+            return emitReduction(
+                expr.kind() == ast::IntrinsicKind::Min ? ast::ReductionKind::Min : ast::ReductionKind::Max,
+                arguments[0],
+                arguments[1]);
+        }
+
+        llvm::Function *intrinsic = llvm::Intrinsic::getDeclaration(
+            &cc().llvmModule(),
+            getLlvmIntrinsicId(expr.kind()),
+            { operandsType });
+        return cc().irBuilder().CreateCall(intrinsic, arguments);
+    }
+
+    static llvm::Intrinsic::ID getLlvmIntrinsicId(ast::IntrinsicKind kind) {
+        switch(kind) {
+            case ast::IntrinsicKind::Sqrt: return llvm::Intrinsic::sqrt;
+            case ast::IntrinsicKind::Fabs: return llvm::Intrinsic::fabs;
+            case ast::IntrinsicKind::Floor: return llvm::Intrinsic::floor;
+            case ast::IntrinsicKind::Ceil: return llvm::Intrinsic::ceil;
+            case ast::IntrinsicKind::Min: return llvm::Intrinsic::minnum;
+            case ast::IntrinsicKind::Max: return llvm::Intrinsic::maxnum;
+            case ast::IntrinsicKind::Fma: return llvm::Intrinsic::fma;
+            case ast::IntrinsicKind::Pow: return llvm::Intrinsic::pow;
+            case ast::IntrinsicKind::Exp: return llvm::Intrinsic::exp;
+            case ast::IntrinsicKind::Log: return llvm::Intrinsic::log;
+            case ast::IntrinsicKind::Sin: return llvm::Intrinsic::sin;
+            case ast::IntrinsicKind::Cos: return llvm::Intrinsic::cos;
+            default:
+                ASSERT_FAIL("Not a math intrinsic");
+        }
+    }
+
+    llvm::Value *emitMakeVector(ast::IntrinsicCallExpr &expr) {
+        type::VectorType &vectorType = *expr.vectorType();
+        if(expr.arguments().size() == 1) {
+            return cc().irBuilder().CreateVectorSplat(vectorType.laneCount(), emitExpr(expr.arguments().front(), cc()));
+        }
+        llvm::Value *vector = llvm::UndefValue::get(cc().typeMap().toLlvmType(vectorType));
+        for(unsigned i = 0; i < vectorType.laneCount(); ++i) {
+            llvm::Value *lane = emitExpr(expr.arguments()[i], cc());
+            vector = cc().irBuilder().CreateInsertElement(vector, lane, getLiteralIntLlvmValue((int) i));
+        }
+        return vector;
+    }
+
+    /**
+     * Checks that the lanes of a vector loaded from or stored to the array beginning at index are within its bounds and
+     * returns a pointer to the first of them.
+     */
+    llvm::Value *emitVectorElementsPtr(
+        llvm::Value *array,
+        llvm::Value *index,
+        type::VectorType &vectorType,
+        const source::SourceSpan &span
+    ) {
+        llvm::Value *length = emitArrayLength(array);
+        llvm::Value *laneCount = getLiteralIntLlvmValue((int) vectorType.laneCount());
+        //index <= length (unsigned, so negative indexes fail) and then length - index >= laneCount cannot overflow.
+        llvm::Value *isInBounds = cc().irBuilder().CreateAnd(
+            cc().irBuilder().CreateICmpULE(index, length),
+            cc().irBuilder().CreateICmpSGE(cc().irBuilder().CreateSub(length, index), laneCount),
+            "isInBounds");
+        emitBoundsCheck(isInBounds, index, length, span);
+
+        return cc().irBuilder().CreatePointerCast(
+            createElementGep(array, index),
+            cc().typeMap().toLlvmType(vectorType)->getPointerTo());
+    }
+
+    /** The elements of arrays are only aligned to the size of a single element. */
+    unsigned elementAlignment(type::VectorType &vectorType) {
+        llvm::Type *elementType = cc().typeMap().toLlvmType(vectorType.elementType());
+        return (unsigned) cc().llvmModule().getDataLayout().getABITypeAlignment(elementType);
+    }
+
+    llvm::Value *emitVectorLoad(ast::IntrinsicCallExpr &expr) {
+        llvm::Value *array = emitExpr(expr.arguments()[0], cc());
+        llvm::Value *index = emitExpr(expr.arguments()[1], cc());
+        type::VectorType &vectorType = *expr.vectorType();
+        llvm::Value *ptr = emitVectorElementsPtr(array, index, vectorType, expr.sourceSpan());
+        return cc().irBuilder().CreateAlignedLoad(ptr, elementAlignment(vectorType));
+    }
+
+    void emitVectorStore(ast::IntrinsicCallExpr &expr) {
+        llvm::Value *array = emitExpr(expr.arguments()[0], cc());
+        llvm::Value *index = emitExpr(expr.arguments()[1], cc());
+        llvm::Value *vector = emitExpr(expr.arguments()[2], cc());
+        auto &vectorType = upcast<type::VectorType>(*expr.arguments()[2].get().exprType().actualType());
+        llvm::Value *ptr = emitVectorElementsPtr(array, index, vectorType, expr.sourceSpan());
+        cc().irBuilder().CreateAlignedStore(vector, ptr, elementAlignment(vectorType));
+    }
+
+    llvm::Value *emitShuffle(ast::IntrinsicCallExpr &expr) {
+        size_t firstLane = expr.firstLaneArgument();
+        llvm::Value *first = emitExpr(expr.arguments()[0], cc());
+        llvm::Value *second = firstLane == 2
+            ? emitExpr(expr.arguments()[1], cc())
+            : llvm::UndefValue::get(first->getType());
+
+        std::vector<llvm::Constant*> mask;
+        for(size_t i = firstLane; i < expr.arguments().size(); ++i) {
+            auto &lane = upcast<ast::LiteralInt32Expr>(expr.arguments()[i].get());
+            mask.push_back(llvm::ConstantInt::get(llvm::Type::getInt32Ty(cc().llvmContext()), (uint64_t) lane.value()));
+        }
+        return cc().irBuilder().CreateShuffleVector(first, second, llvm::ConstantVector::get(mask));
+    }
+
+    /**
+     * Combines the upper half of the lanes with the lower half until only one lane remains, which is the same sequence
+     * of shuffles LLVM's vectorizer emits for reductions and which the code generator recognizes.
+     */
+    llvm::Value *emitLaneReduction(ast::ReductionKind reduction, llvm::Value *vector, unsigned laneCount) {
+        llvm::Type *int32Type = llvm::Type::getInt32Ty(cc().llvmContext());
+        for(unsigned width = laneCount / 2; width > 0; width /= 2) {
+            std::vector<llvm::Constant*> mask;
+            for(unsigned i = 0; i < laneCount; ++i) {
+                mask.push_back(i < width ? llvm::ConstantInt::get(int32Type, i + width) : llvm::UndefValue::get(int32Type));
+            }
+            llvm::Value *upperHalf = cc().irBuilder().CreateShuffleVector(
+                vector,
+                llvm::UndefValue::get(vector->getType()),
+                llvm::ConstantVector::get(mask));
+            vector = emitReduction(reduction, vector, upperHalf);
+        }
+        return cc().irBuilder().CreateExtractElement(vector, getLiteralIntLlvmValue(0));
+    }
+
+public:
+
     void visitedVariableDeclExpr(ast::VariableDeclExpr &expr) override {
         switch (expr.symbol()->storageKind()) {
             case scope::StorageKind::Global: {
-                llvm::GlobalVariable *globalVariable = cc().llvmModule().getNamedGlobal(expr.symbol()->fullyQualifiedName());
+                llvm::GlobalVariable *globalVariable = cc().llvmModule().getNamedGlobal(expr.symbol()->fullyQualifiedName().text());
                 ASSERT(globalVariable);
                 globalVariable->setAlignment(ALIGNMENT);
                 llvm::Constant *val = cc().getDefaultValueForType(expr.exprType());
@@ -182,12 +593,12 @@ public:
         if (expr.symbol()->storageKind() == scope::StorageKind::Instance) {
             //Variable is an instance field
             scope::VariableSymbol *thisSymbol = cc().currentFuncDefStmt()->symbol()->thisSymbol();
-            auto classType = dynamic_cast<type::ClassType *>(&thisSymbol->type());
+            auto classType = tryUpcast<type::ClassType>(&thisSymbol->type());
             ASSERT(classType);
             llvm::Value *pointerToPointerToStruct = cc().getMappedValue(thisSymbol);
             llvm::Value *pointerToStruct = cc().irBuilder().CreateLoad(pointerToPointerToStruct);
             ASSERT(expr.name().size() == 1);
-            pointer = createStructGep(classType, pointerToStruct, expr.name().front().text());
+            pointer = createStructGep(classType, pointerToStruct, expr.name().front().atom());
         } else {
             //Variable is an argument or local variable.
             pointer = cc().getMappedValue(expr.symbol());
@@ -210,13 +621,13 @@ public:
     }
 
 private:
-    llvm::Value *createStructGep(type::ClassType *classType, llvm::Value *instance, const std::string &memberName) {
+    llvm::Value *createStructGep(type::ClassType *classType, llvm::Value *instance, Atom memberName) {
         ASSERT(classType != nullptr);
         type::ClassField *classField = classType->findField(memberName);
         unsigned ordinal = classField->ordinal();
 
         //First emit code to calculate the address of the member field
-        llvm::Value *ptr = cc().irBuilder().CreateStructGEP(nullptr, instance, ordinal, classField->name());
+        llvm::Value *ptr = cc().irBuilder().CreateStructGEP(nullptr, instance, ordinal, classField->name().text());
         return ptr;
     }
 
@@ -225,10 +636,15 @@ protected:
     void visitedDotExpr(ast::DotExpr &expr) override {
         llvm::Value *instance = emitExpr(expr.lValue(), cc());
 
-        auto classType = dynamic_cast<type::ClassType *>(expr.lValue().exprType().actualType());
+        if(expr.isArrayLength()) {
+            setValue(emitArrayLength(instance));
+            return;
+        }
+
+        auto classType = tryUpcast<type::ClassType>(expr.lValue().exprType().actualType());
         ASSERT(classType != nullptr && "lvalues of dot operator must be a ClassType (did the semantic check fail?)");
 
-        llvm::Value *ptrOrValue = createStructGep(classType, instance, expr.memberName().text());
+        llvm::Value *ptrOrValue = createStructGep(classType, instance, expr.memberName().atom());
 
         if (expr.isWrite() || expr.exprType().isFunction()) {
             setValue(ptrOrValue);
@@ -279,8 +695,14 @@ private:
             return;
         }
         llvm::Value *resultValue = nullptr;
-        ASSERT(expr.exprType().isPrimitive() && "Only primitive types currently supported here");
-        switch (expr.operandsType().primitiveType()) {
+        type::PrimitiveType operandsPrimitiveType = expr.operandsType().primitiveType();
+        //LLVM applies arithmetic instructions to each lane of vectors, so they are emitted the same as for their elements.
+        if(auto vectorType = tryUpcast<type::VectorType>(expr.operandsType().actualType())) {
+            ASSERT(!expr.isComparison());
+            operandsPrimitiveType = vectorType->elementType().primitiveType();
+        }
+        ASSERT(operandsPrimitiveType != type::PrimitiveType::NotAPrimitive && "Only primitive types and vectors currently supported here");
+        switch (operandsPrimitiveType) {
             case type::PrimitiveType::Bool:
                 switch (expr.operation()) {
                     case ast::BinaryOperationKind::Eq:
@@ -386,11 +808,11 @@ private:
         switch (expr.operation()) {
             //For the && operator, only evaluate the lValue if the rValue is true
             case ast::BinaryOperationKind::LogicalAnd:
-                cc().irBuilder().CreateCondBr(lValue, rValueBlock, endBlock);
+                cc().createCondBr(lValue, rValueBlock, endBlock, "and");
                 lValueConst = false;
                 break;
             case ast::BinaryOperationKind::LogicalOr:
-                cc().irBuilder().CreateCondBr(lValue, endBlock, rValueBlock);
+                cc().createCondBr(lValue, endBlock, rValueBlock, "or");
                 lValueConst = true;
                 break;
             default:
@@ -426,7 +848,7 @@ protected:
         llvm::BasicBlock *endBlock = llvm::BasicBlock::Create(cc().llvmContext(), "endBlock");
 
         //Branch to then or else blocks, depending on condition.
-        cc().irBuilder().CreateCondBr(condValue, thenBlock, elseBlock);
+        cc().createCondBr(condValue, thenBlock, elseBlock, "if");
 
         //Emit the thenBlock
         currentFunc->getBasicBlockList().push_back(thenBlock);
@@ -480,7 +902,7 @@ protected:
         llvm::Value *condValue = emitExpr(whileExpr.condition(), cc());
 
         //If the condition is true branch to the body block, otherwise branch to the end block
-        cc().irBuilder().CreateCondBr(condValue, bodyBlock, endBlock);
+        cc().createCondBr(condValue, bodyBlock, endBlock, "while");
 
         //Emit the body block
         currentFunc->getBasicBlockList().push_back(bodyBlock);
@@ -496,7 +918,313 @@ protected:
         setValue(nullptr);
     }
 
+    void visitingForExpr(ast::ForExpr &forExpr) override {
+        llvm::Value *begin = emitExpr(forExpr.rangeBegin(), cc());
+        llvm::Value *end = emitExpr(forExpr.rangeEnd(), cc());
+
+        if(forExpr.isParallel()) {
+            setValue(emitParallelFor(forExpr, begin, end));
+        } else {
+            llvm::Value *identity = forExpr.reduction() == ast::ReductionKind::None ? nullptr : getReductionIdentity(forExpr);
+            setValue(emitCountedLoop(forExpr, begin, end, identity));
+        }
+    }
+
 private:
+    /** Allocas in the entry block are promoted to registers by LLVM, unlike those within loops. */
+    llvm::Value *createEntryBlockAlloca(llvm::Type *type, const std::string &name) {
+        llvm::BasicBlock &entryBlock = cc().irBuilder().GetInsertBlock()->getParent()->getEntryBlock();
+        llvm::IRBuilder<> entryBuilder{&entryBlock, entryBlock.begin()};
+        return entryBuilder.CreateAlloca(type, nullptr, name);
+    }
+
+    /**
+     * Emits a loop which evaluates the body of the for expression for each of the iterations [begin, end).  If the loop is
+     * a reduction, the values of the body are combined with initialValue and the result is returned.
+     *
+     * The loop is emitted in the canonical form expected by LLVM's loop passes:  a guard which skips the loop when the
+     * range is empty, a preheader, an induction variable which is a phi node starting at begin and incremented by one in
+     * the single latch, which is also the only exit.  The loop's hints are attached to the latch's branch as llvm.loop
+     * metadata.
+     */
+    llvm::Value *emitCountedLoop(ast::ForExpr &forExpr, llvm::Value *begin, llvm::Value *end, llvm::Value *initialValue) {
+        llvm::Function *currentFunc = cc().irBuilder().GetInsertBlock()->getParent();
+        llvm::Type *int32Type = llvm::Type::getInt32Ty(cc().llvmContext());
+
+        //The body refers to the loop variable as it would to any other variable.  Since nothing else is stored to this
+        //alloca, it is replaced with the phi node below once the function's allocas are promoted to registers.
+        llvm::Value *inductionVarAlloca = createEntryBlockAlloca(int32Type, forExpr.inductionVar().name().front().text());
+        cc().mapSymbolToValue(*forExpr.inductionVar().symbol(), inductionVarAlloca);
+
+        //Prepare the BasicBlocks
+        llvm::BasicBlock *guardBlock = cc().irBuilder().GetInsertBlock();
+        llvm::BasicBlock *preheaderBlock = llvm::BasicBlock::Create(cc().llvmContext(), "forPreheader");
+        llvm::BasicBlock *bodyBlock = llvm::BasicBlock::Create(cc().llvmContext(), "forBody");
+        llvm::BasicBlock *latchBlock = llvm::BasicBlock::Create(cc().llvmContext(), "forLatch");
+        llvm::BasicBlock *endBlock = llvm::BasicBlock::Create(cc().llvmContext(), "forEnd");
+
+        //Skip the loop when the range is empty so that the condition need only be tested after each iteration.
+        cc().createCondBr(cc().irBuilder().CreateICmpSLT(begin, end), preheaderBlock, endBlock, "forGuard");
+
+        currentFunc->getBasicBlockList().push_back(preheaderBlock);
+        cc().irBuilder().SetInsertPoint(preheaderBlock);
+        cc().irBuilder().CreateBr(bodyBlock);
+
+        //Emit the body block, which combines its value with the accumulator of reductions
+        currentFunc->getBasicBlockList().push_back(bodyBlock);
+        cc().irBuilder().SetInsertPoint(bodyBlock);
+        llvm::PHINode *inductionVar = cc().irBuilder().CreatePHI(int32Type, 2, "index");
+        inductionVar->addIncoming(begin, preheaderBlock);
+        llvm::PHINode *accumulator = nullptr;
+        if(initialValue) {
+            accumulator = cc().irBuilder().CreatePHI(initialValue->getType(), 2, "accumulator");
+            accumulator->addIncoming(initialValue, preheaderBlock);
+        }
+        cc().irBuilder().CreateStore(inductionVar, inductionVarAlloca);
+
+        llvm::Value *bodyValue = emitExpr(forExpr.body(), cc());
+        llvm::Value *accumulated = accumulator ? emitReduction(forExpr.reduction(), accumulator, bodyValue) : nullptr;
+        cc().irBuilder().CreateBr(latchBlock);
+
+        //Emit the latch.  The loop variable is never assigned within the body and is less than end, so this cannot overflow.
+        currentFunc->getBasicBlockList().push_back(latchBlock);
+        cc().irBuilder().SetInsertPoint(latchBlock);
+        llvm::Value *nextIndex = cc().irBuilder().CreateNSWAdd(inductionVar, getLiteralIntLlvmValue(1), "nextIndex");
+        llvm::BranchInst *backEdge = cc().createCondBr(
+            cc().irBuilder().CreateICmpSLT(nextIndex, end),
+            bodyBlock,
+            endBlock,
+            "forLatch");
+        if(llvm::MDNode *loopId = createLoopId(forExpr.hints())) {
+            backEdge->setMetadata(llvm::LLVMContext::MD_loop, loopId);
+        }
+        inductionVar->addIncoming(nextIndex, latchBlock);
+        if(accumulator) {
+            accumulator->addIncoming(accumulated, latchBlock);
+        }
+
+        //Emit the end block
+        currentFunc->getBasicBlockList().push_back(endBlock);
+        cc().irBuilder().SetInsertPoint(endBlock);
+        if(!accumulator) {
+            return nullptr;
+        }
+        llvm::PHINode *result = cc().irBuilder().CreatePHI(initialValue->getType(), 2, "reduced");
+        result->addIncoming(initialValue, guardBlock);
+        result->addIncoming(accumulated, latchBlock);
+        return result;
+    }
+
+    /**
+     * Creates the distinct, self-referencing metadata node which identifies a loop and carries its hints to the loop
+     * vectorizer and unroller, or returns null if there are no hints.
+     */
+    llvm::MDNode *createLoopId(const ast::LoopHints &hints) {
+        if(!hints.any()) {
+            return nullptr;
+        }
+        llvm::LLVMContext &context = cc().llvmContext();
+
+        //The first operand is the loop id itself, which is replaced once the node exists.
+        auto placeholder = llvm::MDNode::getTemporary(context, llvm::None);
+        std::vector<llvm::Metadata *> operands { placeholder.get() };
+        if(hints.vectorize) {
+            operands.push_back(llvm::MDNode::get(context, {
+                llvm::MDString::get(context, "llvm.loop.vectorize.enable"),
+                llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(context))
+            }));
+        }
+        if(hints.unrollCount == 1) {
+            operands.push_back(llvm::MDNode::get(context, { llvm::MDString::get(context, "llvm.loop.unroll.disable") }));
+        } else if(hints.unrollCount > 1) {
+            operands.push_back(llvm::MDNode::get(context, {
+                llvm::MDString::get(context, "llvm.loop.unroll.count"),
+                llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), hints.unrollCount))
+            }));
+        }
+
+        llvm::MDNode *loopId = llvm::MDNode::get(context, operands);
+        loopId->replaceOperandWith(0, loopId);
+        return loopId;
+    }
+
+    /** Also reduces each lane of vectors. */
+    llvm::Value *emitReduction(ast::ReductionKind reduction, llvm::Value *left, llvm::Value *right) {
+        bool isFloatingPoint = left->getType()->getScalarType()->isFloatingPointTy();
+        switch(reduction) {
+            case ast::ReductionKind::Add:
+                return isFloatingPoint ? cc().irBuilder().CreateFAdd(left, right) : cc().irBuilder().CreateAdd(left, right);
+            case ast::ReductionKind::Mul:
+                return isFloatingPoint ? cc().irBuilder().CreateFMul(left, right) : cc().irBuilder().CreateMul(left, right);
+            case ast::ReductionKind::Min: {
+                llvm::Value *isLess = isFloatingPoint
+                    ? cc().irBuilder().CreateFCmpOLT(right, left)
+                    : cc().irBuilder().CreateICmpSLT(right, left);
+                return cc().irBuilder().CreateSelect(isLess, right, left);
+            }
+            case ast::ReductionKind::Max: {
+                llvm::Value *isGreater = isFloatingPoint
+                    ? cc().irBuilder().CreateFCmpOGT(right, left)
+                    : cc().irBuilder().CreateICmpSGT(right, left);
+                return cc().irBuilder().CreateSelect(isGreater, right, left);
+            }
+            default:
+                ASSERT_FAIL("Unhandled ReductionKind");
+        }
+    }
+
+    llvm::Constant *getReductionIdentity(ast::ForExpr &forExpr) {
+        //Constants of vector types are copied to each lane.
+        llvm::Type *type = cc().typeMap().toLlvmType(forExpr.exprType());
+        bool isFloatingPoint = type->getScalarType()->isFloatingPointTy();
+        switch(forExpr.reduction()) {
+            case ast::ReductionKind::Add:
+                return isFloatingPoint ? llvm::ConstantFP::get(type, 0.0) : llvm::ConstantInt::get(type, 0);
+            case ast::ReductionKind::Mul:
+                return isFloatingPoint ? llvm::ConstantFP::get(type, 1.0) : llvm::ConstantInt::get(type, 1);
+            case ast::ReductionKind::Min:
+                return isFloatingPoint
+                    ? llvm::ConstantFP::getInfinity(type, /*Negative*/ false)
+                    : llvm::ConstantInt::get(type, llvm::APInt::getSignedMaxValue(type->getScalarSizeInBits()));
+            case ast::ReductionKind::Max:
+                return isFloatingPoint
+                    ? llvm::ConstantFP::getInfinity(type, /*Negative*/ true)
+                    : llvm::ConstantInt::get(type, llvm::APInt::getSignedMinValue(type->getScalarSizeInBits()));
+            default:
+                ASSERT_FAIL("Unhandled ReductionKind");
+        }
+    }
+
+    /**
+     * Emits the body of the parallel for as a function (see emitLoopChunkFunc(...)) and passes it to the runtime, which
+     * invokes it for chunks of the range on several threads.  The function accesses the variables it captures from this one
+     * through pointers in a context struct on this function's stack, which is safe because the runtime returns only once
+     * every iteration is complete.
+     */
+    llvm::Value *emitParallelFor(ast::ForExpr &forExpr, llvm::Value *begin, llvm::Value *end) {
+        CapturedVariablesAstVisitor capturedVisitor{cc(), forExpr};
+        forExpr.body().accept(capturedVisitor);
+        const gc_ref_vector<scope::Symbol> &captured = capturedVisitor.captured();
+
+        std::vector<llvm::Type *> contextFieldTypes;
+        for(scope::Symbol &symbol : captured) {
+            contextFieldTypes.push_back(cc().getMappedValue(&symbol)->getType());
+        }
+        llvm::StructType *contextType = llvm::StructType::get(cc().llvmContext(), contextFieldTypes);
+        llvm::Value *context = createEntryBlockAlloca(contextType, "parallelForContext");
+        unsigned fieldIndex = 0;
+        for(scope::Symbol &symbol : captured) {
+            cc().irBuilder().CreateStore(cc().getMappedValue(&symbol), cc().irBuilder().CreateStructGEP(contextType, context, fieldIndex++));
+        }
+
+        llvm::PointerType *int8PtrType = llvm::Type::getInt8PtrTy(cc().llvmContext());
+        llvm::Type *resultType = nullptr;
+        llvm::Value *result = nullptr;
+        llvm::Value *combineFunc = llvm::ConstantPointerNull::get(cc().loopCombineFuncType()->getPointerTo());
+        uint64_t resultSize = 0;
+        if(forExpr.reduction() != ast::ReductionKind::None) {
+            resultType = cc().typeMap().toLlvmType(forExpr.exprType());
+            result = createEntryBlockAlloca(resultType, "reduction");
+            cc().irBuilder().CreateStore(getReductionIdentity(forExpr), result);
+            combineFunc = emitLoopCombineFunc(forExpr.reduction(), resultType);
+            resultSize = cc().llvmModule().getDataLayout().getTypeAllocSize(resultType);
+        }
+
+        std::vector<llvm::Value *> arguments {
+            emitLoopChunkFunc(forExpr, captured, contextType, resultType),
+            combineFunc,
+            cc().irBuilder().CreatePointerCast(context, int8PtrType),
+            begin,
+            end,
+            result ? cc().irBuilder().CreatePointerCast(result, int8PtrType) : llvm::ConstantPointerNull::get(int8PtrType),
+            getLiteralUIntLLvmValue((unsigned int) resultSize)
+        };
+        cc().irBuilder().CreateCall(cc().parallelForFunc(), arguments);
+
+        return result ? cc().irBuilder().CreateLoad(result) : nullptr;
+    }
+
+    /**
+     * Emits the function which executes a chunk of the iterations of a parallel for.  While its body is emitted, the
+     * captured variables are mapped to the pointers loaded from the context instead of to the enclosing function's allocas.
+     */
+    llvm::Function *emitLoopChunkFunc(
+        ast::ForExpr &forExpr,
+        const gc_ref_vector<scope::Symbol> &captured,
+        llvm::StructType *contextType,
+        llvm::Type *resultType
+    ) {
+        llvm::Function *chunkFunc = llvm::Function::Create(
+            cc().loopChunkFuncType(),
+            llvm::GlobalValue::InternalLinkage,
+            "__parallel_for_chunk__",
+            &cc().llvmModule());
+        cc().addFloatingPointAttributes(*chunkFunc);
+
+        auto paramItr = chunkFunc->arg_begin();
+        llvm::Value *contextArg = paramItr++;
+        contextArg->setName("context");
+        llvm::Value *begin = paramItr++;
+        begin->setName("begin");
+        llvm::Value *end = paramItr++;
+        end->setName("end");
+        llvm::Value *partial = paramItr;
+        partial->setName("partial");
+
+        //The parallel for is in the middle of another function, to which we must return afterward.
+        llvm::IRBuilderBase::InsertPoint loopInsertPoint = cc().irBuilder().saveIP();
+        cc().irBuilder().SetInsertPoint(llvm::BasicBlock::Create(cc().llvmContext(), "begin", chunkFunc));
+
+        std::vector<llvm::Value *> enclosingValues;
+        llvm::Value *context = cc().irBuilder().CreatePointerCast(contextArg, contextType->getPointerTo());
+        unsigned fieldIndex = 0;
+        for(scope::Symbol &symbol : captured) {
+            enclosingValues.push_back(cc().getMappedValue(&symbol));
+            llvm::Value *pointer = cc().irBuilder().CreateLoad(cc().irBuilder().CreateStructGEP(contextType, context, fieldIndex++));
+            cc().mapSymbolToValue(symbol, pointer);
+        }
+
+        llvm::Value *typedPartial = nullptr;
+        llvm::Value *initialValue = nullptr;
+        if(resultType) {
+            typedPartial = cc().irBuilder().CreatePointerCast(partial, resultType->getPointerTo());
+            initialValue = cc().irBuilder().CreateLoad(typedPartial);
+        }
+        llvm::Value *partialResult = emitCountedLoop(forExpr, begin, end, initialValue);
+        if(typedPartial) {
+            cc().irBuilder().CreateStore(partialResult, typedPartial);
+        }
+        cc().irBuilder().CreateRetVoid();
+
+        for(size_t i = 0; i < captured.size(); ++i) {
+            cc().mapSymbolToValue(captured[i], enclosingValues[i]);
+        }
+        cc().irBuilder().restoreIP(loopInsertPoint);
+        return chunkFunc;
+    }
+
+    /** Emits the function with which the runtime combines the partial results of a reduction. */
+    llvm::Function *emitLoopCombineFunc(ast::ReductionKind reduction, llvm::Type *resultType) {
+        llvm::Function *combineFunc = llvm::Function::Create(
+            cc().loopCombineFuncType(),
+            llvm::GlobalValue::InternalLinkage,
+            "__parallel_for_combine__",
+            &cc().llvmModule());
+        cc().addFloatingPointAttributes(*combineFunc);
+
+        llvm::IRBuilderBase::InsertPoint loopInsertPoint = cc().irBuilder().saveIP();
+        cc().irBuilder().SetInsertPoint(llvm::BasicBlock::Create(cc().llvmContext(), "begin", combineFunc));
+
+        auto paramItr = combineFunc->arg_begin();
+        llvm::Value *into = cc().irBuilder().CreatePointerCast(&*paramItr++, resultType->getPointerTo());
+        llvm::Value *from = cc().irBuilder().CreatePointerCast(&*paramItr, resultType->getPointerTo());
+        llvm::Value *combined = emitReduction(reduction, cc().irBuilder().CreateLoad(into), cc().irBuilder().CreateLoad(from));
+        cc().irBuilder().CreateStore(combined, into);
+        cc().irBuilder().CreateRetVoid();
+
+        cc().irBuilder().restoreIP(loopInsertPoint);
+        return combineFunc;
+    }
 
     void visitExpressions(const gc_ref_vector<ast::ExprStmt> &expressions) {
         llvm::Value *lastValue = nullptr;
@@ -529,7 +1257,7 @@ private:
         llvm::BasicBlock *endBlock = llvm::BasicBlock::Create(cc().llvmContext(), "assertEndBlock");
 
         //Branch to then or else blocks, depending on condition.
-        cc().irBuilder().CreateCondBr(condValue, passBlock, failBlock);
+        cc().createCondBr(condValue, passBlock, failBlock, "assert");
 
         //Emit the passBlock
         currentFunc->getBasicBlockList().push_back(passBlock);
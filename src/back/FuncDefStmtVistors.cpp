@@ -37,7 +37,7 @@ private:
         llvm::FunctionType *functionType = llvm::FunctionType::get(returnLlvmType, llvmParamTypes, /*isVarArg*/ false);
 
         auto * llvmFunc = llvm::cast<llvm::Function>(
-            cc().llvmModule().getOrInsertFunction(functionSymbol.fullyQualifiedName(), functionType));
+            cc().llvmModule().getOrInsertFunction(functionSymbol.fullyQualifiedName().text(), functionType));
 
         llvmFunc->setCallingConv(llvm::CallingConv::C);
 
@@ -51,12 +51,22 @@ public:
 
         //All external functions must be added to the current llvm module.
         //TODO:  emit only those functions which are actually referenced.
-        gc_ref_vector<scope::FunctionSymbol> functions = cc().world().globalScope().functions();
+        const gc_ref_vector<scope::FunctionSymbol> &functions = cc().world().globalScope().functions();
         for(scope::FunctionSymbol &functionSymbol : functions) {
             //Skip functions that are not defined externally - we do that in visitingFuncDefStmt, below...
             if(functionSymbol.isExternal())
                 declareFunction(functionSymbol);
         }
+
+        //As must the methods of external classes, which are not in the global scope.
+        for(scope::TypeSymbol &typeSymbol : cc().world().globalScope().types()) {
+            if(!typeSymbol.isExternal()) continue;
+            if(auto classType = tryUpcast<type::ClassType>(typeSymbol.type().actualType())) {
+                for(type::ClassMethod &method : classType->methods()) {
+                    declareFunction(method.symbol());
+                }
+            }
+        }
     }
 
     void visitingFuncDefStmt(ast::FuncDefStmt &funcDef) override {
@@ -67,11 +77,11 @@ public:
 class DefineFuncsAstVisitor : public CompileAstVisitor {
 
     void emitCopyParameterToLocal(llvm::Argument &argument, scope::Symbol *argumentSymbol) {
-        argument.setName(argumentSymbol->name());
+        argument.setName(argumentSymbol->name().text());
         llvm::Type *localParamType = cc().typeMap().toLlvmType(argumentSymbol->type());
 
         llvm::AllocaInst *localParamValue = cc().irBuilder().CreateAlloca(localParamType);
-        localParamValue->setName("local_" + argumentSymbol->name());
+        localParamValue->setName("local_" + argumentSymbol->name().text());
         cc().irBuilder().CreateStore(&argument, localParamValue);
 
         cc().mapSymbolToValue(*argumentSymbol, localParamValue);
@@ -90,6 +100,9 @@ public:
         auto *llvmFunc = llvm::cast<llvm::Function>(functionPtr);
         auto startBlock = llvm::BasicBlock::Create(cc().llvmContext(), "begin", llvmFunc);
 
+        ast::FloatingPointMode enclosingFloatingPointMode = cc().setFloatingPointMode(funcDef.floatingPointMode());
+        cc().addFloatingPointAttributes(*llvmFunc);
+
         cc().irBuilder().SetInsertPoint(startBlock);
 
         // Copy parameters to local variables where needed and map them to their symbols.  If this seems weird, that's because it is...
@@ -116,6 +129,8 @@ public:
             emitCopyParameterToLocal(argument, parameterDef.symbol());
         }
 
+        cc().countFunctionEntry(*llvmFunc);
+
         cc().pushFuncDefStmt(&funcDef);
         llvm::Value *returnValue = emitExpr(funcDef.body(), cc());
         cc().popFuncDefStmt();
@@ -129,6 +144,7 @@ public:
 
         //Restore the state of the IR builder.
         cc().irBuilder().SetInsertPoint(oldBasicBlock, oldInsertPoint);
+        cc().setFloatingPointMode(enclosingFloatingPointMode);
     }
 };
 
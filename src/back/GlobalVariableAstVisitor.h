@@ -10,12 +10,12 @@ class GlobalVariableAstVisitor : public CompileAstVisitor {
 
     void defineGlobal(front::scope::VariableSymbol &symbol) {
         llvm::Type *llvmType = cc().typeMap().toLlvmType(symbol.type());
-        cc().llvmModule().getOrInsertGlobal(symbol.fullyQualifiedName(), llvmType);
-        llvm::GlobalVariable *globalVar = cc().llvmModule().getNamedGlobal(symbol.fullyQualifiedName());
+        cc().llvmModule().getOrInsertGlobal(symbol.fullyQualifiedName().text(), llvmType);
+        llvm::GlobalVariable *globalVar = cc().llvmModule().getNamedGlobal(symbol.fullyQualifiedName().text());
         cc().mapSymbolToValue(symbol, globalVar);
         globalVar->setAlignment(ALIGNMENT);
 
-        if(symbol.type().isClass()) {
+        if(symbol.type().isClass() || isInstanceOf<front::type::ArrayType>(symbol.type().actualType())) {
 
             if (symbol.isExternal()) {
                 //ExternalWeakLinkage defines a symbol in the current module that can be
@@ -43,7 +43,7 @@ public:
 
     void visitingVariableDeclExpr(front::ast::VariableDeclExpr &varDef) override {
         if(varDef.symbol()->storageKind() == front::scope::StorageKind::Global) {
-            auto variableSymbol = dynamic_cast<front::scope::VariableSymbol*>(varDef.symbol());
+            auto variableSymbol = tryUpcast<front::scope::VariableSymbol>(varDef.symbol());
             ASSERT(variableSymbol)
             defineGlobal(*variableSymbol);
         }
@@ -55,7 +55,7 @@ public:
         //The reason for doing this here in addition to visitVariableDeclExpr is because symbols defined in other modules (isExternal)
         //do not have VariableDeclExprs in the AST but they do exist as symbols in the global scope.
         //TODO:  emit only those GlobalVariables which are actually referenced...
-        gc_ref_vector<front::scope::VariableSymbol> globals = cc().world().globalScope().variables();
+        const gc_ref_vector<front::scope::VariableSymbol> &globals = cc().world().globalScope().variables();
         for (front::scope::VariableSymbol &symbol : globals) {
             if(symbol.isExternal()) {
                 defineGlobal(symbol);
@@ -6,6 +6,7 @@
 #include "CompileAstVisitor.h"
 #include "llvm.h"
 #include "GlobalVariableAstVisitor.h"
+#include "common/stats.h"
 
 
 /**
@@ -69,7 +70,7 @@ public:
 
         declareResultFunction();
         startModuleInitFunc(module);
-        declareExecutionContextGlobal();
+        loadExecutionContext();
         emitGlobals(module, cc_);
         emitFuncDefs(module, cc_);
 
@@ -78,8 +79,15 @@ public:
         }
 
         cc_.irBuilder().CreateRetVoid();
+        cc_.emitCounterRegistration(*initFunc_);
+
         llvm::raw_ostream &os = llvm::errs();
-        if (llvm::verifyModule(cc_.llvmModule(), &os)) {
+        bool verificationFailed;
+        {
+            stats::PhaseTimer timer{"back.verifyModule"};
+            verificationFailed = llvm::verifyModule(cc_.llvmModule(), &os);
+        }
+        if (verificationFailed) {
             std::cerr << "Module dump: \n";
             std::cerr.flush();
 #ifdef ANODE_DEBUG
@@ -102,6 +110,7 @@ private:
             cc_.llvmModule().getOrInsertFunction(module->name() + MODULE_INIT_SUFFIX, initFuncRetType));
 
         initFunc_->setCallingConv(llvm::CallingConv::C);
+        cc_.addFloatingPointAttributes(*initFunc_);
         auto initFuncBlock = llvm::BasicBlock::Create(cc_.llvmContext(), "begin", initFunc_);
 
         cc_.irBuilder().SetInsertPoint(initFuncBlock);
@@ -127,13 +136,17 @@ private:
         valuePtr->setName("valuePtr");
     }
 
-    void declareExecutionContextGlobal() {
-        cc_.llvmModule().getOrInsertGlobal(EXECUTION_CONTEXT_GLOBAL_NAME, llvm::Type::getInt64Ty(cc_.llvmContext()));
-        llvm::GlobalVariable *globalVar = cc_.llvmModule().getNamedGlobal(EXECUTION_CONTEXT_GLOBAL_NAME);
-        globalVar->setLinkage(llvm::GlobalValue::ExternalLinkage);
-        globalVar->setAlignment(ALIGNMENT);
-
-        executionContextPtrValue_ = globalVar;
+    /**
+     * The ExecutionContext is thread-local (see runtime::ExecutionContextScope) since threads executing spawned tasks may be
+     * doing so on behalf of different ExecutionContexts, so it is obtained from the runtime rather than a global variable.
+     */
+    void loadExecutionContext() {
+        auto executionContextFunc = llvm::cast<llvm::Function>(cc_.llvmModule().getOrInsertFunction(
+            EXECUTION_CONTEXT_FUNC_NAME,
+            llvm::Type::getInt64PtrTy(cc_.llvmContext())    //Pointer to ExecutionContext
+        ));
+
+        executionContextPtrValue_ = cc_.irBuilder().CreateCall(executionContextFunc, {}, "executionContext");
     }
 };
 
@@ -142,17 +155,37 @@ std::unique_ptr<llvm::Module> emitModule(
     anode::front::ast::Module *module,
     anode::back::TypeMap &typeMap,
     llvm::LLVMContext &llvmContext,
-    llvm::TargetMachine *targetMachine
+    llvm::TargetMachine *targetMachine,
+    front::ast::FloatingPointMode floatingPointMode,
+    const ProfileOptions &profileOptions
 ) {
 
     std::unique_ptr<llvm::Module> llvmModule = std::make_unique<llvm::Module>(module->name(), llvmContext);
-    llvm::IRBuilder<> irBuilder{llvmContext};
+    {
+        //Includes the time spent verifying the module, which is also reported separately.
+        stats::PhaseTimer timer{"back.emitModule"};
+        llvm::IRBuilder<> irBuilder{llvmContext};
+
+        CompileContext cc{world, llvmContext, *llvmModule.get(), irBuilder, typeMap, floatingPointMode, profileOptions};
+        ModuleEmitter visitor{cc, *targetMachine};
+        visitor.emitModule(module);
+    }
 
-    CompileContext cc{world, llvmContext, *llvmModule.get(), irBuilder, typeMap};
-    ModuleEmitter visitor{cc, *targetMachine};
-    visitor.emitModule(module);
+    if(stats::global().enabled()) {
+        stats::global().addModuleStatistic(module->name(), "irInstructionsEmitted", countInstructions(*llvmModule));
+    }
 
     return llvmModule;
 }
 
+unsigned long countInstructions(const llvm::Module &llvmModule) {
+    unsigned long count = 0;
+    for(const llvm::Function &function : llvmModule) {
+        for(const llvm::BasicBlock &block : function) {
+            count += block.size();
+        }
+    }
+    return count;
+}
+
 }}
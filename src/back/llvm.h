@@ -7,6 +7,8 @@
 #pragma GCC diagnostic ignored "-Wgnu-statement-expression"
 
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Verifier.h"
 
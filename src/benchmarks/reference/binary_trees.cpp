@@ -0,0 +1,46 @@
+#include "reference.h"
+
+struct TreeNode {
+    TreeNode *left = nullptr;
+    TreeNode *right = nullptr;
+    ~TreeNode() {
+        delete left;
+        delete right;
+    }
+};
+
+static TreeNode *bottomUpTree(int depth) {
+    TreeNode *node = new TreeNode();
+    if(depth > 0) {
+        node->left = bottomUpTree(depth - 1);
+        node->right = bottomUpTree(depth - 1);
+    }
+    return node;
+}
+
+static int check(TreeNode *node, int depth) {
+    return depth == 0 ? 1 : 1 + check(node->left, depth - 1) + check(node->right, depth - 1);
+}
+
+static int binaryTrees(int minDepth, int maxDepth) {
+    TreeNode *stretch = bottomUpTree(maxDepth + 1);
+    int checksum = check(stretch, maxDepth + 1);
+    delete stretch;
+
+    TreeNode *longLived = bottomUpTree(maxDepth);
+    for(int depth = minDepth; depth <= maxDepth; depth += 2) {
+        int iterations = 1 << (maxDepth - depth + minDepth);
+        for(int i = 0; i < iterations; ++i) {
+            TreeNode *tree = bottomUpTree(depth);
+            checksum += check(tree, depth);
+            delete tree;
+        }
+    }
+    checksum += check(longLived, maxDepth);
+    delete longLived;
+    return checksum;
+}
+
+int main() {
+    return reference::run("binary_trees", [] { return binaryTrees(4, 14); }, 3222190);
+}
@@ -0,0 +1,9 @@
+#include "reference.h"
+
+static int fibonacci(int n) {
+    return n == 0 || n == 1 ? n : fibonacci(n - 1) + fibonacci(n - 2);
+}
+
+int main() {
+    return reference::run("fib", [] { return fibonacci(35); }, 9227465);
+}
@@ -0,0 +1,26 @@
+#include "reference.h"
+
+static int countInside(int size, int maxIterations) {
+    int inside = 0;
+    for(int y = 0; y < size; ++y) {
+        for(int x = 0; x < size; ++x) {
+            float cr = 2.5f * (float)x / (float)size - 2.0f;
+            float ci = 2.5f * (float)y / (float)size - 1.25f;
+            float zr = 0.0f;
+            float zi = 0.0f;
+            int i = 0;
+            while(i < maxIterations && zr * zr + zi * zi <= 4.0f) {
+                float t = zr * zr - zi * zi + cr;
+                zi = 2.0f * zr * zi + ci;
+                zr = t;
+                i = i + 1;
+            }
+            if(i == maxIterations) inside = inside + 1;
+        }
+    }
+    return inside;
+}
+
+int main() {
+    return reference::run("mandelbrot", [] { return countInside(800, 100); }, 158556);
+}
@@ -0,0 +1,27 @@
+#include "reference.h"
+
+#include <vector>
+
+static int multiply(int n) {
+    std::vector<float> a(n * n), b(n * n), c(n * n);
+    for(int i = 0; i < n; ++i) {
+        for(int j = 0; j < n; ++j) {
+            a[i * n + j] = (float)((i + j) % 7);
+            b[i * n + j] = (float)((i * 2 + j) % 5);
+        }
+    }
+    for(int i = 0; i < n; ++i) {
+        for(int j = 0; j < n; ++j) {
+            float sum = 0.0f;
+            for(int k = 0; k < n; ++k) sum += a[i * n + k] * b[k * n + j];
+            c[i * n + j] = sum;
+        }
+    }
+    int checksum = 0;
+    for(int i = 0; i < n * n; ++i) checksum += (int)c[i];
+    return checksum;
+}
+
+int main() {
+    return reference::run("matrix_multiply", [] { return multiply(300); }, 162001200);
+}
@@ -0,0 +1,109 @@
+#include "reference.h"
+
+#include <vector>
+
+namespace {
+
+const float Pi = 3.14159265f;
+const float SolarMass = 4.0f * Pi * Pi;
+const float DaysPerYear = 365.24f;
+
+struct Body {
+    float x, y, z, vx, vy, vz, mass;
+};
+
+Body makeBody(float x, float y, float z, float vx, float vy, float vz, float mass) {
+    return Body{x, y, z, vx * DaysPerYear, vy * DaysPerYear, vz * DaysPerYear, mass * SolarMass};
+}
+
+std::vector<Body> createBodies() {
+    std::vector<Body> bodies;
+    //The sun.
+    bodies.push_back(makeBody(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+    //Jupiter.
+    bodies.push_back(makeBody(
+        4.84143144f, -1.16032004f, -0.103622044f,
+        0.00166007664f, 0.00769901118f, -0.0000690460016f,
+        0.000954791938f));
+    //Saturn.
+    bodies.push_back(makeBody(
+        8.34336671f, 4.12479856f, -0.403523417f,
+        -0.00276742510f, 0.00499852801f, 0.0000230417297f,
+        0.000285885980f));
+    //Uranus.
+    bodies.push_back(makeBody(
+        12.8943695f, -15.1111514f, -0.223307578f,
+        0.00296460137f, 0.00237847173f, -0.0000296589568f,
+        0.0000436624404f));
+    //Neptune.
+    bodies.push_back(makeBody(
+        15.3796971f, -25.9193146f, 0.179258772f,
+        0.00268067772f, 0.00162824170f, -0.0000951592254f,
+        0.0000515138902f));
+
+    float px = 0.0f;
+    float py = 0.0f;
+    float pz = 0.0f;
+    for(const Body &body : bodies) {
+        px = px + body.vx * body.mass;
+        py = py + body.vy * body.mass;
+        pz = pz + body.vz * body.mass;
+    }
+    bodies[0].vx = 0.0f - px / SolarMass;
+    bodies[0].vy = 0.0f - py / SolarMass;
+    bodies[0].vz = 0.0f - pz / SolarMass;
+    return bodies;
+}
+
+void advance(std::vector<Body> &bodies, float dt) {
+    int n = (int)bodies.size();
+    for(int i = 0; i < n; ++i) {
+        Body &a = bodies[i];
+        for(int j = i + 1; j < n; ++j) {
+            Body &b = bodies[j];
+            float dx = a.x - b.x;
+            float dy = a.y - b.y;
+            float dz = a.z - b.z;
+            float distanceSquared = dx * dx + dy * dy + dz * dz;
+            float magnitude = dt / (distanceSquared * std::sqrt(distanceSquared));
+            a.vx = a.vx - dx * b.mass * magnitude;
+            a.vy = a.vy - dy * b.mass * magnitude;
+            a.vz = a.vz - dz * b.mass * magnitude;
+            b.vx = b.vx + dx * a.mass * magnitude;
+            b.vy = b.vy + dy * a.mass * magnitude;
+            b.vz = b.vz + dz * a.mass * magnitude;
+        }
+    }
+    for(Body &body : bodies) {
+        body.x = body.x + dt * body.vx;
+        body.y = body.y + dt * body.vy;
+        body.z = body.z + dt * body.vz;
+    }
+}
+
+float energy(const std::vector<Body> &bodies) {
+    int n = (int)bodies.size();
+    float e = 0.0f;
+    for(int i = 0; i < n; ++i) {
+        const Body &a = bodies[i];
+        e = e + 0.5f * a.mass * (a.vx * a.vx + a.vy * a.vy + a.vz * a.vz);
+        for(int j = i + 1; j < n; ++j) {
+            const Body &b = bodies[j];
+            float dx = a.x - b.x;
+            float dy = a.y - b.y;
+            float dz = a.z - b.z;
+            e = e - a.mass * b.mass / std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+    return e;
+}
+
+}
+
+int main() {
+    return reference::run("nbody", [] {
+        std::vector<Body> bodies = createBodies();
+        for(int i = 0; i < 500000; ++i) advance(bodies, 0.01f);
+        return energy(bodies);
+    }, -0.1690941f, 0.00001f);
+}
@@ -0,0 +1,75 @@
+#include "reference.h"
+
+#include <vector>
+
+namespace {
+
+const int EdgeCount = 4;
+
+struct GraphNode {
+    int value = 0;
+    int depth = 0;
+    int visitedBy = 0;
+    std::vector<GraphNode*> edges;
+};
+
+int mod(int a, int b) {
+    return a - a / b * b;
+}
+
+/** The sum of the depth of each node reachable from the first times its value. */
+int traverse(std::vector<GraphNode*> &nodes, std::vector<GraphNode*> &queue, int traversal) {
+    int head = 0;
+    int tail = 1;
+    queue[0] = nodes[0];
+    nodes[0]->visitedBy = traversal;
+    nodes[0]->depth = 0;
+    int sum = 0;
+    while(head < tail) {
+        GraphNode *node = queue[head];
+        head = head + 1;
+        sum = sum + node->depth * node->value;
+        for(int i = 0; i < EdgeCount; ++i) {
+            GraphNode *next = node->edges[i];
+            if(next->visitedBy != traversal) {
+                next->visitedBy = traversal;
+                next->depth = node->depth + 1;
+                queue[tail] = next;
+                tail = tail + 1;
+            }
+        }
+    }
+    return sum;
+}
+
+int objectGraph(int nodeCount, int traversals) {
+    std::vector<GraphNode*> nodes(nodeCount);
+    for(int i = 0; i < nodeCount; ++i) {
+        nodes[i] = new GraphNode();
+        nodes[i]->value = mod(i * 7, 100);
+        nodes[i]->edges.resize(EdgeCount);
+    }
+    //A ring with pseudo-random chords.
+    int state = 1;
+    for(int i = 0; i < nodeCount; ++i) {
+        nodes[i]->edges[0] = nodes[mod(i + 1, nodeCount)];
+        for(int e = 1; e < EdgeCount; ++e) {
+            state = mod(state * 1103 + 12345, 65536);
+            nodes[i]->edges[e] = nodes[mod(state, nodeCount)];
+        }
+    }
+
+    std::vector<GraphNode*> queue(nodeCount);
+    int checksum = 0;
+    for(int traversal = 1; traversal <= traversals; ++traversal) {
+        checksum = checksum + traverse(nodes, queue, traversal);
+    }
+    for(GraphNode *node : nodes) delete node;
+    return checksum;
+}
+
+}
+
+int main() {
+    return reference::run("object_graph", [] { return objectGraph(50000, 50); }, 1332387000);
+}
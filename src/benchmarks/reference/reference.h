@@ -0,0 +1,31 @@
+/**
+ * Runs the kernel of a reference implementation of one of the benchmarks in the parent directory.
+ *
+ * The kernel is timed and its result compared to the checksum which the Anode implementation asserts.  The elapsed
+ * milliseconds are written to stdout, which is how anode_bench reads them, and the exit code is non-zero if the result
+ * is wrong.  Process start up is not included so the comparison with Anode's execution phase is fair.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace reference {
+
+template<typename Kernel, typename Result>
+int run(const char *name, Kernel kernel, Result expected, Result tolerance = Result()) {
+    auto start = std::chrono::steady_clock::now();
+    Result result = kernel();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if(std::abs(result - expected) > tolerance) {
+        std::fprintf(stderr, "%s: expected %.9g but found %.9g\n", name, (double)expected, (double)result);
+        return 1;
+    }
+    std::printf("%.6f\n", std::chrono::duration<double, std::milli>(elapsed).count());
+    return 0;
+}
+
+}
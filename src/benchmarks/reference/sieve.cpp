@@ -0,0 +1,26 @@
+#include "reference.h"
+
+#include <vector>
+
+static int countPrimes(int n) {
+    //Not std::vector<bool>, whose elements are bits, because Anode's bool[] stores a byte per element.
+    std::vector<char> composite(n);
+    int count = 0;
+    for(int i = 2; i < n; ++i) {
+        if(!composite[i]) {
+            count = count + 1;
+            for(int j = i * 2; j < n; j += i) {
+                composite[j] = true;
+            }
+        }
+    }
+    return count;
+}
+
+int main() {
+    return reference::run("sieve", [] {
+        int total = 0;
+        for(int i = 0; i < 10; ++i) total += countPrimes(2000000);
+        return total;
+    }, 1489330);
+}
@@ -2,6 +2,13 @@
 #pragma once
 
 #include "llvm.h"
+#include "back/compile.h"
+#include "common/stats.h"
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace anode {
     namespace execute {
@@ -44,6 +51,73 @@ namespace anode {
             return std::make_unique<LR>(DylibLookupFtor, ExternalLookupFtor);
         }
 
+        /**
+         * Keeps a copy of the machine code generated for the modules named by captureObject(...) so that it can be cached,
+         * i.e. in a module interface.  Cached machine code is loaded with AnodeJit::addObject(...) rather than through
+         * getObject(...), which avoids the need to read the bitcode it was compiled from.
+         */
+        class ObjectCaptureCache : public llvm::ObjectCache {
+            std::unordered_set<std::string> capturing_;
+            std::unordered_map<std::string, std::string> captured_;
+        public:
+            void captureObject(const std::string &moduleIdentifier) {
+                capturing_.insert(moduleIdentifier);
+            }
+
+            /** Returns an empty string if the object was not captured. */
+            std::string takeCapturedObject(const std::string &moduleIdentifier) {
+                capturing_.erase(moduleIdentifier);
+                auto found = captured_.find(moduleIdentifier);
+                if(found == captured_.end()) {
+                    return std::string();
+                }
+                std::string object = std::move(found->second);
+                captured_.erase(found);
+                return object;
+            }
+
+            void notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef object) override {
+                if(capturing_.count(module->getModuleIdentifier())) {
+                    captured_[module->getModuleIdentifier()] = object.getBuffer().str();
+                }
+            }
+
+            std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override {
+                return nullptr;
+            }
+        };
+
+        /** Wraps llvm::orc::SimpleCompiler to measure the time spent generating machine code and its size, for --stats. */
+        class TimedCompiler {
+            llvm::orc::SimpleCompiler compiler_;
+        public:
+            TimedCompiler(llvm::TargetMachine &targetMachine, llvm::ObjectCache *objectCache)
+                : compiler_{targetMachine, objectCache} { }
+
+            llvm::object::OwningBinary<llvm::object::ObjectFile> operator()(llvm::Module &module) {
+                stats::Statistics &statistics = stats::global();
+                if(!statistics.enabled()) {
+                    return compiler_(module);
+                }
+
+                stats::CounterValues countersBefore = statistics.readCounters();
+                auto start = stats::clock::now();
+                llvm::object::OwningBinary<llvm::object::ObjectFile> object = compiler_(module);
+                statistics.addTiming("back.codegen", stats::clock::now() - start, statistics.readCounters() - countersBefore);
+
+                if(object.getBinary()) {
+                    unsigned long textBytes = 0;
+                    for(const llvm::object::SectionRef &section : object.getBinary()->sections()) {
+                        if(section.isText()) {
+                            textBytes += section.getSize();
+                        }
+                    }
+                    statistics.addModuleStatistic(module.getModuleIdentifier(), "machineCodeBytes", textBytes);
+                }
+                return object;
+            }
+        };
+
         /** This class originally taken from:
          * https://github.com/llvm-mirror/llvm/tree/master/examples/Kaleidoscope/BuildingAJIT/Chapter4
          * http://llvm.org/docs/tutorial/BuildingAJIT4.html
@@ -53,7 +127,8 @@ namespace anode {
             llvm::orc::RTDyldObjectLinkingLayer ObjectLayer;
             std::unique_ptr<llvm::TargetMachine> TM;
             const llvm::DataLayout DL;
-            llvm::orc::IRCompileLayer<decltype(ObjectLayer), llvm::orc::SimpleCompiler> CompileLayer;
+            ObjectCaptureCache ObjectCache;
+            llvm::orc::IRCompileLayer<decltype(ObjectLayer), TimedCompiler> CompileLayer;
 
             using OptimizeFunction = std::function<std::shared_ptr<llvm::Module>(std::shared_ptr<llvm::Module>)>;
             llvm::orc::IRTransformLayer<decltype(CompileLayer), OptimizeFunction> OptimizeLayer;
@@ -62,15 +137,50 @@ namespace anode {
             std::unique_ptr<llvm::orc::IndirectStubsManager> IndirectStubsMgr;
 
             std::unordered_map<std::string, runtime::symbolptr_t> exports_;
-            bool enableOptimization_ = true;
+            unsigned optimizationLevel_ = 2;
+
+            struct FunctionRange {
+                uint64_t end;
+                std::string name;
+            };
+            bool profiling_ = false;
+            std::mutex functionsMutex_;
+            //The functions of every object loaded since profiling was enabled, by their start address.
+            std::map<uint64_t, FunctionRange> functions_;
+
+            /** Records the address range of each function of an object which has been loaded, see functionAt(...). */
+            void recordFunctions(const llvm::object::ObjectFile &object, const llvm::RuntimeDyld::LoadedObjectInfo &info) {
+                if(!profiling_) return;
+                //The symbols of the copy returned by getObjectForDebug(...) have the addresses they were loaded at.
+                llvm::object::OwningBinary<llvm::object::ObjectFile> loaded = info.getObjectForDebug(object);
+                const llvm::object::ObjectFile &symbolSource = loaded.getBinary() ? *loaded.getBinary() : object;
+
+                std::lock_guard<std::mutex> lock{functionsMutex_};
+                for(const auto &symbolAndSize : llvm::object::computeSymbolSizes(symbolSource)) {
+                    const llvm::object::SymbolRef &symbol = symbolAndSize.first;
+                    auto type = symbol.getType();
+                    auto name = symbol.getName();
+                    auto address = symbol.getAddress();
+                    if(type && *type == llvm::object::SymbolRef::ST_Function && name && address && symbolAndSize.second > 0) {
+                        functions_[*address] = FunctionRange{*address + symbolAndSize.second, name->str()};
+                    }
+                    llvm::consumeError(type.takeError());
+                    llvm::consumeError(name.takeError());
+                    llvm::consumeError(address.takeError());
+                }
+            }
+
         public:
             using ModuleHandle = decltype(OptimizeLayer)::ModuleHandleT;
 
             AnodeJit()
-                : ObjectLayer([]() { return std::make_shared<AnodeeSectionMemoryManager>(); }),
+                : ObjectLayer([]() { return std::make_shared<AnodeeSectionMemoryManager>(); },
+                              [this](auto, const auto &object, const llvm::RuntimeDyld::LoadedObjectInfo &info) {
+                                  recordFunctions(*object->getBinary(), info);
+                              }),
                   TM(llvm::EngineBuilder().selectTarget()),
                   DL(TM->createDataLayout()),
-                  CompileLayer(ObjectLayer, llvm::orc::SimpleCompiler(*TM)),
+                  CompileLayer(ObjectLayer, TimedCompiler(*TM, &ObjectCache)),
                   OptimizeLayer(CompileLayer,
                                 [this](std::shared_ptr<llvm::Module> M) {
                                     return optimizeModule(std::move(M));
@@ -94,12 +204,15 @@ namespace anode {
 
             llvm::TargetMachine *getTargetMachine() { return TM.get(); }
 
-            ModuleHandle addModule(std::shared_ptr<llvm::Module> M) {
+            ObjectCaptureCache &objectCache() { return ObjectCache; }
+
+            //Defined before its first use since its return type is deduced.
+            auto createResolver() {
                 // Build our symbol resolver:
                 // Lambda 1: Look back into the JIT itself to find symbols that are part of
                 //           the same "logical dylib".
                 // Lambda 2: Search for external symbols in the host process.
-                auto Resolver = createLambdaResolver2(
+                return createLambdaResolver2(
                     [&](const std::string &Name) {
                         if (auto Sym = IndirectStubsMgr->findStub(Name, false))
                             return Sym;
@@ -118,6 +231,26 @@ namespace anode {
                             return llvm::JITSymbol(SymAddr, llvm::JITSymbolFlags::Exported);
                         return llvm::JITSymbol(nullptr);
                     });
+            }
+
+            /** Adds previously generated machine code for this target, see ObjectCaptureCache. */
+            llvm::Error addObject(std::unique_ptr<llvm::MemoryBuffer> buffer) {
+                auto objectFile = llvm::object::ObjectFile::createObjectFile(buffer->getMemBufferRef());
+                if(!objectFile) {
+                    return objectFile.takeError();
+                }
+                auto object = std::make_shared<llvm::object::OwningBinary<llvm::object::ObjectFile>>(
+                    std::move(*objectFile), std::move(buffer));
+
+                auto handle = ObjectLayer.addObject(std::move(object), createResolver());
+                if(!handle) {
+                    return handle.takeError();
+                }
+                return llvm::Error::success();
+            }
+
+            ModuleHandle addModule(std::shared_ptr<llvm::Module> M) {
+                auto Resolver = createResolver();
 
                 // Add the set to the JIT with the resolver we created above and a newly
                 // created SectionMemoryManager.
@@ -191,8 +324,37 @@ namespace anode {
                 cantFail(OptimizeLayer.removeModule(H));
             }
 
-            void setEnableOptimization(bool enableOptimization) {
-                enableOptimization_ = enableOptimization;
+            /**
+             * 0 disables the optimization passes (see optimizeModule(...)), any other level enables them.  The level is
+             * also that of the code generator, where 3 is the most aggressive.  Applies to modules added from now on.
+             */
+            void setOptimizationLevel(unsigned level) {
+                optimizationLevel_ = level;
+                switch(level) {
+                    case 0: TM->setOptLevel(llvm::CodeGenOpt::None); break;
+                    case 1: TM->setOptLevel(llvm::CodeGenOpt::Less); break;
+                    case 2: TM->setOptLevel(llvm::CodeGenOpt::Default); break;
+                    default: TM->setOptLevel(llvm::CodeGenOpt::Aggressive); break;
+                }
+            }
+
+            unsigned optimizationLevel() const { return optimizationLevel_; }
+
+            /**
+             * Makes the code of modules added from now on keep its frame pointers, so that the profiler can walk its
+             * stack, and records the address of each function so that functionAt(...) can find it.
+             */
+            void enableProfiling() { profiling_ = true; }
+
+            /** The name of the JITd function containing address, or an empty string if there is none. */
+            std::string functionAt(uint64_t address) {
+                std::lock_guard<std::mutex> lock{functionsMutex_};
+                auto found = functions_.upper_bound(address);
+                if(found == functions_.begin()) {
+                    return std::string();
+                }
+                --found;
+                return address < found->second.end ? found->second.name : std::string();
             }
 
         private:
@@ -204,23 +366,61 @@ namespace anode {
             }
 
             std::shared_ptr<llvm::Module> optimizeModule(std::shared_ptr<llvm::Module> M) {
+                if(profiling_) {
+                    for(llvm::Function &function : *M) {
+                        if(!function.isDeclaration()) {
+                            function.addFnAttr("no-frame-pointer-elim", "true");
+                        }
+                    }
+                }
 
-                if(!enableOptimization_) return M;
+                if(optimizationLevel_ == 0) return M;
 
-                // Create a function pass manager.
-                auto FPM = llvm::make_unique<llvm::legacy::FunctionPassManager>(M.get());
+                //Allocas are promoted to registers first so that the loop passes can find induction variables and
+                //reductions.  Loops are rotated (while loops have their condition at the top) before they are
+                //vectorized and unrolled according to their llvm.loop metadata and to the cost model of the target.
+                typedef llvm::Pass *(*PassFactory)();
+                static const std::pair<const char *, PassFactory> passes[] = {
+                    { "SROA", []() -> llvm::Pass * { return llvm::createSROAPass(); } },
+                    { "InstructionCombining", []() -> llvm::Pass * { return llvm::createInstructionCombiningPass(); } },
+                    { "Reassociate", []() -> llvm::Pass * { return llvm::createReassociatePass(); } },
+                    { "GVN", []() -> llvm::Pass * { return llvm::createGVNPass(); } },
+                    { "CFGSimplification", []() -> llvm::Pass * { return llvm::createCFGSimplificationPass(); } },
+                    { "LoopRotate", []() -> llvm::Pass * { return llvm::createLoopRotatePass(); } },
+                    { "LICM", []() -> llvm::Pass * { return llvm::createLICMPass(); } },
+                    { "LoopVectorize", []() -> llvm::Pass * { return llvm::createLoopVectorizePass(); } },
+                    { "LoopUnroll", []() -> llvm::Pass * { return llvm::createLoopUnrollPass(); } },
+                    { "LateInstructionCombining", []() -> llvm::Pass * { return llvm::createInstructionCombiningPass(); } }
+                };
 
-                // Add some optimizations.
-                FPM->add(llvm::createInstructionCombiningPass());
-                FPM->add(llvm::createReassociatePass());
-                FPM->add(llvm::createGVNPass());
-                FPM->add(llvm::createCFGSimplificationPass());
-                FPM->doInitialization();
+                //Both paths below run the passes through this, so that they are initialized and finalized the same way.
+                auto runPasses = [&](const std::pair<const char *, PassFactory> *begin,
+                                     const std::pair<const char *, PassFactory> *end) {
+                    auto FPM = llvm::make_unique<llvm::legacy::FunctionPassManager>(M.get());
+                    FPM->add(llvm::createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
+                    for(auto pass = begin; pass != end; ++pass) {
+                        FPM->add(pass->second());
+                    }
+                    FPM->doInitialization();
+                    for (auto &F : *M)
+                        FPM->run(F);
+                    FPM->doFinalization();
+                };
 
-                // Run the optimizations over all functions in the module being added to
-                // the JIT.
-                for (auto &F : *M)
-                    FPM->run(F);
+                stats::Statistics &statistics = stats::global();
+                if(!statistics.enabled()) {
+                    runPasses(std::begin(passes), std::end(passes));
+                    return M;
+                }
+
+                //When collecting statistics each pass is run over all functions by itself so that it can be timed.
+                //Every pass, including the loop passes, operates on one function (or one loop within it) at a time
+                //and never looks at other functions, so the result is the same as running them all per function.
+                for(auto &pass : passes) {
+                    stats::PhaseTimer timer{std::string("back.opt.") + pass.first};
+                    runPasses(&pass, &pass + 1);
+                }
+                statistics.addModuleStatistic(M->getModuleIdentifier(), "irInstructionsOptimized", back::countInstructions(*M));
                 return M;
             }
         }; //SimpleJIT
@@ -2,7 +2,29 @@
 #include "back/compile.h"
 #include "front/ast_passes.h"
 #include "front/visualize.h"
+#include "front/parse.h"
+#include "front/module_interface.h"
+#include "common/mapped_file.h"
+#include "common/content_hash.h"
 #include "runtime/builtins.h"
+#include "runtime/tasks.h"
+#include "runtime/profiler.h"
+#include "runtime/instrumentation.h"
+
+#include <algorithm>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
 
 #include "AnodeJit.h"
 namespace anode { namespace execute {
@@ -15,10 +37,30 @@ extern "C" void receiveReplResult(uint64_t ecPtr, type::PrimitiveType primitiveT
 
 AnodeJit *Jit;
 
+/** Set by startProfiler(...), which may be invoked before the JIT is initialized. */
+bool ProfileJitCode = false;
+
+/** Set by setInstrumentationEnabled(...) and useInstrumentationProfile(...), applies to every ExecutionContext. */
+bool InstrumentModules = false;
+bool UseInstrumentationProfile = false;
+back::ProfileCounts InstrumentationProfile;
+/** Identifies the profile in the keys of cached modules, which were optimized according to it. */
+uint64_t InstrumentationProfileHash = 0;
+
+back::ProfileOptions profileOptions() {
+    back::ProfileOptions options;
+    options.instrument = InstrumentModules;
+    options.counts = UseInstrumentationProfile ? &InstrumentationProfile : nullptr;
+    return options;
+}
+
 void InitializeJit() {
     if(!Jit) {
         Jit = new AnodeJit();
-        Jit->setEnableOptimization(false);
+        Jit->setOptimizationLevel(0);
+        if(ProfileJitCode) {
+            Jit->enableProfiling();
+        }
         Jit->putExport(back::RECEIVE_RESULT_FUNC_NAME, reinterpret_cast<runtime::symbolptr_t>(receiveReplResult));
 
         auto builtins = anode::runtime::getBuiltins();
@@ -37,14 +79,406 @@ class ExecutionContextImpl : public ExecutionContext {
     llvm::LLVMContext context_;
     bool dumpIROnModuleLoad_ = false;
     bool setPrettyPrintAst_ = false;
+    ast::FloatingPointMode floatingPointMode_ = ast::FloatingPointMode::Precise;
     ast::AnodeWorld world_;
     ResultCallbackFunctor resultFunctor_ = nullptr;
     back::TypeMap typeMap_;
+    /** A node of the graph of imported libraries, the edges of which are recorded by their interfaces. */
+    struct ImportedLibrary {
+        /** False while the library's own imports are being loaded, which is how circular imports are detected. */
+        bool loaded = false;
+        uint64_t interfaceHash = 0;
+    };
+    /** Keyed by the canonical paths of the libraries' sources, so that each is loaded only once. */
+    std::unordered_map<std::string, ImportedLibrary> importedLibraries_;
+    /** Where analyzed and compiled modules are cached, or empty if caching is disabled. */
+    std::string moduleCacheDirectory_;
+
+    /** Resolves "some::library" imported by the module named importerName to "<importer's directory>/some/library.an". */
+    static std::string importSourcePath(const std::string &importerName, const std::string &qualifiedName) {
+        std::string path;
+        size_t lastSlash = importerName.rfind('/');
+        if(lastSlash != std::string::npos) {
+            path = importerName.substr(0, lastSlash + 1);
+        }
+        size_t partStart = 0;
+        size_t separator;
+        while((separator = qualifiedName.find("::", partStart)) != std::string::npos) {
+            path += qualifiedName.substr(partStart, separator - partStart) + "/";
+            partStart = separator + 2;
+        }
+        return path + qualifiedName.substr(partStart) + ".an";
+    }
+
+    void runModuleInitializer(uint64_t initFuncPtr) {
+        if(initFuncPtr) {
+            //The initializer delivers the results of module-level expressions to the current ExecutionContext.
+            runtime::ExecutionContextScope scope{this};
+            void (*initFunc)() = reinterpret_cast<void (*)()>(initFuncPtr);
+            stats::PhaseTimer timer{"execute.initModule"};
+            initFunc();
+        }
+    }
+
+    /**
+     * Loads every module imported by module and records their interface hashes in it, for compileModule(...).  Returns
+     * true if there were errors.
+     */
+    bool importModules(ast::Module &module, error::ErrorStream &errorStream) {
+        std::vector<uint64_t> interfaceHashes;
+        for(const ast::MultiPartIdentifier &import : module.imports()) {
+            uint64_t interfaceHash;
+            if(importModule(module.name(), import.qualifedName(), import.span(), errorStream, interfaceHash)) {
+                return true;
+            }
+            interfaceHashes.push_back(interfaceHash);
+        }
+        module.setImportInterfaceHashes(interfaceHashes);
+        return false;
+    }
+
+    /**
+     * Loads a library and sets interfaceHash to the hash of its interface.  Returns true if there were errors.
+     *
+     * The library's imports are loaded first.  The library is then loaded from its interface if its source is unchanged
+     * and the interfaces of its imports are the same as when it was compiled, otherwise it is compiled from source and its
+     * interface is written again.  Thus a change to a library only causes the libraries which import it to be compiled
+     * again if the change affected its interface.
+     *
+     * A library may also be distributed as only an interface, without its source.
+     */
+    bool importModule(
+        const std::string &importerName,
+        const std::string &qualifiedName,
+        const source::SourceSpan &span,
+        error::ErrorStream &errorStream,
+        uint64_t &interfaceHash
+    ) {
+        std::string sourcePath = importSourcePath(importerName, qualifiedName);
+        bool precompiled = false;
+        char canonicalPath[PATH_MAX];
+        if(::realpath(sourcePath.c_str(), canonicalPath)) {
+            //The canonical path is also the library's module name, which ensures it is the same regardless of the importer.
+            sourcePath = canonicalPath;
+        } else if(::realpath(interfacePathOf(sourcePath).c_str(), canonicalPath)) {
+            std::string interfacePath{canonicalPath};
+            sourcePath = interfacePath.substr(0, interfacePath.size() - interface::InterfaceFileExtension.size()) + ".an";
+            precompiled = true;
+        } else {
+            errorStream.error(
+                error::ErrorKind::ImportedModuleNotFound, span, "Imported module '%s' not found (expected %s)",
+                qualifiedName.c_str(), sourcePath.c_str());
+            return true;
+        }
+
+        auto found = importedLibraries_.find(sourcePath);
+        if(found != importedLibraries_.end()) {
+            if(!found->second.loaded) {
+                errorStream.error(
+                    error::ErrorKind::CircularImport, span, "Module '%s' imports itself, directly or indirectly",
+                    qualifiedName.c_str());
+                return true;
+            }
+            interfaceHash = found->second.interfaceHash;
+            return false;
+        }
+        importedLibraries_.emplace(sourcePath, ImportedLibrary());
+
+        int errorsBefore = errorStream.errorCount();
+        std::string interfacePath = interfacePathOf(sourcePath);
+
+        bool failed;
+        bool reused = false;
+        try {
+            if(precompiled) {
+                failed = loadInterfaceIfCurrent(interfacePath, sourcePath, nullptr, span, errorStream, interfaceHash, reused);
+                if(!failed && !reused) {
+                    errorStream.error(
+                        error::ErrorKind::ImportedModuleFailed, span,
+                        "The interfaces imported by '%s' or the options it must be compiled with have changed since it was "
+                        "compiled and its source is not available",
+                        qualifiedName.c_str());
+                    failed = true;
+                }
+            } else {
+                std::string sourceText = readFile(sourcePath);
+                uint64_t sourceHash = contentHash(sourceText);
+                //An interface's code is neither instrumented nor optimized according to a profile.
+                failed = !InstrumentModules && !UseInstrumentationProfile
+                         && loadInterfaceIfCurrent(
+                             interfacePath, sourcePath, &sourceHash, span, errorStream, interfaceHash, reused);
+                if(!failed && !reused) {
+                    failed = compileLibrary(sourcePath, sourceText, sourceHash, interfacePath, span, errorStream, interfaceHash);
+                }
+            }
+        } catch(ParseAbortedException &) {
+            failed = true;
+        } catch(exception::Exception &e) {
+            errorStream.error(
+                error::ErrorKind::ImportedModuleFailed, span, "Couldn't load %s: %s", sourcePath.c_str(), e.what());
+            failed = true;
+        }
+
+        //Errors within the library itself were reported elsewhere, this reports where it was imported from.
+        if(failed && errorStream.errorCount() == errorsBefore) {
+            errorStream.error(
+                error::ErrorKind::ImportedModuleFailed, span, "Imported module '%s' failed to load", qualifiedName.c_str());
+        }
+        if(!failed) {
+            ImportedLibrary &library = importedLibraries_[sourcePath];
+            library.loaded = true;
+            library.interfaceHash = interfaceHash;
+            stats::global().increment(reused ? "execute.librariesReused" : "execute.librariesCompiled");
+        }
+        return failed;
+    }
+
+    /**
+     * Sets reused to true and loads the module from its interface if the interface exists and is current, i.e. it was
+     * compiled from the source identified by sourceHash (if not null) by this build of the compiler, in the current
+     * floating point mode and at the current optimization level, and the interfaces of its imports haven't changed.
+     * The imports recorded in the interface, which are resolved relative to importerName, are loaded regardless.  Returns
+     * true if there were errors.
+     */
+    bool loadInterfaceIfCurrent(
+        const std::string &interfacePath,
+        const std::string &importerName,
+        const uint64_t *sourceHash,
+        const source::SourceSpan &span,
+        error::ErrorStream &errorStream,
+        uint64_t &interfaceHash,
+        bool &reused
+    ) {
+        std::unique_ptr<MappedFile> file;
+        std::unique_ptr<interface::ModuleInterfaceReader> reader;
+        try {
+            file = std::make_unique<MappedFile>(interfacePath);
+            reader = std::make_unique<interface::ModuleInterfaceReader>(file->data(), file->size());
+        } catch(exception::Exception &) {
+            //Missing, or written by another version of the compiler.
+            return false;
+        }
+        if(sourceHash && reader->sourceHash() != *sourceHash) {
+            return false;
+        }
+        if(reader->compilerIdentity() != compilerIdentity() || reader->floatingPointMode() != floatingPointMode_
+           || reader->optimizationLevel() != Jit->optimizationLevel()) {
+            return false;
+        }
+
+        bool importsUnchanged = true;
+        for(const interface::InterfaceImport &import : reader->imports()) {
+            uint64_t importInterfaceHash;
+            if(importModule(importerName, import.qualifiedName, span, errorStream, importInterfaceHash)) {
+                return true;
+            }
+            importsUnchanged = importsUnchanged && importInterfaceHash == import.interfaceHash;
+        }
+        if(!importsUnchanged) {
+            return false;
+        }
+
+        reader->importSymbols(world_);
+
+        //Templates are expanded by each importer so they are analyzed again from their source.
+        for(size_t i = 0; i < reader->templateSources().size(); ++i) {
+            ast::Module &templates = parseModule(
+                reader->templateSources()[i], reader->moduleName() + "$templates" + std::to_string(i));
+            if(prepareModule(&templates)) {
+                return true;
+            }
+            executeModule(&templates);
+        }
+
+        uint64_t initFuncPtr;
+        if(reader->objectSize() > 0 && reader->objectTriple() == Jit->getTargetMachine()->getTargetTriple().str()) {
+            llvm::Error error = Jit->addObject(llvm::MemoryBuffer::getMemBufferCopy(
+                llvm::StringRef(reader->object(), reader->objectSize()), reader->moduleName()));
+            if(error) {
+                throw exception::Exception("couldn't load its machine code: " + llvm::toString(std::move(error)));
+            }
+            initFuncPtr = findModuleInitializer(reader->moduleName());
+        } else {
+            auto llvmModule = llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(llvm::StringRef(reader->code(), reader->codeSize()), reader->moduleName()), context_);
+            if(!llvmModule) {
+                throw exception::Exception("couldn't read its code: " + llvm::toString(llvmModule.takeError()));
+            }
+            initFuncPtr = addModuleToJit(std::move(*llvmModule), reader->moduleName());
+        }
+
+        interfaceHash = reader->interfaceHash();
+        reused = true;
+        runModuleInitializer(initFuncPtr);
+        return false;
+    }
+
+    bool compileLibrary(
+        const std::string &sourcePath,
+        const std::string &sourceText,
+        uint64_t sourceHash,
+        const std::string &interfacePath,
+        const source::SourceSpan &span,
+        error::ErrorStream &errorStream,
+        uint64_t &interfaceHash
+    ) {
+        std::istringstream input{sourceText};
+        ast::Module *library = &parseModule(input, sourcePath, errorStream);
+
+        if(prepareModule(library)) {
+            return true;
+        }
+
+        //Nor is the interface written when the code is, since the next importer might not want that.
+        if(InstrumentModules || UseInstrumentationProfile) {
+            interfaceHash = sourceHash;
+            runModuleInitializer(addModuleToJit(emitModule(library), library->name()));
+            return false;
+        }
+
+        std::string notWrittenReason;
+        uint64_t initFuncPtr;
+        if(interface::exportsAllSymbols(*library)) {
+            initFuncPtr = compileModule(*library, sourceText, sourceHash, interfacePath, interfaceHash, notWrittenReason);
+        } else {
+            //Otherwise importers could use the symbols it doesn't export only until it is loaded from its interface.
+            initFuncPtr = addModuleToJit(emitModule(library), library->name());
+            notWrittenReason = "the library defines symbols which an interface cannot express";
+        }
+        if(!notWrittenReason.empty()) {
+            //Not fatal, the library will just be compiled again the next time it is imported.  Any change to the
+            //source must be assumed to change the interface.
+            errorStream.warning(span, "Interface not written: %s", notWrittenReason.c_str());
+            interfaceHash = sourceHash;
+        }
+
+        runModuleInitializer(initFuncPtr);
+        return false;
+    }
+
+    /**
+     * JIT compiles a module which has been prepared and writes its interface.  Returns the address of the module's
+     * initialization function.  If the interface could not be written notWrittenReason is set to the reason why.
+     */
+    uint64_t compileModule(
+        ast::Module &module,
+        const std::string &sourceText,
+        uint64_t sourceHash,
+        const std::string &interfacePath,
+        uint64_t &interfaceHash,
+        std::string &notWrittenReason
+    ) {
+        interface::CompiledModule compiled;
+        compiled.sourceText = sourceText;
+        compiled.sourceHash = sourceHash;
+        compiled.compilerIdentity = compilerIdentity();
+        compiled.floatingPointMode = floatingPointMode_;
+        compiled.optimizationLevel = Jit->optimizationLevel();
+        //Recorded when the imports were loaded by prepareModule(...).
+        ASSERT(module.importInterfaceHashes().size() == module.imports().size());
+        compiled.importInterfaceHashes = module.importInterfaceHashes();
+
+        std::unique_ptr<llvm::Module> llvmModule = emitModule(&module);
+        llvm::raw_string_ostream codeStream{compiled.code};
+        llvm::WriteBitcodeToFile(llvmModule.get(), codeStream);
+        codeStream.flush();
+
+        Jit->objectCache().captureObject(module.name());
+        uint64_t initFuncPtr = addModuleToJit(std::move(llvmModule), module.name());
+        compiled.object = Jit->objectCache().takeCapturedObject(module.name());
+        compiled.objectTriple = Jit->getTargetMachine()->getTargetTriple().str();
+
+        //The interface is written to a temporary file first so that a partially written interface is never read.
+        std::string temporaryPath = interfacePath + ".tmp";
+        try {
+            std::ofstream interfaceFile{temporaryPath, std::ios::binary | std::ios::trunc};
+            interfaceHash = interface::writeModuleInterface(module, compiled, interfaceFile);
+            interfaceFile.close();
+            if(!interfaceFile || std::rename(temporaryPath.c_str(), interfacePath.c_str()) != 0) {
+                throw exception::Exception("couldn't write " + interfacePath);
+            }
+        } catch(exception::Exception &e) {
+            std::remove(temporaryPath.c_str());
+            notWrittenReason = e.what();
+        }
+        return initFuncPtr;
+    }
+
+    static std::string interfacePathOf(const std::string &sourcePath) {
+        std::string basePath = sourcePath;
+        if(basePath.size() > 3 && basePath.compare(basePath.size() - 3, 3, ".an") == 0) {
+            basePath.resize(basePath.size() - 3);
+        }
+        return basePath + interface::InterfaceFileExtension;
+    }
+
+    static std::string readFile(const std::string &filename) {
+        std::ifstream file{filename};
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    /**
+     * Identifies this build of the compiler, so that modules cached by one build are never loaded by another which may
+     * have analyzed or compiled them differently.
+     */
+    static uint64_t compilerIdentity() {
+        static uint64_t identity = [] {
+            ContentHasher hasher;
+            hasher.add((uint64_t)interface::InterfaceVersion);
+            struct stat executableStat{};
+            if(::stat("/proc/self/exe", &executableStat) == 0) {
+                hasher.add((uint64_t)executableStat.st_size);
+                hasher.add((uint64_t)executableStat.st_mtime);
+            }
+            return hasher.hash();
+        }();
+        return identity;
+    }
+
+    std::string cachedModulePath(uint64_t cacheKey) {
+        ContentHasher hasher;
+        hasher.add(cacheKey);
+        hasher.add(compilerIdentity());
+        //Modules compiled in different floating point modes are not interchangeable.
+        hasher.add((uint64_t)floatingPointMode_);
+        //Nor are those optimized differently, instrumented or optimized according to a profile.
+        hasher.add((uint64_t)Jit->optimizationLevel());
+        hasher.add((uint64_t)InstrumentModules);
+        hasher.add(UseInstrumentationProfile ? InstrumentationProfileHash : 0);
+        return moduleCacheDirectory_ + "/" + string::format("%016llx", (unsigned long long)hasher.hash())
+               + interface::InterfaceFileExtension;
+    }
+
+    std::unique_ptr<llvm::Module> emitModule(ast::Module *module) {
+        std::unique_ptr<llvm::Module> llvmModule = back::emitModule(
+            world_, module, typeMap_, context_, Jit->getTargetMachine(), floatingPointMode_, profileOptions());
+
+        if(dumpIROnModuleLoad_) {
+#ifdef ANODE_DEBUG
+            std::cerr << "LLVM IR:\n";
+            llvmModule->dump();
+#endif
+        }
+        return llvmModule;
+    }
+
+    /** Returns the address of the module's initialization function, or 0 if it doesn't have one. */
+    uint64_t addModuleToJit(std::unique_ptr<llvm::Module> llvmModule, const std::string &moduleName) {
+        Jit->addModule(move(llvmModule));
+        return findModuleInitializer(moduleName);
+    }
+
+    static uint64_t findModuleInitializer(const std::string &moduleName) {
+        if(auto moduleInitSymbol = Jit->findSymbol(moduleName + back::MODULE_INIT_SUFFIX))
+            return llvm::cantFail(moduleInitSymbol.getAddress());
+
+        return 0;
+    }
 public:
     NO_COPY_NO_ASSIGN(ExecutionContextImpl)
-    ExecutionContextImpl() : typeMap_{context_} {
-        Jit->putExport(back::EXECUTION_CONTEXT_GLOBAL_NAME, reinterpret_cast<runtime::symbolptr_t>(this));
-    }
+    ExecutionContextImpl() : typeMap_{context_} { }
 
     void dispatchResult(type::PrimitiveType primitiveType, void *valuePtr) {
         if(resultFunctor_)
@@ -69,13 +503,80 @@ public:
         setPrettyPrintAst_ = value;
     }
 
+    void setFloatingPointMode(ast::FloatingPointMode mode) override {
+        floatingPointMode_ = mode;
+    }
+
+    void setOptimizationLevel(unsigned level) override {
+        Jit->setOptimizationLevel(level);
+    }
+
     void setResultCallback(ResultCallbackFunctor functor) override {
         resultFunctor_ = functor;
     }
 
+    ast::AnodeWorld &world() override {
+        return world_;
+    }
+
+    void setModuleCacheDirectory(const std::string &directory) override {
+        if(::mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+            std::cerr << "Warning: couldn't create module cache directory " << directory << ": " << std::strerror(errno)
+                      << "\n";
+            return;
+        }
+        moduleCacheDirectory_ = directory;
+    }
+
+    bool hasCachedModule(uint64_t cacheKey) override {
+        return !moduleCacheDirectory_.empty() && ::access(cachedModulePath(cacheKey).c_str(), R_OK) == 0;
+    }
+
+    bool executeCachedModule(const std::string &moduleName, uint64_t cacheKey) override {
+        if(!hasCachedModule(cacheKey)) {
+            return false;
+        }
+        error::ErrorStream errorStream {std::cerr};
+        uint64_t interfaceHash;
+        bool reused = false;
+        try {
+            if(loadInterfaceIfCurrent(
+                cachedModulePath(cacheKey), moduleName, &cacheKey, source::SourceSpan::Any, errorStream, interfaceHash,
+                reused)) {
+                return false;
+            }
+        } catch(exception::Exception &e) {
+            std::cerr << "Warning: couldn't load cached module " << moduleName << ": " << e.what() << "\n";
+            return false;
+        }
+        if(reused) {
+            stats::global().increment("execute.modulesLoadedFromCache");
+        }
+        return reused;
+    }
+
+    void executeAndCacheModule(ast::Module *module, const std::string &sourceText, uint64_t cacheKey) override {
+        ASSERT(module);
+        if(moduleCacheDirectory_.empty() || !interface::exportsAllSymbols(*module)) {
+            executeModule(module);
+            return;
+        }
+        uint64_t interfaceHash;
+        std::string notWrittenReason;
+        uint64_t initFuncPtr = compileModule(
+            *module, sourceText, cacheKey, cachedModulePath(cacheKey), interfaceHash, notWrittenReason);
+        runModuleInitializer(initFuncPtr);
+    }
+
     bool prepareModule(ast::Module *module) override {
         error::ErrorStream errorStream {std::cerr};
+        if(importModules(*module, errorStream)) {
+            return true;
+        }
+        unsigned long nodesCreatedBefore = ast::astNodesCreatedCount;
         anode::front::passes::runAllPasses(world_, *module, errorStream);
+        stats::global().addModuleStatistic(
+            module->name(), "astNodesFromTemplateExpansion", ast::astNodesCreatedCount - nodesCreatedBefore);
 
         if(errorStream.errorCount() > 0) {
             return true;
@@ -93,27 +594,122 @@ protected:
     virtual uint64_t loadModule(ast::Module *module) override {
         ASSERT(module);
 
-        std::unique_ptr<llvm::Module> llvmModule = back::emitModule(world_, module, typeMap_, context_, Jit->getTargetMachine());
+        return addModuleToJit(emitModule(module), module->name());
+    }
+}; //ExecutionContextImpl
 
-        if(dumpIROnModuleLoad_) {
-#ifdef ANODE_DEBUG
-            std::cerr << "LLVM IR:\n";
-            llvmModule->dump();
-#endif
+extern "C" void receiveReplResult(uint64_t ecPtr, type::PrimitiveType primitiveType, void *valuePtr) {
+    ExecutionContextImpl *ec = reinterpret_cast<ExecutionContextImpl*>(ecPtr);
+    ec->dispatchResult(primitiveType, valuePtr);
+}
+
+namespace {
+
+/** Enough for about 100 seconds of CPU time at the default frequency. */
+const size_t ProfileCapacity = 100000;
+
+/** The name of the function containing address, which is either JITd or in the host process. */
+std::string symbolize(uintptr_t address) {
+    if(Jit) {
+        std::string name = Jit->functionAt(address);
+        if(!name.empty()) {
+            return name;
         }
+    }
 
-        Jit->addModule(move(llvmModule));
+    Dl_info info;
+    if(!dladdr(reinterpret_cast<void*>(address), &info)) {
+        return "[unknown]";
+    }
+    if(info.dli_sname) {
+        int status;
+        char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = demangled ? demangled : info.dli_sname;
+        std::free(demangled);
+        return name;
+    }
+    //Without a symbol, which is the case for static functions, at least the library is known.
+    if(info.dli_fname) {
+        const char *slash = std::strrchr(info.dli_fname, '/');
+        return std::string("[") + (slash ? slash + 1 : info.dli_fname) + "]";
+    }
+    return "[unknown]";
+}
 
-        if(auto moduleInitSymbol = Jit->findSymbol(module->name() + back::MODULE_INIT_SUFFIX))
-            return llvm::cantFail(moduleInitSymbol.getAddress());
+}
 
-        return 0;
+void startProfiler(unsigned frequency) {
+    ProfileJitCode = true;
+    if(Jit) {
+        Jit->enableProfiling();
     }
-}; //ExecutionContextImpl
+    runtime::profiler::registerThread();
+    runtime::profiler::start(frequency, ProfileCapacity);
+}
 
-extern "C" void receiveReplResult(uint64_t ecPtr, type::PrimitiveType primitiveType, void *valuePtr) {
-    ExecutionContextImpl *ec = reinterpret_cast<ExecutionContextImpl*>(ecPtr);
-    ec->dispatchResult(primitiveType, valuePtr);
+size_t writeProfile(std::ostream &out) {
+    runtime::profiler::stop();
+    size_t droppedCount;
+    std::vector<runtime::profiler::Stack> samples = runtime::profiler::takeSamples(droppedCount);
+
+    std::unordered_map<uintptr_t, std::string> names;
+    std::map<std::string, unsigned long> foldedStacks;
+    for(const runtime::profiler::Stack &stack : samples) {
+        std::string folded;
+        //Folded stacks list the outermost frame first.
+        for(size_t i = stack.size(); i > 0; --i) {
+            //Return addresses are those of the instruction following the call, which may be in the next function.
+            uintptr_t address = i == 1 ? stack[0] : stack[i - 1] - 1;
+            auto found = names.find(address);
+            if(found == names.end()) {
+                std::string name = symbolize(address);
+                //The separators of the folded stack format.
+                std::replace(name.begin(), name.end(), ';', ':');
+                std::replace(name.begin(), name.end(), ' ', '_');
+                found = names.emplace(address, name).first;
+            }
+            if(!folded.empty()) folded += ';';
+            folded += found->second;
+        }
+        foldedStacks[folded]++;
+    }
+    for(const auto &foldedStack : foldedStacks) {
+        out << foldedStack.first << " " << foldedStack.second << "\n";
+    }
+    return droppedCount;
+}
+
+void setInstrumentationEnabled(bool enabled) {
+    InstrumentModules = enabled;
+}
+
+size_t writeInstrumentationProfile(std::ostream &out) {
+    return runtime::instrumentation::writeCounters(out);
+}
+
+void useInstrumentationProfile(std::istream &in) {
+    back::ProfileCounts counts;
+    ContentHasher hasher;
+    std::string line;
+    for(int lineNo = 1; std::getline(in, line); ++lineNo) {
+        if(line.empty()) {
+            continue;
+        }
+        //Counter names may contain spaces, which is why the count comes first.
+        size_t space = line.find(' ');
+        char *end = nullptr;
+        unsigned long long count = std::strtoull(line.c_str(), &end, 10);
+        if(space == std::string::npos || space == 0 || end != line.c_str() + space) {
+            throw ExecutionException(string::format("Line %d of the profile is not a count followed by a name", lineNo));
+        }
+        if(!counts.emplace(line.substr(space + 1), count).second) {
+            throw ExecutionException(string::format("Line %d of the profile repeats the name of another", lineNo));
+        }
+        hasher.add(line);
+    }
+    InstrumentationProfile = std::move(counts);
+    InstrumentationProfileHash = hasher.hash();
+    UseInstrumentationProfile = true;
 }
 
 std::unique_ptr<ExecutionContext> createExecutionContext() {
@@ -2,13 +2,15 @@
 #include "front/ast.h"
 
 #include <atomic>
+#include <unordered_map>
 
 namespace anode { namespace front { namespace ast {
 
 unsigned long astNodesDestroyedCount = 0;
+thread_local unsigned long astNodesCreatedCount = 0;
 
 AstNode::AstNode() : nodeId_{GetNextUniqueId()} {
-
+    astNodesCreatedCount++;
 }
 
 std::string to_string(UnaryOperationKind type) {
@@ -57,6 +59,44 @@ std::string to_string(BinaryOperationKind kind) {
     }
 }
 
+std::string to_string(FloatingPointMode mode) {
+    switch(mode) {
+        case FloatingPointMode::Default:
+            return "default";
+        case FloatingPointMode::Precise:
+            return "precise";
+        case FloatingPointMode::Contract:
+            return "contract";
+        case FloatingPointMode::Fast:
+            return "fast";
+        default:
+            ASSERT_FAIL("Unhandled FloatingPointMode");
+    }
+}
+
+const IntrinsicKind *findMathIntrinsic(const std::string &name) {
+    static const std::unordered_map<std::string, IntrinsicKind> mathIntrinsics {
+        { "sqrt", IntrinsicKind::Sqrt },
+        { "fabs", IntrinsicKind::Fabs },
+        { "floor", IntrinsicKind::Floor },
+        { "ceil", IntrinsicKind::Ceil },
+        { "min", IntrinsicKind::Min },
+        { "max", IntrinsicKind::Max },
+        { "fma", IntrinsicKind::Fma },
+        { "pow", IntrinsicKind::Pow },
+        { "exp", IntrinsicKind::Exp },
+        { "log", IntrinsicKind::Log },
+        { "sin", IntrinsicKind::Sin },
+        { "cos", IntrinsicKind::Cos }
+    };
+    auto found = mathIntrinsics.find(name);
+    return found == mathIntrinsics.end() ? nullptr : &found->second;
+}
+
+bool isIntrinsicName(const std::string &name) {
+    return type::VectorType::fromKeyword(name) || name == "shuffle" || name == "store" || findMathIntrinsic(name);
+}
+
 type::FunctionType &createFunctionType(type::Type &returnType, const gc_ref_vector<ParameterDef> &parameters) {
     gc_ref_vector<type::Type> parameterTypes;
     parameterTypes.reserve(parameters.size());
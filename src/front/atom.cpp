@@ -0,0 +1,56 @@
+
+#include "front/atom.h"
+
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+namespace anode { namespace front {
+
+namespace {
+
+/** Function-local statics are used here so that Atoms may be safely created during static initialization elsewhere. */
+struct AtomTable {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<Atom::Entry>> entries;
+};
+
+AtomTable &atomTable() {
+    static AtomTable table;
+    return table;
+}
+
+const Atom::Entry &emptyEntry() {
+    static const Atom::Entry entry{std::string(), std::hash<std::string>()(std::string())};
+    return entry;
+}
+
+}
+
+Atom::Atom() : entry_{&emptyEntry()} { }
+
+const Atom::Entry &Atom::intern(const std::string &text) {
+    if(text.empty()) {
+        return emptyEntry();
+    }
+
+    AtomTable &table = atomTable();
+    std::lock_guard<std::mutex> lock{table.mutex};
+
+    auto found = table.entries.find(text);
+    if(found != table.entries.end()) {
+        return *found->second;
+    }
+
+    auto &entry = table.entries[text];
+    entry.reset(new Entry{text, std::hash<std::string>()(text)});
+    return *entry;
+}
+
+std::size_t Atom::internedCount() {
+    AtomTable &table = atomTable();
+    std::lock_guard<std::mutex> lock{table.mutex};
+    return table.entries.size();
+}
+
+}}
@@ -0,0 +1,525 @@
+#include "front/module_interface.h"
+#include "common/content_hash.h"
+
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace anode { namespace front { namespace interface {
+
+namespace {
+
+enum class TypeTag : uint8_t {
+    Scalar,
+    Class,
+    Function,
+    Array,
+    Vector
+};
+
+class InterfaceWriter {
+    std::ostream &out_;
+public:
+    explicit InterfaceWriter(std::ostream &out) : out_{out} { }
+
+    void writeBytes(const char *bytes, size_t size) {
+        out_.write(bytes, size);
+    }
+
+    template<typename T>
+    void write(T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values may be written directly.");
+        writeBytes(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(const std::string &str) {
+        write((uint32_t)str.size());
+        writeBytes(str.data(), str.size());
+    }
+
+    void writeType(const type::Type &anyType) {
+        type::Type &actualType = *anyType.actualType();
+        switch(actualType.typeKind()) {
+            case type::TypeKind::Scalar:
+                write(TypeTag::Scalar);
+                write(actualType.primitiveType());
+                break;
+            case type::TypeKind::Class:
+                write(TypeTag::Class);
+                writeString(actualType.name());
+                break;
+            case type::TypeKind::Function: {
+                auto &functionType = upcast<type::FunctionType>(actualType);
+                write(TypeTag::Function);
+                writeType(*functionType.returnType());
+                write((uint32_t)functionType.parameterTypes().size());
+                for(type::Type &parameterType : functionType.parameterTypes()) {
+                    writeType(parameterType);
+                }
+                break;
+            }
+            case type::TypeKind::Array:
+                write(TypeTag::Array);
+                writeType(upcast<type::ArrayType>(actualType).elementType());
+                break;
+            case type::TypeKind::Vector:
+                write(TypeTag::Vector);
+                writeString(actualType.name());
+                break;
+            default:
+                ASSERT_FAIL("Type cannot be written to a module interface.");
+        }
+    }
+};
+
+class InterfaceReader {
+    const char *data_;
+    size_t size_;
+    size_t offset_;
+public:
+    InterfaceReader(const char *data, size_t size, size_t offset) : data_{data}, size_{size}, offset_{offset} { }
+
+    size_t offset() const { return offset_; }
+
+    const char *readBytes(size_t size) {
+        if(size > size_ - offset_) {
+            throw InterfaceException("Module interface is truncated.");
+        }
+        const char *bytes = data_ + offset_;
+        offset_ += size;
+        return bytes;
+    }
+
+    template<typename T>
+    T read() {
+        T value;
+        std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string readString() {
+        auto size = read<uint32_t>();
+        return std::string(readBytes(size), size);
+    }
+};
+
+/** Extracts the text of a span from the source it refers to.  Lines and positions within lines both start at 1. */
+std::string extractSourceText(const std::string &sourceText, const source::SourceSpan &span) {
+    auto offsetOf = [&](source::SourceLocation location) {
+        size_t offset = 0;
+        for(unsigned line = 1; line < location.line(); ++line) {
+            offset = sourceText.find('\n', offset);
+            ASSERT(offset != std::string::npos && "Span is not within the source text.");
+            ++offset;
+        }
+        return offset + location.position() - 1;
+    };
+
+    size_t start = offsetOf(span.start());
+    size_t end = offsetOf(span.end());
+    ASSERT(start <= end && end <= sourceText.size());
+    return sourceText.substr(start, end - start);
+}
+
+/** Determines which classes may be referred to by the signatures recorded in an interface. */
+class ExportableTypes {
+    ast::Module &module_;
+    std::unordered_set<const type::Type*> exportedClasses_;
+public:
+    explicit ExportableTypes(ast::Module &module) : module_{module} { }
+
+    void addExportedClass(const type::ClassType &classType) {
+        exportedClasses_.insert(&classType);
+    }
+
+    bool isExportable(const type::Type &anyType) const {
+        type::Type &actualType = *anyType.actualType();
+        switch(actualType.typeKind()) {
+            case type::TypeKind::Scalar:
+                return true;
+            case type::TypeKind::Class: {
+                if(exportedClasses_.count(&actualType)) {
+                    return true;
+                }
+                //Classes of other modules are in the global scope, where the importer will find them.
+                scope::SymbolTable *globalScope = module_.scope().parent();
+                scope::Symbol *found = globalScope ? globalScope->findSymbolInCurrentScope(Atom(actualType.name())) : nullptr;
+                return found && isInstanceOf<scope::TypeSymbol>(found) && found->type().actualType() == &actualType;
+            }
+            case type::TypeKind::Function: {
+                auto &functionType = upcast<type::FunctionType>(actualType);
+                if(!isExportable(*functionType.returnType())) {
+                    return false;
+                }
+                for(type::Type &parameterType : functionType.parameterTypes()) {
+                    if(!isExportable(parameterType)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            case type::TypeKind::Array:
+                return isExportable(upcast<type::ArrayType>(actualType).elementType());
+            case type::TypeKind::Vector:
+                return true;
+            default:
+                return false;
+        }
+    }
+};
+
+/**
+ * Classes, excluding those expanded from generic classes:  their generic classes are reconstituted from the template
+ * sources and each importer expands them for itself.
+ */
+gc_ref_vector<scope::TypeSymbol> exportedClasses(ast::Module &module, ExportableTypes &exportable) {
+    gc_ref_vector<scope::TypeSymbol> classes;
+    for(scope::TypeSymbol &symbol : module.scope().types()) {
+        auto classType = tryUpcast<type::ClassType>(symbol.type().actualType());
+        if(classType && !classType->genericType()) {
+            classes.emplace_back(symbol);
+            exportable.addExportedClass(*classType);
+        }
+    }
+    return classes;
+}
+
+void writeSymbols(ast::Module &module, InterfaceWriter &writer) {
+    ExportableTypes exportable{module};
+    gc_ref_vector<scope::TypeSymbol> classes = exportedClasses(module, exportable);
+
+    //The names of all classes come first so that fields and methods may refer to classes defined after their own.
+    writer.write((uint32_t)classes.size());
+    for(scope::TypeSymbol &symbol : classes) {
+        writer.writeString(symbol.type().actualType()->name());
+        writer.writeString(symbol.fullyQualifiedName().text());
+    }
+    for(scope::TypeSymbol &symbol : classes) {
+        auto &classType = upcast<type::ClassType>(*symbol.type().actualType());
+
+        gc_ref_vector<type::ClassField> fields = classType.fields();
+        writer.write((uint32_t)fields.size());
+        for(type::ClassField &field : fields) {
+            //A field's type must be exportable for the layout to be known, so unlike functions, this is not optional.
+            if(!exportable.isExportable(field.type())) {
+                throw InterfaceException(string::format(
+                    "Field '%s' of class '%s' has a type which cannot be exported", field.name().c_str(), classType.name().c_str()));
+            }
+            writer.writeString(field.name().text());
+            writer.writeType(field.type());
+        }
+
+        gc_ref_vector<type::ClassMethod> methods;
+        for(type::ClassMethod &method : classType.methods()) {
+            if(exportable.isExportable(*method.symbol().functionType())) {
+                methods.emplace_back(method);
+            }
+        }
+        writer.write((uint32_t)methods.size());
+        for(type::ClassMethod &method : methods) {
+            writer.writeString(method.name().text());
+            writer.writeString(method.symbol().fullyQualifiedName().text());
+            writer.writeType(*method.symbol().functionType());
+        }
+    }
+
+    gc_ref_vector<scope::VariableSymbol> variables;
+    for(scope::VariableSymbol &symbol : module.scope().variables()) {
+        if(exportable.isExportable(symbol.type())) {
+            variables.emplace_back(symbol);
+        }
+    }
+    writer.write((uint32_t)variables.size());
+    for(scope::VariableSymbol &symbol : variables) {
+        writer.writeString(symbol.name().text());
+        writer.writeString(symbol.fullyQualifiedName().text());
+        writer.writeType(symbol.type());
+    }
+
+    gc_ref_vector<scope::FunctionSymbol> functions;
+    for(scope::FunctionSymbol &symbol : module.scope().functions()) {
+        if(exportable.isExportable(*symbol.functionType())) {
+            functions.emplace_back(symbol);
+        }
+    }
+    writer.write((uint32_t)functions.size());
+    for(scope::FunctionSymbol &symbol : functions) {
+        writer.writeString(symbol.name().text());
+        writer.writeString(symbol.fullyQualifiedName().text());
+        writer.writeType(*symbol.functionType());
+    }
+}
+
+}
+
+uint64_t writeModuleInterface(ast::Module &module, const CompiledModule &compiled, std::ostream &out) {
+    ASSERT(compiled.importInterfaceHashes.size() == module.imports().size());
+
+    std::vector<std::string> templateSources;
+    for(ast::ExprStmt &exprStmt : module.body().expressions()) {
+        if(isInstanceOf<ast::NamedTemplateExprStmt>(exprStmt) || isInstanceOf<ast::AnonymousTemplateExprStmt>(exprStmt)) {
+            templateSources.emplace_back(extractSourceText(compiled.sourceText, exprStmt.sourceSpan()));
+        }
+    }
+
+    //The symbols are written first so that the interface hash, which precedes them, can be computed.
+    std::ostringstream symbols;
+    InterfaceWriter symbolWriter{symbols};
+    writeSymbols(module, symbolWriter);
+    std::string symbolBytes = symbols.str();
+
+    ContentHasher interfaceHasher;
+    for(const std::string &templateSource : templateSources) {
+        interfaceHasher.add(templateSource);
+    }
+    interfaceHasher.add(symbolBytes);
+    uint64_t interfaceHash = interfaceHasher.hash();
+
+    InterfaceWriter writer{out};
+    writer.writeBytes(InterfaceMagic, sizeof(InterfaceMagic));
+    writer.write(InterfaceVersion);
+    writer.writeString(module.name());
+    writer.write(compiled.sourceHash);
+    writer.write(interfaceHash);
+    writer.write(compiled.compilerIdentity);
+    writer.write(compiled.floatingPointMode);
+    writer.write(compiled.optimizationLevel);
+
+    writer.write((uint32_t)module.imports().size());
+    for(size_t i = 0; i < module.imports().size(); ++i) {
+        writer.writeString(module.imports()[i].qualifedName());
+        writer.write(compiled.importInterfaceHashes[i]);
+    }
+
+    writer.write((uint32_t)templateSources.size());
+    for(const std::string &templateSource : templateSources) {
+        writer.writeString(templateSource);
+    }
+
+    writer.write((uint64_t)compiled.code.size());
+    writer.writeBytes(compiled.code.data(), compiled.code.size());
+
+    writer.writeString(compiled.objectTriple);
+    writer.write((uint64_t)compiled.object.size());
+    writer.writeBytes(compiled.object.data(), compiled.object.size());
+
+    writer.writeBytes(symbolBytes.data(), symbolBytes.size());
+    return interfaceHash;
+}
+
+bool exportsAllSymbols(ast::Module &module) {
+    ExportableTypes exportable{module};
+    for(scope::TypeSymbol &symbol : exportedClasses(module, exportable)) {
+        for(type::ClassField &field : upcast<type::ClassType>(*symbol.type().actualType()).fields()) {
+            if(!exportable.isExportable(field.type())) {
+                return false;
+            }
+        }
+    }
+
+    for(scope::Symbol &symbol : module.scope().symbols()) {
+        switch(symbol.symbolKind()) {
+            case scope::SymbolKind::Variable:
+                if(!exportable.isExportable(symbol.type())) return false;
+                break;
+            case scope::SymbolKind::Function:
+                if(!exportable.isExportable(*upcast<scope::FunctionSymbol>(symbol).functionType())) return false;
+                break;
+            case scope::SymbolKind::Namespace:
+                return false;
+            default:
+                //Classes were checked above and templates are recreated from their source.
+                break;
+        }
+    }
+    return true;
+}
+
+ModuleInterfaceReader::ModuleInterfaceReader(const char *data, size_t size) : data_{data}, size_{size} {
+    InterfaceReader reader{data_, size_, 0};
+
+    if(size_ < sizeof(InterfaceMagic) || std::memcmp(reader.readBytes(sizeof(InterfaceMagic)), InterfaceMagic, sizeof(InterfaceMagic)) != 0) {
+        throw InterfaceException("Not a module interface.");
+    }
+    if(reader.read<uint32_t>() != InterfaceVersion) {
+        throw InterfaceException("Module interface was written by a different version of the compiler.");
+    }
+    moduleName_ = reader.readString();
+    sourceHash_ = reader.read<uint64_t>();
+    interfaceHash_ = reader.read<uint64_t>();
+    compilerIdentity_ = reader.read<uint64_t>();
+    floatingPointMode_ = reader.read<ast::FloatingPointMode>();
+    optimizationLevel_ = reader.read<uint32_t>();
+
+    auto importCount = reader.read<uint32_t>();
+    for(uint32_t i = 0; i < importCount; ++i) {
+        std::string qualifiedName = reader.readString();
+        imports_.push_back(InterfaceImport{qualifiedName, reader.read<uint64_t>()});
+    }
+
+    auto templateCount = reader.read<uint32_t>();
+    for(uint32_t i = 0; i < templateCount; ++i) {
+        templateSources_.emplace_back(reader.readString());
+    }
+
+    codeSize_ = reader.read<uint64_t>();
+    code_ = reader.readBytes(codeSize_);
+
+    objectTriple_ = reader.readString();
+    objectSize_ = reader.read<uint64_t>();
+    object_ = reader.readBytes(objectSize_);
+
+    symbolsOffset_ = reader.offset();
+}
+
+namespace {
+
+class SymbolImporter {
+    InterfaceReader &reader_;
+    scope::SymbolTable &globalScope_;
+    std::unordered_map<std::string, type::ClassType*> classes_;
+    //The symbols to be added to the global scope once all of them have been read, with their fully qualified names.
+    gc_vector<std::pair<scope::SymbolBase*, std::string>> globals_;
+
+    void addSymbol(scope::SymbolTable &symbolTable, scope::SymbolBase &symbol, const std::string &fullyQualifiedName) {
+        if(symbolTable.findSymbolInCurrentScope(symbol.name())) {
+            throw InterfaceException(string::format(
+                "Imported symbol '%s' was previously defined in the current scope", symbol.name().c_str()));
+        }
+        symbol.setImported(symbolTable, Atom(fullyQualifiedName));
+        symbolTable.addSymbol(symbol);
+    }
+
+    /**
+     * Adds the global symbols only if none of them is already defined, so that an interface which can't be imported
+     * leaves the global scope unchanged.
+     */
+    void addGlobals() {
+        std::unordered_set<Atom> names;
+        for(auto &global : globals_) {
+            if(!names.insert(global.first->name()).second || globalScope_.findSymbolInCurrentScope(global.first->name())) {
+                throw InterfaceException(string::format(
+                    "Imported symbol '%s' was previously defined in the current scope", global.first->name().c_str()));
+            }
+        }
+        for(auto &global : globals_) {
+            addSymbol(globalScope_, *global.first, global.second);
+        }
+    }
+
+public:
+    SymbolImporter(InterfaceReader &reader, scope::SymbolTable &globalScope) : reader_{reader}, globalScope_{globalScope} { }
+
+    type::Type &readType() {
+        auto tag = reader_.read<TypeTag>();
+        switch(tag) {
+            case TypeTag::Scalar:
+                switch(reader_.read<type::PrimitiveType>()) {
+                    case type::PrimitiveType::Void: return type::ScalarType::Void;
+                    case type::PrimitiveType::Bool: return type::ScalarType::Bool;
+                    case type::PrimitiveType::Int32: return type::ScalarType::Int32;
+                    case type::PrimitiveType::Float: return type::ScalarType::Float;
+                    case type::PrimitiveType::Double: return type::ScalarType::Double;
+                    default: throw InterfaceException("Module interface contains an invalid primitive type.");
+                }
+            case TypeTag::Class: {
+                std::string name = reader_.readString();
+                auto found = classes_.find(name);
+                if(found != classes_.end()) {
+                    return *found->second;
+                }
+                scope::Symbol *symbol = globalScope_.findSymbolInCurrentScope(Atom(name));
+                if(!symbol || !isInstanceOf<scope::TypeSymbol>(symbol) || !symbol->type().isClass()) {
+                    throw InterfaceException(string::format("Class '%s' referenced by module interface is not defined", name.c_str()));
+                }
+                return *symbol->type().actualType();
+            }
+            case TypeTag::Function:
+                return readFunctionType();
+            case TypeTag::Array:
+                return *new type::ArrayType(readType());
+            case TypeTag::Vector: {
+                type::VectorType *vectorType = type::VectorType::fromKeyword(reader_.readString());
+                if(!vectorType) {
+                    throw InterfaceException("Module interface contains an unknown vector type.");
+                }
+                return *vectorType;
+            }
+            default:
+                throw InterfaceException("Module interface contains an invalid type.");
+        }
+    }
+
+    type::FunctionType &readFunctionType() {
+        type::Type &returnType = readType();
+        auto parameterCount = reader_.read<uint32_t>();
+        gc_ref_vector<type::Type> parameterTypes;
+        for(uint32_t i = 0; i < parameterCount; ++i) {
+            parameterTypes.emplace_back(readType());
+        }
+        return *new type::FunctionType(&returnType, parameterTypes);
+    }
+
+    void importAll() {
+        auto classCount = reader_.read<uint32_t>();
+        std::vector<std::pair<type::ClassType*, std::string>> classes;
+        for(uint32_t i = 0; i < classCount; ++i) {
+            std::string name = reader_.readString();
+            std::string fullyQualifiedName = reader_.readString();
+            auto &classType = *new type::ClassType(GetNextUniqueId(), name, gc_ref_vector<type::Type>());
+            classes_.emplace(name, &classType);
+            classes.emplace_back(&classType, fullyQualifiedName);
+            globals_.emplace_back(new scope::TypeSymbol(classType), fullyQualifiedName);
+        }
+
+        for(auto &entry : classes) {
+            type::ClassType &classType = *entry.first;
+            auto fieldCount = reader_.read<uint32_t>();
+            for(uint32_t i = 0; i < fieldCount; ++i) {
+                Atom fieldName{reader_.readString()};
+                classType.addField(fieldName, readType());
+            }
+
+            //Methods are placed in a symbol table of their own, like the body of the class they were defined in.
+            auto &classScope = *new scope::SymbolTable(scope::StorageKind::Instance, classType.name());
+            classScope.setParent(globalScope_);
+            auto methodCount = reader_.read<uint32_t>();
+            for(uint32_t i = 0; i < methodCount; ++i) {
+                Atom methodName{reader_.readString()};
+                std::string fullyQualifiedName = reader_.readString();
+                auto &methodSymbol = *new scope::FunctionSymbol(methodName, &readFunctionType());
+                addSymbol(classScope, methodSymbol, fullyQualifiedName);
+                methodSymbol.setThisSymbol(new scope::VariableSymbol(Atom("this"), classType));
+                classType.addMethod(methodName, methodSymbol);
+            }
+        }
+
+        auto variableCount = reader_.read<uint32_t>();
+        for(uint32_t i = 0; i < variableCount; ++i) {
+            Atom name{reader_.readString()};
+            std::string fullyQualifiedName = reader_.readString();
+            globals_.emplace_back(new scope::VariableSymbol(name, readType()), fullyQualifiedName);
+        }
+
+        auto functionCount = reader_.read<uint32_t>();
+        for(uint32_t i = 0; i < functionCount; ++i) {
+            Atom name{reader_.readString()};
+            std::string fullyQualifiedName = reader_.readString();
+            globals_.emplace_back(new scope::FunctionSymbol(name, &readFunctionType()), fullyQualifiedName);
+        }
+
+        addGlobals();
+    }
+};
+
+}
+
+void ModuleInterfaceReader::importSymbols(ast::AnodeWorld &world) const {
+    InterfaceReader reader{data_, size_, symbolsOffset_};
+    SymbolImporter importer{reader, world.globalScope()};
+    importer.importAll();
+}
+
+}}}
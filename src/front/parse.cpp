@@ -1,8 +1,14 @@
 
 #include "common/exception.h"
+#include "common/stats.h"
+#include "common/thread_pool.h"
 #include "front/parse.h"
+#include "front/ast_passes.h"
 #include "parser/AnodeParser.h"
 
+#include <algorithm>
+#include <sstream>
+
 
 namespace anode { namespace front {
 
@@ -12,11 +18,26 @@ namespace anode { namespace front {
     }
 
     ast::Module &parseModule(std::istream &inputStream, const std::string &name, error::ErrorStream &errorStream) {
+        stats::Statistics &statistics = stats::global();
+        stats::CounterValues countersBefore = statistics.readCounters();
+        auto start = stats::clock::now();
+        unsigned long nodesCreatedBefore = ast::astNodesCreatedCount;
+
         parser::SourceReader reader{name, inputStream};
         parser::AnodeLexer lexer{reader, errorStream};
         parser::AnodeParser parser{lexer, errorStream};
         ast::Module &module = parser.parseModule();
 
+        if(statistics.enabled()) {
+            //The lexer is driven by the parser, so the time spent lexing is excluded from the time spent parsing.
+            statistics.addTiming("front.lex", lexer.lexTime());
+            //The counters are only read at the beginning and end, so those of front.parse include lexing.
+            statistics.addTiming(
+                "front.parse", stats::clock::now() - start - lexer.lexTime(), statistics.readCounters() - countersBefore);
+            statistics.addModuleStatistic(name, "tokens", lexer.tokenCount());
+            statistics.addModuleStatistic(name, "astNodesParsed", ast::astNodesCreatedCount - nodesCreatedBefore);
+        }
+
         if(errorStream.errorCount() > 0) {
             throw ParseAbortedException("Parse aborted.");
         }
@@ -39,4 +60,67 @@ namespace anode { namespace front {
         return parseModule(inputStringStream, inputName);
     }
 
+    gc_ref_vector<ast::Module> parseModules(
+        const std::vector<std::string> &filenames,
+        ast::AnodeWorld &world,
+        unsigned threadCount,
+        std::ostream &errorOutput)
+    {
+        stats::PhaseTimer timer{"front.parseModules"};
+        if(filenames.empty()) {
+            return gc_ref_vector<ast::Module>();
+        }
+
+        //Each task writes only to its own element of these.
+        gc_vector<ast::Module*> modules;
+        modules.resize(filenames.size(), nullptr);
+        std::vector<std::string> errorOutputs(filenames.size());
+
+        {
+            ThreadPool pool{std::min(threadCount ? threadCount : ThreadPool::defaultThreadCount(), (unsigned)filenames.size())};
+            for(size_t i = 0; i < filenames.size(); ++i) {
+                pool.submit([&, i] {
+                    std::stringstream output;
+                    error::ErrorStream errorStream{output};
+                    try {
+                        std::ifstream inputFileStream{filenames[i]};
+                        if(!inputFileStream) {
+                            output << "Couldn't open input file: " << filenames[i] << "\n";
+                        } else {
+                            ast::Module &module = parseModule(inputFileStream, filenames[i], errorStream);
+                            if(!passes::runModuleLocalPasses(world, module, errorStream)) {
+                                modules[i] = &module;
+                            }
+                        }
+                    } catch(ParseAbortedException &) {
+                        //The errors which caused this have already been written to output.
+                    } catch(std::exception &e) {
+                        //Tasks of the ThreadPool must not throw, so anything else (i.e. a failed debug assertion within
+                        //a pass) is reported as a failure of this file alone.
+                        output << filenames[i] << ": " << e.what() << "\n";
+                        modules[i] = nullptr;
+                    }
+                    errorOutputs[i] = output.str();
+                });
+            }
+            pool.waitForAll();
+        }
+
+        gc_ref_vector<ast::Module> result;
+        bool failed = false;
+        for(size_t i = 0; i < filenames.size(); ++i) {
+            errorOutput << errorOutputs[i];
+            if(modules[i]) {
+                result.emplace_back(*modules[i]);
+            } else {
+                failed = true;
+            }
+        }
+
+        if(failed) {
+            throw ParseAbortedException("Parse aborted.");
+        }
+        return result;
+    }
+
 }}
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <front/parse.h>
 #include "AnodeLexer.h"
 
+#include <mutex>
+
 namespace anode { namespace front { namespace parser {
 
 /** Static token is the name I have chosen to indicate tokens that do not ever change. i.e. operators
@@ -15,12 +17,10 @@ void registerStaticToken(string_t text, TokenKind tokenKind) {
     StaticTokenLookup[firstChar].emplace_back(text, tokenKind);
 }
 
-void InitStaticTokenLookup() {
-
-    if(StaticTokenLookup.size() > 0) {
-        return;
-    }
+namespace {
+std::once_flag staticTokenLookupInitialized;
 
+void initStaticTokenLookupOnce() {
     KeywordLookup.emplace("true", TokenKind::KW_TRUE);
     KeywordLookup.emplace("false", TokenKind::KW_FALSE);
     KeywordLookup.emplace("while", TokenKind::KW_WHILE);
@@ -35,6 +35,16 @@ void InitStaticTokenLookup() {
     KeywordLookup.emplace("expand", TokenKind::KW_EXPAND);
     KeywordLookup.emplace("template", TokenKind::KW_TEMPLATE);
     KeywordLookup.emplace("namespace", TokenKind::KW_NAMESPACE);
+    KeywordLookup.emplace("import", TokenKind::KW_IMPORT);
+    KeywordLookup.emplace("spawn", TokenKind::KW_SPAWN);
+    KeywordLookup.emplace("join", TokenKind::KW_JOIN);
+    KeywordLookup.emplace("for", TokenKind::KW_FOR);
+    KeywordLookup.emplace("in", TokenKind::KW_IN);
+    KeywordLookup.emplace("parallel", TokenKind::KW_PARALLEL);
+    KeywordLookup.emplace("reduce", TokenKind::KW_REDUCE);
+    KeywordLookup.emplace("vectorize", TokenKind::KW_VECTORIZE);
+    KeywordLookup.emplace("unroll", TokenKind::KW_UNROLL);
+    KeywordLookup.emplace("fpmode", TokenKind::KW_FPMODE);
 
     //For tokens that start with the same character(s), the longer one must be registered first!
     registerStaticToken("++", TokenKind::OP_INC);
@@ -56,6 +66,7 @@ void InitStaticTokenLookup() {
     registerStaticToken(">", TokenKind::OP_GT);
     registerStaticToken(">", TokenKind::OP_DIV);
     registerStaticToken("<", TokenKind::OP_LT);
+    registerStaticToken("..", TokenKind::OP_RANGE);
     registerStaticToken(".", TokenKind::OP_DOT);
     registerStaticToken("::", TokenKind::OP_NAMESPACE);
     registerStaticToken(":", TokenKind::OP_DEF);
@@ -63,14 +74,23 @@ void InitStaticTokenLookup() {
     registerStaticToken(")", TokenKind::CLOSE_PAREN);
     registerStaticToken("{", TokenKind::OPEN_CURLY);
     registerStaticToken("}", TokenKind::CLOSE_CURLY);
+    registerStaticToken("[", TokenKind::OPEN_SQUARE);
+    registerStaticToken("]", TokenKind::CLOSE_SQUARE);
     registerStaticToken(",", TokenKind::COMMA);
 }
+}
+
+/** Lexers may be created on several threads at once (see parseModules(...)), so this must only happen once. */
+void InitStaticTokenLookup() {
+    std::call_once(staticTokenLookupInitialized, initStaticTokenLookupOnce);
+}
 
 Token &AnodeLexer::extractLiteralNumber() {
     string_t number;
     number += reader_.next();
     int c = reader_.peek();
-    while ((isDigit(c) || c == '.') && !reader_.eof()) {
+    //The '.' of a range operator (i.e. 0..10) is not a decimal point.
+    while ((isDigit(c) || (c == '.' && reader_.peek(1) != '.')) && !reader_.eof()) {
         number += reader_.next();
         c = reader_.peek();
     }
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "common/containers.h"
+#include "common/stats.h"
 #include "front/source.h"
 #include "front/ErrorStream.h"
 
@@ -54,6 +55,9 @@ class AnodeLexer {
     error::ErrorStream &errorStream_;
     gc_ref_deque<Token> lookahead_;
     SourceLocation startLocation_;
+    bool collectStatistics_ = stats::global().enabled();
+    stats::clock::duration lexTime_ = stats::clock::duration::zero();
+    unsigned long tokenCount_ = 0;
 public:
     NO_COPY_NO_ASSIGN(AnodeLexer)
 
@@ -68,13 +72,14 @@ public:
             lookahead_.pop_front();
             return next;
         } else {
-            return extractToken();
+            return timedExtractToken();
         }
     }
 
-    Token &peekToken() {
-        primeLookahead(1);
-        return lookahead_.front();
+    /** Returns the next token, or the one offset tokens after it, without consuming either. */
+    Token &peekToken(size_t offset = 0) {
+        primeLookahead(offset + 1);
+        return lookahead_[offset];
     }
 
     bool eof() {
@@ -85,11 +90,16 @@ public:
         return reader_.inputName();
     }
 
+    /** Time spent extracting tokens so far.  Only measured if statistics were enabled when this lexer was created. */
+    stats::clock::duration lexTime() const { return lexTime_; }
+
+    unsigned long tokenCount() const { return tokenCount_; }
+
 private:
 
     void primeLookahead(size_t size) {
         while(lookahead_.size() < size) {
-            lookahead_.push_back(extractToken());
+            lookahead_.push_back(timedExtractToken());
         }
     }
 
@@ -145,6 +155,17 @@ private:
     }
 
     Token &extractToken();
+
+    Token &timedExtractToken() {
+        tokenCount_++;
+        if(!collectStatistics_) {
+            return extractToken();
+        }
+        auto start = stats::clock::now();
+        Token &token = extractToken();
+        lexTime_ += stats::clock::now() - start;
+        return token;
+    }
     Token &extractIdentifierOrKeyword();
     Token &extractLiteralNumber();
 };
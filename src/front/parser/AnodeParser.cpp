@@ -36,6 +36,7 @@ int AnodeParser::getOperatorPrecedence(TokenKind kind) {
     switch(kind) {
         case TokenKind::OP_DOT:
         case TokenKind::OPEN_PAREN:
+        case TokenKind::OPEN_SQUARE:
             return MAX_PRECEDENCE - 2;
         case TokenKind::OP_NOT:
             return MAX_PRECEDENCE - 3;
@@ -70,10 +71,13 @@ ast::ExprStmt &AnodeParser::parseBinaryExpr(ast::ExprStmt &lValue, Token &operat
     switch(operatorToken.kind()) {
         case TokenKind::OP_ASSIGN: {
             opKind = ast::BinaryOperationKind::Assign;
-            ast::VariableRefExpr *varRef = dynamic_cast<ast::VariableRefExpr*>(&lValue);
+            ast::VariableRefExpr *varRef = tryUpcast<ast::VariableRefExpr>(&lValue);
             if(varRef != nullptr) {
                 varRef->setVariableAccess(ast::VariableAccess::Write);
             }
+            if(auto indexExpr = tryUpcast<ast::IndexExpr>(&lValue)) {
+                indexExpr->setIsWrite(true);
+            }
             break;
         }
         case TokenKind::OP_ADD:    opKind = ast::BinaryOperationKind::Add; break;
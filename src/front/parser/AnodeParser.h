@@ -4,23 +4,21 @@
 #include "PrattParser.h"
 #include "front/ast.h"
 
-#include <functional>
 #include <fstream>
 #include <sstream>
 
-using namespace std::placeholders;
 
 namespace anode { namespace front { namespace parser {
 
 
-class AnodeParser : public PrattParser<ast::ExprStmt> {
+class AnodeParser : public PrattParser<ast::ExprStmt, AnodeParser> {
     typedef gc_ref_vector<ast::TemplateParameter> TemplateParameterVector;
     gc_ref_deque<TemplateParameterVector> templateParameterStack_;
 
     std::stack<scope::StorageKind> storageKindStack_;
 
     inline static ast::Identifier makeIdentifier(Token &t) {
-        return ast::Identifier(t.span(), t.text());
+        return ast::Identifier(t.span(), t.atom());
     }
 
     inline static source::SourceSpan makeSourceSpan(const SourceSpan &start, const SourceSpan &end) {
@@ -54,6 +52,10 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
         return consume(TokenKind::CLOSE_PAREN, ')');
     }
 
+    Token &consumeCloseSquare() {
+        return consume(TokenKind::CLOSE_SQUARE, ']');
+    }
+
     Token &consumeGreaterThan()  {
         return consume(TokenKind::OP_GT, '>');
     }
@@ -69,7 +71,7 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
     ast::Identifier *consumeOptionalIdentifier() {
          Token *id = consumeOptional(TokenKind::ID);
          if(id != nullptr) {
-            return new ast::Identifier(id->span(), id->text());
+            return new ast::Identifier(id->span(), id->atom());
         }
         return nullptr;
     }
@@ -111,7 +113,16 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
             } while (consume(TokenKind::OP_GT, TokenKind::COMMA, "'>' or ','").kind() == TokenKind::COMMA);
         }
 
-        return *new ast::ResolutionDeferredTypeRef(typeId.span(), typeId, templateArgs);
+        auto typeRef = new ast::ResolutionDeferredTypeRef(typeId.span(), typeId, templateArgs);
+
+        //Each "[]" makes an array of the preceding type, i.e. "int[][]" is an array of int[].  A '[' which is not followed
+        //by ']' is not part of the type (i.e. "new int[10]").
+        while(lexer_.peekToken().kind() == TokenKind::OPEN_SQUARE && lexer_.peekToken(1).kind() == TokenKind::CLOSE_SQUARE) {
+            lexer_.nextToken();
+            Token &closeSquare = lexer_.nextToken();
+            typeRef = new ast::ResolutionDeferredTypeRef(makeSourceSpan(typeId.span(), closeSquare.span()), *typeRef);
+        }
+        return *typeRef;
     }
 
     ast::ExprStmt &parseLiteralInt32(Token &token) {
@@ -127,6 +138,11 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
     }
 
     ast::ExprStmt &parseVariableRef(Token &firstPart) {
+        if(lexer_.peekToken().kind() == TokenKind::OPEN_PAREN) {
+            if(ast::ExprStmt *intrinsicCall = parseOptionalIntrinsicCall(firstPart)) {
+                return *intrinsicCall;
+            }
+        }
         ast::MultiPartIdentifier identifier = parseQualifiedIdentifier(firstPart);
         if(consumeOptional(TokenKind::OP_DEF)) {
             ast::ResolutionDeferredTypeRef &typeRef = parseTypeRef();
@@ -139,6 +155,52 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
         return *new ast::VariableRefExpr(firstPart.span(), identifier);
     }
 
+    /**
+     * Intrinsics (see ast::IntrinsicCallExpr) are recognized by name, i.e. "float4(...)", "shuffle(...)" or
+     * "sqrt(...)".  Returns nullptr if the name is not that of an intrinsic, in which case nothing is consumed.
+     */
+    ast::ExprStmt *parseOptionalIntrinsicCall(Token &name) {
+        ast::IntrinsicKind kind;
+        type::VectorType *vectorType = type::VectorType::fromKeyword(name.text());
+        if(vectorType) {
+            kind = ast::IntrinsicKind::MakeVector;
+        } else if(name.text() == "shuffle") {
+            kind = ast::IntrinsicKind::Shuffle;
+        } else if(name.text() == "store") {
+            kind = ast::IntrinsicKind::Store;
+        } else if(const ast::IntrinsicKind *mathKind = ast::findMathIntrinsic(name.text())) {
+            kind = *mathKind;
+        } else {
+            return nullptr;
+        }
+        consumeOpenParen();
+        auto argsAndCloseParen = parseFuncCallArguments();
+
+        return new ast::IntrinsicCallExpr(
+            makeSourceSpan(name.span(), argsAndCloseParen.second.get().span()),
+            kind,
+            makeIdentifier(name),
+            argsAndCloseParen.first,
+            vectorType);
+    }
+
+    /** Parses "reduce(+) vector", which combines the lanes of the vector.  (See parseForRemainder for reducing loops.) */
+    ast::ExprStmt &parseReduceLanes(Token &reduceKeyword) {
+        ast::ReductionKind reduction = parseReductionOperator();
+        //Binds as tightly as a prefix operator, so that only v is reduced in "reduce(+) v * 2".
+        ast::ExprStmt &vectorExpr = parseExpr(getOperatorPrecedence(TokenKind::OP_NOT));
+
+        gc_ref_vector<ast::ExprStmt> arguments;
+        arguments.emplace_back(vectorExpr);
+        return *new ast::IntrinsicCallExpr(
+            makeSourceSpan(reduceKeyword.span(), vectorExpr.sourceSpan()),
+            ast::IntrinsicKind::ReduceLanes,
+            makeIdentifier(reduceKeyword),
+            arguments,
+            nullptr,
+            reduction);
+    }
+
     ast::ExprStmt &parseParensExpr(Token &) {
         ast::ExprStmt &expr = parseExpr();
         consumeCloseParen();
@@ -212,8 +274,17 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
             ast::CastKind::Explicit);
     }
 
+    /** Parses "new SomeClass()" or "new elementType[length]". */
     ast::ExprStmt &parseNewExpr(Token &newKeyword) {
         ast::ResolutionDeferredTypeRef &typeRef = parseTypeRef();
+        if(consumeOptional(TokenKind::OPEN_SQUARE)) {
+            ast::ExprStmt &lengthExpr = parseExpr();
+            Token &closeSquare = consumeCloseSquare();
+            return *new ast::NewExpr(
+                makeSourceSpan(newKeyword.span(), closeSquare.span()),
+                *new ast::ResolutionDeferredTypeRef(makeSourceSpan(typeRef.sourceSpan(), closeSquare.span()), typeRef),
+                &lengthExpr);
+        }
         consumeOpenParen();
         Token &closeParen = consumeCloseParen();
 
@@ -270,6 +341,103 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
         );
     }
 
+    ast::ExprStmt &parseFor(Token &forKeyword) {
+        return parseForRemainder(forKeyword, /*isParallel*/ false);
+    }
+
+    ast::ExprStmt &parseParallelFor(Token &parallelKeyword) {
+        consume(TokenKind::KW_FOR, "'for'");
+        return parseForRemainder(parallelKeyword, /*isParallel*/ true);
+    }
+
+    /**
+     * Parses what follows the for keyword:  "(i in begin..end) body", optionally with "reduce(+)" and then "vectorize"
+     * and/or "unroll(n)" before the body.
+     */
+    ast::ExprStmt &parseForRemainder(Token &firstKeyword, bool isParallel) {
+        consumeOpenParen();
+        ast::Identifier name = consumeIdentifier();
+        consume(TokenKind::KW_IN, "'in'");
+        ast::ExprStmt &rangeBegin = parseExpr();
+        consume(TokenKind::OP_RANGE, "'..'");
+        ast::ExprStmt &rangeEnd = parseExpr();
+        consumeCloseParen();
+
+        ast::ReductionKind reduction = ast::ReductionKind::None;
+        if(consumeOptional(TokenKind::KW_REDUCE)) {
+            reduction = parseReductionOperator();
+        }
+        ast::LoopHints hints = parseLoopHints();
+
+        //Variables declared in the body belong to a single iteration, even when the loop is not within a function.
+        storageKindStack_.push(scope::StorageKind::Local);
+        ast::ExprStmt &body = parseExpr();
+        storageKindStack_.pop();
+
+        auto &inductionVar = *new ast::VariableDeclExpr(
+            name.span(),
+            ast::MultiPartIdentifier(name),
+            *new ast::KnownTypeRef(name.span(), type::ScalarType::Int32));
+
+        return *new ast::ForExpr(
+            makeSourceSpan(firstKeyword.span(), body.sourceSpan()),
+            inductionVar,
+            rangeBegin,
+            rangeEnd,
+            body,
+            isParallel,
+            reduction,
+            hints);
+    }
+
+    /** Parses "(+)", "(*)", "(min)" or "(max)". */
+    ast::ReductionKind parseReductionOperator() {
+        consumeOpenParen();
+        Token &operatorToken = lexer_.nextToken();
+        ast::ReductionKind reduction;
+        if(operatorToken.kind() == TokenKind::OP_ADD) {
+            reduction = ast::ReductionKind::Add;
+        } else if(operatorToken.kind() == TokenKind::OP_MUL) {
+            reduction = ast::ReductionKind::Mul;
+        } else if(operatorToken.kind() == TokenKind::ID && operatorToken.text() == "min") {
+            reduction = ast::ReductionKind::Min;
+        } else if(operatorToken.kind() == TokenKind::ID && operatorToken.text() == "max") {
+            reduction = ast::ReductionKind::Max;
+        } else {
+            errorStream_.error(
+                error::ErrorKind::UnexpectedToken,
+                operatorToken.span(),
+                "Expected '+', '*', 'min' or 'max'");
+            throw ParseAbortedException();
+        }
+        consumeCloseParen();
+        return reduction;
+    }
+
+    /** Parses "vectorize" and "unroll(n)", in any order, where n is a positive literal int. */
+    ast::LoopHints parseLoopHints() {
+        ast::LoopHints hints;
+        while(true) {
+            if(consumeOptional(TokenKind::KW_VECTORIZE)) {
+                hints.vectorize = true;
+            } else if(consumeOptional(TokenKind::KW_UNROLL)) {
+                consumeOpenParen();
+                Token &countToken = consume(TokenKind::LIT_INT, "literal int");
+                if(countToken.intValue() <= 0) {
+                    errorStream_.error(
+                        error::ErrorKind::InvalidUnrollCount,
+                        countToken.span(),
+                        "The unroll count must be greater than zero");
+                    throw ParseAbortedException();
+                }
+                hints.unrollCount = (unsigned)countToken.intValue();
+                consumeCloseParen();
+            } else {
+                return hints;
+            }
+        }
+    }
+
     /** retval.first is parsed list of argument exprs, retval.second is the closing ')' */
     std::pair<gc_ref_vector<ast::ExprStmt>, std::reference_wrapper<Token>> parseFuncCallArguments() {
         gc_ref_vector<ast::ExprStmt> arguments;
@@ -325,19 +493,47 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
             } while(closeParen->kind() != TokenKind::CLOSE_PAREN);
         }
 
+        ast::FloatingPointMode floatingPointMode = ast::FloatingPointMode::Default;
+        if(consumeOptional(TokenKind::KW_FPMODE)) {
+            floatingPointMode = parseFloatingPointMode();
+        }
+
         storageKindStack_.push(scope::StorageKind::Local);
         ast::ExprStmt &funcBody = parseExpr();
         storageKindStack_.pop();
 
         return *new ast::FuncDefStmt(
             makeSourceSpan(funcKeyword.span(), funcBody.sourceSpan()),
-            ast::Identifier(identifier.span(), identifier.text()),
+            ast::Identifier(identifier.span(), identifier.atom()),
             returnTypeRef,
             parameters,
-            funcBody
+            funcBody,
+            floatingPointMode
         );
     }
 
+    /** Parses "(precise)", "(contract)" or "(fast)". */
+    ast::FloatingPointMode parseFloatingPointMode() {
+        consumeOpenParen();
+        Token &modeToken = lexer_.nextToken();
+        ast::FloatingPointMode mode;
+        if(modeToken.kind() == TokenKind::ID && modeToken.text() == "precise") {
+            mode = ast::FloatingPointMode::Precise;
+        } else if(modeToken.kind() == TokenKind::ID && modeToken.text() == "contract") {
+            mode = ast::FloatingPointMode::Contract;
+        } else if(modeToken.kind() == TokenKind::ID && modeToken.text() == "fast") {
+            mode = ast::FloatingPointMode::Fast;
+        } else {
+            errorStream_.error(
+                error::ErrorKind::UnexpectedToken,
+                modeToken.span(),
+                "Expected 'precise', 'contract' or 'fast'");
+            throw ParseAbortedException();
+        }
+        consumeCloseParen();
+        return mode;
+    }
+
     ast::ExprStmt &parseClassDefinition(Token &classKeyword) {
         auto className = consumeIdentifier();
         TemplateParameterVector genericClassParameters = parseTemplateParameters(TemplateParameterRequirement::Optional);
@@ -350,7 +546,7 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
 
         ast::ExprStmt &classBody = parseExpr();
 
-        auto *compoundExpr = dynamic_cast<ast::CompoundExpr*>(&classBody);
+        auto *compoundExpr = tryUpcast<ast::CompoundExpr>(&classBody);
         if(!compoundExpr) {
             gc_ref_vector<ast::ExprStmt> stmts;
             stmts.emplace_back(classBody);
@@ -400,6 +596,21 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
             cond);
     }
 
+    ast::ExprStmt &parseSpawn(Token &spawnKeyword) {
+        //Binds as tightly as a prefix operator, so that only f(x) is spawned in "spawn f(x) + 1".
+        ast::ExprStmt &callExpr = parseExpr(getOperatorPrecedence(TokenKind::OP_NOT));
+
+        return *new ast::SpawnExpr(makeSourceSpan(spawnKeyword.span(), callExpr.sourceSpan()), callExpr);
+    }
+
+    ast::ExprStmt &parseJoin(Token &joinKeyword) {
+        consumeOpenParen();
+        ast::ExprStmt &taskExpr = parseExpr();
+        Token &closeParen = consumeCloseParen();
+
+        return *new ast::JoinExpr(makeSourceSpan(joinKeyword.span(), closeParen.span()), taskExpr);
+    }
+
     ast::ExprStmt &parseNamespace(Token &namespaceKeyword) {
         ast::MultiPartIdentifier namespaceId = parseQualifiedIdentifier();
         auto &body = upcast<ast::ExpressionList>(parseExpressionList());
@@ -493,6 +704,17 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
         );
     }
 
+    ast::ExprStmt &parseIndexExpr(ast::ExprStmt &arrayExpr, Token &openSquare) {
+        ast::ExprStmt &indexExpr = parseExpr();
+        Token &closeSquare = consumeCloseSquare();
+
+        return *new ast::IndexExpr(
+            makeSourceSpan(arrayExpr.sourceSpan(), closeSquare.span()),
+            openSquare.span(),
+            arrayExpr,
+            indexExpr);
+    }
+
     ast::ExprStmt &parseBinaryExpr(ast::ExprStmt &lValue, Token &operatorToken);
 
     Associativity getOperatorAssociativity(TokenKind kind);
@@ -500,54 +722,75 @@ class AnodeParser : public PrattParser<ast::ExprStmt> {
 
 public:
 
-    AnodeParser(AnodeLexer &lexer, error::ErrorStream &errorStream) : PrattParser(lexer, errorStream) {
-        //Prefix parselets
-        registerGenericParselet(TokenKind::LIT_INT, std::bind(&AnodeParser::parseLiteralInt32, this, _1));
-        registerGenericParselet(TokenKind::LIT_FLOAT, std::bind(&AnodeParser::parseLiteralFloat, this, _1));
-        registerGenericParselet(TokenKind::KW_TRUE, std::bind(&AnodeParser::parseLiteralBool, this, _1));
-        registerGenericParselet(TokenKind::KW_FALSE, std::bind(&AnodeParser::parseLiteralBool, this, _1));
-        registerGenericParselet(TokenKind::ID, std::bind(&AnodeParser::parseVariableRef, this, _1));
-
-        registerGenericParselet(TokenKind::OP_NOT, std::bind(&AnodeParser::parsePrefixUnaryExpr, this, _1));
-        registerGenericParselet(TokenKind::OP_INC, std::bind(&AnodeParser::parsePrefixUnaryExpr, this, _1));
-        registerGenericParselet(TokenKind::OP_DEC, std::bind(&AnodeParser::parsePrefixUnaryExpr, this, _1));
-
-        registerGenericParselet(TokenKind::OPEN_CURLY, std::bind(&AnodeParser::parseCompoundStmt, this, _1));
-        registerGenericParselet(TokenKind::OPEN_PAREN, std::bind(&AnodeParser::parseParensExpr, this, _1));
-        registerGenericParselet(TokenKind::KW_CAST, std::bind(&AnodeParser::parseCastExpr, this, _1));
-        registerGenericParselet(TokenKind::KW_NEW, std::bind(&AnodeParser::parseNewExpr, this, _1));
-        registerGenericParselet(TokenKind::OP_COND, std::bind(&AnodeParser::parseConditional, this, _1));
-        registerGenericParselet(TokenKind::KW_IF, std::bind(&AnodeParser::parseIfExpr, this, _1));
-        registerGenericParselet(TokenKind::KW_WHILE, std::bind(&AnodeParser::parseWhile, this, _1));
-        registerGenericParselet(TokenKind::KW_FUNC, std::bind(&AnodeParser::parseFuncDef, this, _1));
-        registerGenericParselet(TokenKind::KW_CLASS, std::bind(&AnodeParser::parseClassDefinition, this, _1));
-        registerGenericParselet(TokenKind::KW_ASSERT, std::bind(&AnodeParser::parseAssert, this, _1));
-        registerGenericParselet(TokenKind::KW_NAMESPACE, std::bind(&AnodeParser::parseNamespace, this, _1));
-        registerGenericParselet(TokenKind::KW_TEMPLATE, std::bind(&AnodeParser::parseTemplate, this, _1));
-        registerGenericParselet(TokenKind::KW_EXPAND, std::bind(&AnodeParser::parseExpand, this, _1));
-
-        //Infix parselets
-        registerInfixParselet(TokenKind::OP_ADD, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_SUB, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_MUL, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_DIV, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_EQ, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_NEQ, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_GT, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_GTE, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_LT, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_LTE, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_LAND, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_LOR, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_ASSIGN, std::bind(&AnodeParser::parseBinaryExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OP_DOT, std::bind(&AnodeParser::parseDotExpr, this, _1, _2));
-        registerInfixParselet(TokenKind::OPEN_PAREN, std::bind(&AnodeParser::parseFuncCallExpr, this, _1, _2));
-    }
+    /** Built the first time an AnodeParser is created and shared by all instances thereafter. */
+    static const ParseletTable &parseletTable() {
+        static const ParseletTable parselets = [] {
+            ParseletTable table;
+            //Prefix parselets
+            table.registerGenericParselet(TokenKind::LIT_INT, &AnodeParser::parseLiteralInt32);
+            table.registerGenericParselet(TokenKind::LIT_FLOAT, &AnodeParser::parseLiteralFloat);
+            table.registerGenericParselet(TokenKind::KW_TRUE, &AnodeParser::parseLiteralBool);
+            table.registerGenericParselet(TokenKind::KW_FALSE, &AnodeParser::parseLiteralBool);
+            table.registerGenericParselet(TokenKind::ID, &AnodeParser::parseVariableRef);
+
+            table.registerGenericParselet(TokenKind::OP_NOT, &AnodeParser::parsePrefixUnaryExpr);
+            table.registerGenericParselet(TokenKind::OP_INC, &AnodeParser::parsePrefixUnaryExpr);
+            table.registerGenericParselet(TokenKind::OP_DEC, &AnodeParser::parsePrefixUnaryExpr);
+
+            table.registerGenericParselet(TokenKind::OPEN_CURLY, &AnodeParser::parseCompoundStmt);
+            table.registerGenericParselet(TokenKind::OPEN_PAREN, &AnodeParser::parseParensExpr);
+            table.registerGenericParselet(TokenKind::KW_CAST, &AnodeParser::parseCastExpr);
+            table.registerGenericParselet(TokenKind::KW_NEW, &AnodeParser::parseNewExpr);
+            table.registerGenericParselet(TokenKind::OP_COND, &AnodeParser::parseConditional);
+            table.registerGenericParselet(TokenKind::KW_IF, &AnodeParser::parseIfExpr);
+            table.registerGenericParselet(TokenKind::KW_WHILE, &AnodeParser::parseWhile);
+            table.registerGenericParselet(TokenKind::KW_FOR, &AnodeParser::parseFor);
+            table.registerGenericParselet(TokenKind::KW_PARALLEL, &AnodeParser::parseParallelFor);
+            table.registerGenericParselet(TokenKind::KW_REDUCE, &AnodeParser::parseReduceLanes);
+            table.registerGenericParselet(TokenKind::KW_FUNC, &AnodeParser::parseFuncDef);
+            table.registerGenericParselet(TokenKind::KW_CLASS, &AnodeParser::parseClassDefinition);
+            table.registerGenericParselet(TokenKind::KW_ASSERT, &AnodeParser::parseAssert);
+            table.registerGenericParselet(TokenKind::KW_SPAWN, &AnodeParser::parseSpawn);
+            table.registerGenericParselet(TokenKind::KW_JOIN, &AnodeParser::parseJoin);
+            table.registerGenericParselet(TokenKind::KW_NAMESPACE, &AnodeParser::parseNamespace);
+            table.registerGenericParselet(TokenKind::KW_TEMPLATE, &AnodeParser::parseTemplate);
+            table.registerGenericParselet(TokenKind::KW_EXPAND, &AnodeParser::parseExpand);
+
+            //Infix parselets
+            table.registerInfixParselet(TokenKind::OP_ADD, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_SUB, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_MUL, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_DIV, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_EQ, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_NEQ, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_GT, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_GTE, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_LT, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_LTE, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_LAND, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_LOR, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_ASSIGN, &AnodeParser::parseBinaryExpr);
+            table.registerInfixParselet(TokenKind::OP_DOT, &AnodeParser::parseDotExpr);
+            table.registerInfixParselet(TokenKind::OPEN_PAREN, &AnodeParser::parseFuncCallExpr);
+            table.registerInfixParselet(TokenKind::OPEN_SQUARE, &AnodeParser::parseIndexExpr);
+            return table;
+        }();
+        return parselets;
+    }
+
+    AnodeParser(AnodeLexer &lexer, error::ErrorStream &errorStream) : PrattParser(lexer, errorStream, parseletTable()) { }
 
     ast::Module &parseModule() {
         storageKindStack_.push(scope::StorageKind::Global);
-        gc_ref_vector<ast::ExprStmt> exprs;
 
+        //import some::library
+        //Imports must precede all other statements.
+        std::vector<ast::MultiPartIdentifier> imports;
+        while(consumeOptional(TokenKind::KW_IMPORT)) {
+            imports.emplace_back(parseQualifiedIdentifier());
+        }
+
+        gc_ref_vector<ast::ExprStmt> exprs;
         while(!lexer_.eof()) {
             exprs.emplace_back(parseExpr());
         }
@@ -557,7 +800,7 @@ public:
         ASSERT(storageKindStack_.size() == 1);
         storageKindStack_.pop();
 
-        return *new ast::Module(lexer_.inputName(), body);
+        return *new ast::Module(lexer_.inputName(), body, imports);
     }
 };
 
@@ -3,18 +3,12 @@
 #include "front/ast.h"
 #include "front/parse.h"
 
+#include <array>
+
 #pragma once
 
 namespace anode { namespace front { namespace parser {
 
-/** Defines a function signature which is invoked by PrattParser when it encounters a specific symbol.
- * Such as a prefix operator (i.e. ++i), or a keyword (i.e. 'if' or 'while') to parse the appropriate language construct.
- */
-typedef std::function<ast::ExprStmt&(Token&)> generic_parselet_t;
-
-/** Like generic_parselet_t, but for parsing infix expressions (a.k.a binary expressions, i.e. 1 + 1). */
-typedef std::function<ast::ExprStmt&(ast::ExprStmt&, Token&)> infix_parselet_t;
-
 /** Operator associativity. */
 enum class Associativity {
     Left,
@@ -25,34 +19,58 @@ enum class Associativity {
 /** A basic Pratt Parser.
  * http://journal.stuffwithstuff.com/2011/03/19/pratt-parsers-expression-parsing-made-easy/
  *
+ * Parselets are member functions of TParser, which must derive from this class, and are invoked directly through member
+ * function pointers.
+ *
  * @tparam TExpression
+ * @tparam TParser
  */
-template<typename TExpression>
+template<typename TExpression, typename TParser>
 class PrattParser {
-    gc_vector<generic_parselet_t> genericParsers_;
-    gc_vector<infix_parselet_t> infixParsers_;
+public:
+    /** Invoked when a specific token is encountered at the start of an expression.  Such as a prefix operator (i.e. ++i),
+     * or a keyword (i.e. 'if' or 'while') to parse the appropriate language construct.
+     */
+    typedef TExpression &(TParser::*generic_parselet_t)(Token &);
+
+    /** Like generic_parselet_t, but for parsing infix expressions (a.k.a binary expressions, i.e. 1 + 1). */
+    typedef TExpression &(TParser::*infix_parselet_t)(TExpression &, Token &);
+
+    /**
+     * The parselets of each TokenKind.  This does not depend on the state of any parser, so one table can be built once
+     * and shared by every instance of TParser, including those on other threads.
+     */
+    class ParseletTable {
+        std::array<generic_parselet_t, (size_t)TokenKind::MAX_TOKEN_TYPES> genericParselets_{};
+        std::array<infix_parselet_t, (size_t)TokenKind::MAX_TOKEN_TYPES> infixParselets_{};
+    public:
+        void registerGenericParselet(TokenKind tokenKind, generic_parselet_t parselet) {
+            if(genericParselets_[(size_t)tokenKind] != nullptr) {
+                ASSERT_FAIL("Specified tokenKind already has a generic parselet.")
+            }
+            genericParselets_[(size_t)tokenKind] = parselet;
+        }
+
+        void registerInfixParselet(TokenKind tokenKind, infix_parselet_t parselet) {
+            if(infixParselets_[(size_t)tokenKind] != nullptr) {
+                ASSERT_FAIL("Specified tokenKind already has an infix parselet.")
+            }
+            infixParselets_[(size_t)tokenKind] = parselet;
+        }
+
+        generic_parselet_t genericParselet(TokenKind tokenKind) const { return genericParselets_[(size_t)tokenKind]; }
+        infix_parselet_t infixParselet(TokenKind tokenKind) const { return infixParselets_[(size_t)tokenKind]; }
+    };
+
+private:
+    const ParseletTable &parselets_;
 
 protected:
     error::ErrorStream &errorStream_;
     AnodeLexer &lexer_;
 
-    PrattParser (AnodeLexer &lexer, error::ErrorStream &errorStream) : errorStream_{errorStream}, lexer_{lexer} {
-        genericParsers_.resize((int) TokenKind::MAX_TOKEN_TYPES, generic_parselet_t());
-        infixParsers_.resize((int)TokenKind::MAX_TOKEN_TYPES, infix_parselet_t());
-    }
-
-    void registerGenericParselet(TokenKind tokenKind, generic_parselet_t parselet) {
-        if(genericParsers_[(int)tokenKind] != nullptr) {
-            ASSERT_FAIL("Specified tokenKind already exists in genericParsers_.")
-        }
-        genericParsers_[(int)tokenKind] = parselet;
-    }
-
-    void registerInfixParselet(TokenKind tokenKind, infix_parselet_t parselet) {
-        if(infixParsers_[(int)tokenKind] != nullptr) {
-            ASSERT_FAIL("Specified tokenKind already exists in infixParsers_.")
-        }
-        infixParsers_[(int)tokenKind] = parselet;
+    PrattParser (AnodeLexer &lexer, error::ErrorStream &errorStream, const ParseletTable &parselets)
+        : parselets_{parselets}, errorStream_{errorStream}, lexer_{lexer} {
     }
 
     Token &consume(TokenKind tokenKind, char_t expectedCharacter) {
@@ -124,7 +142,7 @@ protected:
 
         const char *message = "The token '%s' came as a complete surprise to me.";
 
-        auto foundPrefixParselet = genericParsers_[(int)t->kind()];
+        generic_parselet_t foundPrefixParselet = parselets_.genericParselet(t->kind());
         if(foundPrefixParselet == nullptr) {
             errorStream_.error(
                 error::ErrorKind::SurpriseToken,
@@ -134,7 +152,8 @@ protected:
             throw ParseAbortedException();
         }
 
-        ast::ExprStmt *left = &foundPrefixParselet(*t);
+        TParser &self = static_cast<TParser&>(*this);
+        TExpression *left = &(self.*foundPrefixParselet)(*t);
 
         t = &lexer_.peekToken();
         if(t->kind() == TokenKind::END_OF_INPUT) {
@@ -143,16 +162,17 @@ protected:
 
         while(precedence < getOperatorPrecedence(t->kind())) {
             lexer_.nextToken();
-            auto &&foundInfixParselet = infixParsers_[(int)t->kind()];
+            infix_parselet_t foundInfixParselet = parselets_.infixParselet(t->kind());
             if(foundInfixParselet == nullptr) {
                 errorStream_.error(
                     error::ErrorKind::SurpriseToken,
                     t->span(),
                     message,
                     t->text().c_str());
+                throw ParseAbortedException();
             }
 
-            left = &foundInfixParselet(*left, *t);
+            left = &(self.*foundInfixParselet)(*left, *t);
 
             t = &lexer_.peekToken();
             if(t->kind() == TokenKind::END_OF_INPUT) {
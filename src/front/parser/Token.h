@@ -3,6 +3,7 @@
 #pragma once
 
 #include "front/source.h"
+#include "front/atom.h"
 #include "char.h"
 
 namespace anode { namespace front { namespace parser {
@@ -35,10 +36,13 @@ enum class TokenKind : unsigned short {
     OP_DEC,
     OP_COND,
     OP_NAMESPACE,
+    OP_RANGE,
     OPEN_PAREN,
     CLOSE_PAREN,
     OPEN_CURLY,
     CLOSE_CURLY,
+    OPEN_SQUARE,
+    CLOSE_SQUARE,
     COMMA,
     ID,
     LIT_INT,
@@ -57,25 +61,38 @@ enum class TokenKind : unsigned short {
     KW_TEMPLATE,
     KW_EXPAND,
     KW_NAMESPACE,
+    KW_IMPORT,
+    KW_SPAWN,
+    KW_JOIN,
+    KW_FOR,
+    KW_IN,
+    KW_PARALLEL,
+    KW_REDUCE,
+    KW_VECTORIZE,
+    KW_UNROLL,
+    KW_FPMODE,
     MAX_TOKEN_TYPES
 };
 
 class Token : public gc {
     const source::SourceSpan span_;
     const TokenKind kind_;
-    const string_t text_;
+    const Atom text_;
 public:
-    Token(source::SourceSpan span, TokenKind kind, string_t text) : span_{span}, kind_{kind}, text_{text} { }
+    Token(source::SourceSpan span, TokenKind kind, const string_t &text) : span_{span}, kind_{kind}, text_{text} { }
 
     const source::SourceSpan &span() const { return span_; }
 
     TokenKind kind() const { return kind_; }
 
-    string_t text() const { return text_; }
+    const string_t &text() const { return text_.text(); }
 
-    int intValue() { return std::stoi(text_); }
-    float floatValue() { return std::stof(text_); }
-    bool boolValue() { return text_.front() == 't'; }
+    /** The interned text of the token. */
+    Atom atom() const { return text_; }
+
+    int intValue() { return std::stoi(text_.text()); }
+    float floatValue() { return std::stof(text_.text()); }
+    bool boolValue() { return text_.text().front() == 't'; }
 };
 
 
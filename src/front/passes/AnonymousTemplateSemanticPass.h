@@ -16,7 +16,7 @@ public:
     void visitingAnonymousTemplateExprStmt(ast::AnonymousTemplateExprStmt &exprStmt) override {
         auto &bodyExprs = exprStmt.body().expressions();
         for(ast::ExprStmt &expr : bodyExprs) {
-            if (dynamic_cast<ast::GenericClassDefinition *>(&expr)) {
+            if (tryUpcast<ast::GenericClassDefinition>(&expr)) {
                 continue;
             }
             //TODO:  allow GenericFunctionDefinitions or whatever, once they exist.
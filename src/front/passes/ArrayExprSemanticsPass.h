@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ErrorContextAstVisitor.h"
+
+namespace anode { namespace front  { namespace passes {
+
+/**
+ * Checks that only arrays and vectors are indexed, that the indexes and lengths of arrays are ints and that literal lane
+ * indexes are within the bounds of their vectors.
+ */
+class ArrayExprSemanticsPass : public ErrorContextAstVisitor {
+public:
+    explicit ArrayExprSemanticsPass(error::ErrorStream &errorStream) : ErrorContextAstVisitor(errorStream) { }
+
+    void visitedNewExpr(ast::NewExpr &newExpr) override {
+        if(newExpr.isArray() && !isInt(*newExpr.lengthExpr())) {
+            errorStream_.error(
+                error::ErrorKind::ArrayLengthIsNotInt,
+                newExpr.lengthExpr()->sourceSpan(),
+                "The length of an array must be an int but was '%s'.",
+                newExpr.lengthExpr()->exprType().nameForDisplay().c_str());
+        }
+    }
+
+    void visitedIndexExpr(ast::IndexExpr &indexExpr) override {
+        type::Type &arrayType = indexExpr.arrayExpr().exprType();
+        auto vectorType = tryUpcast<type::VectorType>(arrayType.actualType());
+        if(!vectorType && !isInstanceOf<type::ArrayType>(arrayType.actualType())) {
+            errorStream_.error(
+                error::ErrorKind::IndexedExpressionIsNotArray,
+                indexExpr.openBracketSpan(),
+                "Cannot index a value of type '%s' which is not an array or vector.",
+                arrayType.nameForDisplay().c_str());
+            return;
+        }
+        if(!isInt(indexExpr.indexExpr())) {
+            errorStream_.error(
+                error::ErrorKind::ArrayIndexIsNotInt,
+                indexExpr.indexExpr().sourceSpan(),
+                "The index of an array element must be an int but was '%s'.",
+                indexExpr.indexExpr().exprType().nameForDisplay().c_str());
+            return;
+        }
+        auto literalIndex = tryUpcast<ast::LiteralInt32Expr>(&indexExpr.indexExpr());
+        if(vectorType && literalIndex && (literalIndex->value() < 0 || (unsigned)literalIndex->value() >= vectorType->laneCount())) {
+            errorStream_.error(
+                error::ErrorKind::LaneIndexOutOfRange,
+                literalIndex->sourceSpan(),
+                "Lane %d is out of range for a '%s', which has %d lanes.",
+                literalIndex->value(),
+                vectorType->nameForDisplay().c_str(),
+                vectorType->laneCount());
+        }
+    }
+
+private:
+    static bool isInt(ast::ExprStmt &expr) {
+        return expr.exprType().isSameType(type::ScalarType::Int32);
+    }
+};
+
+}}}
@@ -9,6 +9,16 @@ public:
 
     void visitedBinaryExpr(ast::BinaryExpr &binaryExpr) override {
         if(binaryExpr.isComparison()) {
+            //Comparing vectors would yield a vector of bools, which doesn't exist.
+            type::Type &operandType = binaryExpr.lValue().exprType();
+            if(isInstanceOf<type::VectorType>(operandType.actualType())) {
+                errorStream_.error(
+                    error::ErrorKind::OperatorCannotBeUsedWithType,
+                    binaryExpr.operatorSpan(),
+                    "Operator '%s' cannot be used with type '%s'.",
+                    ast::to_string(binaryExpr.operation()).c_str(),
+                    operandType.nameForDisplay().c_str());
+            }
             return;
         }
         if(binaryExpr.operation() == ast::BinaryOperationKind::Assign) {
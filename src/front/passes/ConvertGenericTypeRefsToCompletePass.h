@@ -41,7 +41,7 @@ public:
 
             typeRef.setType(*expandedType);
 
-        } else if(typeRef.hasTemplateArguments()) {
+        } else if(typeRef.hasTemplateArguments() && !isInstanceOf<type::TaskType>(typeRef.type().actualType())) {
             errorStream_.error(
                 error::ErrorKind::TypeIsNotGenericButIsReferencedWithGenericArgs,
                 typeRef.sourceSpan(),
@@ -9,18 +9,27 @@
 namespace anode { namespace front { namespace passes {
 
 class ErrorContextAstVisitor : public ast::AstVisitor {
+    bool pushesErrorContext_ = true;
 protected:
     error::ErrorStream &errorStream_;
 
     ErrorContextAstVisitor(error::ErrorStream &errorStream) : errorStream_{errorStream} { }
 public:
 
+    /** When fused with other passes into a FusedAstVisitor, the FusedAstVisitor manages the error context instead so that
+     * it is not shown once for each pass. */
+    void setPushesErrorContext(bool pushesErrorContext) { pushesErrorContext_ = pushesErrorContext; }
+
     void visitingTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &expansion) override {
-        errorStream_.pushContextMessage("While inside template expansion at: " + expansion.sourceSpan().toString());
+        if(pushesErrorContext_) {
+            errorStream_.pushContextMessage("While inside template expansion at: " + expansion.sourceSpan().toString());
+        }
     }
 
     void visitedTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &) override {
-        errorStream_.popContextMessage();
+        if(pushesErrorContext_) {
+            errorStream_.popContextMessage();
+        }
     }
 };
 }}}
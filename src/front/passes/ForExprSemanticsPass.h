@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ErrorContextAstVisitor.h"
+
+namespace anode { namespace front  { namespace passes {
+
+/**
+ * Checks that the bounds of for loops are ints, that only numeric values are reduced and that loop variables are not
+ * assigned.  The back end relies on the latter to split the range of a parallel for into chunks.
+ */
+class ForExprSemanticsPass : public ErrorContextAstVisitor {
+    gc_unordered_set<scope::Symbol*> loopVariables_;
+public:
+    explicit ForExprSemanticsPass(error::ErrorStream &errorStream) : ErrorContextAstVisitor(errorStream) { }
+
+    void visitingForExpr(ast::ForExpr &forExpr) override {
+        if(forExpr.inductionVar().symbol()) {
+            loopVariables_.emplace(forExpr.inductionVar().symbol());
+        }
+    }
+
+    void visitedForExpr(ast::ForExpr &forExpr) override {
+        checkRangeBound(forExpr.rangeBegin());
+        checkRangeBound(forExpr.rangeEnd());
+
+        if(forExpr.reduction() != ast::ReductionKind::None && !forExpr.body().exprType().canDoArithmetic()) {
+            errorStream_.error(
+                error::ErrorKind::ReducedExpressionIsNotNumeric,
+                forExpr.body().sourceSpan(),
+                "Cannot reduce values of type '%s'.",
+                forExpr.body().exprType().nameForDisplay().c_str());
+        }
+    }
+
+    void visitedBinaryExpr(ast::BinaryExpr &binaryExpr) override {
+        if(binaryExpr.operation() == ast::BinaryOperationKind::Assign) {
+            checkNotLoopVariable(binaryExpr.lValue());
+        }
+    }
+
+    void visitedUnaryExpr(ast::UnaryExpr &unaryExpr) override {
+        if(unaryExpr.operation() != ast::UnaryOperationKind::Not) {
+            checkNotLoopVariable(unaryExpr.valueExpr());
+        }
+    }
+
+private:
+    void checkRangeBound(ast::ExprStmt &bound) {
+        if(bound.exprType().primitiveType() != type::PrimitiveType::Int32) {
+            errorStream_.error(
+                error::ErrorKind::RangeBoundIsNotInt,
+                bound.sourceSpan(),
+                "The bounds of a range must be of type 'int' but this is of type '%s'.",
+                bound.exprType().nameForDisplay().c_str());
+        }
+    }
+
+    void checkNotLoopVariable(ast::ExprStmt &expr) {
+        auto variableRef = tryUpcast<ast::VariableRefExpr>(expr);
+        if(variableRef && loopVariables_.count(variableRef->symbol()) > 0) {
+            errorStream_.error(
+                error::ErrorKind::CannotAssignToLoopVariable,
+                expr.sourceSpan(),
+                "Cannot assign a value to the loop variable '%s'.",
+                variableRef->name().qualifedName().c_str());
+        }
+    }
+};
+
+}}}
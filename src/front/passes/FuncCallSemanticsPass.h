@@ -19,7 +19,7 @@ public:
             return;
         }
 
-        auto *funcType = dynamic_cast<type::FunctionType*>(&funcCallExpr.funcExpr().exprType());
+        auto *funcType = tryUpcast<type::FunctionType>(&funcCallExpr.funcExpr().exprType());
         ASSERT(funcType);
 
         //When we do function overloading, this is going to get a whole lot more complicated.
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "ErrorContextAstVisitor.h"
+#include "common/stats.h"
+
+#include <string>
+#include <vector>
+
+namespace anode { namespace front  { namespace passes {
+
+/**
+ * Runs several passes during a single traversal of the AST.  At each node, the visiting* and visited* member functions of
+ * every member pass are invoked in the order in which the passes were added.
+ *
+ * This is only equivalent to running the passes one after the other if no member pass depends on something another member
+ * pass does to a node that is visited later in the traversal.  Use PassPipeline to build FusedAstVisitors from passes with
+ * declared dependencies instead of creating them directly.
+ *
+ * As when the passes are run one after the other, a pass which reports an error stops the passes added after it from
+ * running at all from then on, since they may depend on the success of that pass.  The pass which reported the error and
+ * those added before it complete the traversal.
+ *
+ * When statistics are enabled, the time spent in each member pass's visiting* and visited* member functions is measured
+ * separately and reported by recordStatistics() as "front.pass.<name>".
+ */
+class FusedAstVisitor : public ErrorContextAstVisitor {
+    gc_ref_vector<ast::AstVisitor> passes_;
+    std::vector<std::string> passNames_;
+    std::vector<stats::clock::duration> passTimes_;
+    bool collectStatistics_ = stats::global().enabled();
+    //The number of passes, in the order in which they were added, which still run.
+    size_t runningPassCount_ = 0;
+
+    template<typename TNode>
+    void forEachPass(void (ast::AstVisitor::*memberFunction)(TNode &), TNode &node) {
+        for(size_t i = 0; i < runningPassCount_; ++i) {
+            if(!collectStatistics_) {
+                (passes_[i].get().*memberFunction)(node);
+            } else {
+                auto start = stats::clock::now();
+                (passes_[i].get().*memberFunction)(node);
+                passTimes_[i] += stats::clock::now() - start;
+            }
+            if(errorStream_.errorCount() > 0) {
+                runningPassCount_ = i + 1;
+            }
+        }
+    }
+
+public:
+    explicit FusedAstVisitor(error::ErrorStream &errorStream) : ErrorContextAstVisitor(errorStream) { }
+
+    void addPass(ast::AstVisitor &pass, const std::string &name) {
+        if(auto errorContextPass = dynamic_cast<ErrorContextAstVisitor*>(&pass)) {
+            errorContextPass->setPushesErrorContext(false);
+        }
+        passes_.emplace_back(pass);
+        passNames_.emplace_back(name);
+        passTimes_.emplace_back(stats::clock::duration::zero());
+        runningPassCount_ = passes_.size();
+    }
+
+    const gc_ref_vector<ast::AstVisitor> &passes() const { return passes_; }
+
+    void pushStartingScope(scope::SymbolTable &startingSymbolTable) override {
+        for(ast::AstVisitor &pass : passes_) {
+            pass.pushStartingScope(startingSymbolTable);
+        }
+    }
+
+    /** Adds the time measured for each pass since the last call to the global statistics. */
+    void recordStatistics() {
+        if(!collectStatistics_) return;
+        for(size_t i = 0; i < passes_.size(); ++i) {
+            stats::global().addTiming("front.pass." + passNames_[i], passTimes_[i]);
+            passTimes_[i] = stats::clock::duration::zero();
+        }
+    }
+
+    bool shouldVisitChildren() override {
+        ASSERT(!passes_.empty());
+        bool shouldVisit = passes_.front().get().shouldVisitChildren();
+        for(ast::AstVisitor &pass : passes_) {
+            ASSERT(pass.shouldVisitChildren() == shouldVisit && "Passes which disagree about visiting children cannot be fused.");
+        }
+        return shouldVisit;
+    }
+
+    void visitingTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &expansion) override {
+        ErrorContextAstVisitor::visitingTemplateExpansionExprStmt(expansion);
+        forEachPass(&ast::AstVisitor::visitingTemplateExpansionExprStmt, expansion);
+    }
+
+    void visitedTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &expansion) override {
+        forEachPass(&ast::AstVisitor::visitedTemplateExpansionExprStmt, expansion);
+        ErrorContextAstVisitor::visitedTemplateExpansionExprStmt(expansion);
+    }
+
+#define FUSE_VISIT(memberFunction, NodeType) \
+    void memberFunction(ast::NodeType &node) override { \
+        forEachPass(&ast::AstVisitor::memberFunction, node); \
+    }
+
+    FUSE_VISIT(visitingParameterDef, ParameterDef)
+    FUSE_VISIT(visitedParameterDef, ParameterDef)
+    FUSE_VISIT(visitingFuncDefStmt, FuncDefStmt)
+    FUSE_VISIT(visitedFuncDeclStmt, FuncDefStmt)
+    FUSE_VISIT(visitingFuncCallExpr, FuncCallExpr)
+    FUSE_VISIT(visitedFuncCallExpr, FuncCallExpr)
+    FUSE_VISIT(visitingGenericClassDefinition, GenericClassDefinition)
+    FUSE_VISIT(visitedGenericClassDefinition, GenericClassDefinition)
+    FUSE_VISIT(visitingCompleteClassDefinition, CompleteClassDefinition)
+    FUSE_VISIT(visitedCompleteClassDefinition, CompleteClassDefinition)
+    FUSE_VISIT(visitingAssertExprStmt, AssertExprStmt)
+    FUSE_VISIT(visitedAssertExprStmt, AssertExprStmt)
+    FUSE_VISIT(visitingVariableDeclExpr, VariableDeclExpr)
+    FUSE_VISIT(visitedVariableDeclExpr, VariableDeclExpr)
+    FUSE_VISIT(visitingIfExpr, IfExprStmt)
+    FUSE_VISIT(visitedIfExpr, IfExprStmt)
+    FUSE_VISIT(visitingWhileExpr, WhileExpr)
+    FUSE_VISIT(visitedWhileExpr, WhileExpr)
+    FUSE_VISIT(visitingForExpr, ForExpr)
+    FUSE_VISIT(visitedForExpr, ForExpr)
+    FUSE_VISIT(visitingBinaryExpr, BinaryExpr)
+    FUSE_VISIT(visitedBinaryExpr, BinaryExpr)
+    FUSE_VISIT(visitingUnaryExpr, UnaryExpr)
+    FUSE_VISIT(visitedUnaryExpr, UnaryExpr)
+    FUSE_VISIT(visitLiteralBoolExpr, LiteralBoolExpr)
+    FUSE_VISIT(visitLiteralInt32Expr, LiteralInt32Expr)
+    FUSE_VISIT(visitLiteralFloatExpr, LiteralFloatExpr)
+    FUSE_VISIT(visitVariableRefExpr, VariableRefExpr)
+    FUSE_VISIT(visitMethodRefExpr, MethodRefExpr)
+    FUSE_VISIT(visitingCastExpr, CastExpr)
+    FUSE_VISIT(visitedCastExpr, CastExpr)
+    FUSE_VISIT(visitingNewExpr, NewExpr)
+    FUSE_VISIT(visitedNewExpr, NewExpr)
+    FUSE_VISIT(visitingDotExpr, DotExpr)
+    FUSE_VISIT(visitedDotExpr, DotExpr)
+    FUSE_VISIT(visitingSpawnExpr, SpawnExpr)
+    FUSE_VISIT(visitedSpawnExpr, SpawnExpr)
+    FUSE_VISIT(visitingJoinExpr, JoinExpr)
+    FUSE_VISIT(visitedJoinExpr, JoinExpr)
+    FUSE_VISIT(visitingIndexExpr, IndexExpr)
+    FUSE_VISIT(visitedIndexExpr, IndexExpr)
+    FUSE_VISIT(visitingIntrinsicCallExpr, IntrinsicCallExpr)
+    FUSE_VISIT(visitedIntrinsicCallExpr, IntrinsicCallExpr)
+    FUSE_VISIT(visitingCompoundExpr, CompoundExpr)
+    FUSE_VISIT(visitedCompoundExpr, CompoundExpr)
+    FUSE_VISIT(visitingExpressionList, ExpressionList)
+    FUSE_VISIT(visitedExpressionList, ExpressionList)
+    FUSE_VISIT(visitingNamespaceExpr, NamespaceExpr)
+    FUSE_VISIT(visitedNamespaceExpr, NamespaceExpr)
+    FUSE_VISIT(visitingNamedTemplateExprStmt, NamedTemplateExprStmt)
+    FUSE_VISIT(visitedNamedTemplateExprStmt, NamedTemplateExprStmt)
+    FUSE_VISIT(visitingAnonymousTemplateExprStmt, AnonymousTemplateExprStmt)
+    FUSE_VISIT(visitedAnonymousTemplateExprStmt, AnonymousTemplateExprStmt)
+    FUSE_VISIT(visitedResolutionDeferredTypeRef, ResolutionDeferredTypeRef)
+    FUSE_VISIT(visitKnownTypeRef, KnownTypeRef)
+    FUSE_VISIT(visitTemplateParameter, TemplateParameter)
+    FUSE_VISIT(visitingModule, Module)
+    FUSE_VISIT(visitedModule, Module)
+
+#undef FUSE_VISIT
+};
+
+}}}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "ErrorContextAstVisitor.h"
+
+namespace anode { namespace front  { namespace passes {
+
+/** Checks the arguments of intrinsics (see ast::IntrinsicCallExpr) and casts them implicitly where that is allowed. */
+class IntrinsicSemanticsPass : public ErrorContextAstVisitor {
+public:
+    explicit IntrinsicSemanticsPass(error::ErrorStream &errorStream) : ErrorContextAstVisitor(errorStream) { }
+
+    void visitedIntrinsicCallExpr(ast::IntrinsicCallExpr &expr) override {
+        switch(expr.kind()) {
+            case ast::IntrinsicKind::MakeVector:
+                checkMakeVector(expr);
+                break;
+            case ast::IntrinsicKind::Shuffle:
+                checkShuffle(expr);
+                break;
+            case ast::IntrinsicKind::Store:
+                checkStore(expr);
+                break;
+            case ast::IntrinsicKind::ReduceLanes:
+                checkVector(expr, 0);
+                break;
+            default:
+                ASSERT(expr.isMath());
+                checkMath(expr);
+        }
+    }
+
+private:
+    void checkMakeVector(ast::IntrinsicCallExpr &expr) {
+        type::VectorType &vectorType = *expr.vectorType();
+        if(expr.isLoad()) {
+            if(checkArrayOf(expr, 0, vectorType.elementType())) {
+                checkIndex(expr, 1);
+            }
+            return;
+        }
+
+        size_t argCount = expr.arguments().size();
+        if(argCount != 1 && argCount != vectorType.laneCount()) {
+            errorStream_.error(
+                error::ErrorKind::IncorrectNumberOfArguments,
+                expr.sourceSpan(),
+                "Incorrect number of arguments.  Expected 1, %d or an array and an index but found %d",
+                vectorType.laneCount(),
+                argCount);
+            return;
+        }
+        for(size_t i = 0; i < argCount; ++i) {
+            castArgument(expr, i, vectorType.elementType());
+        }
+    }
+
+    void checkShuffle(ast::IntrinsicCallExpr &expr) {
+        if(!checkArgumentCount(expr, 2, "at least 2") || !checkVector(expr, 0)) {
+            return;
+        }
+        auto &vectorType = upcast<type::VectorType>(*expr.arguments().front().get().exprType().actualType());
+        size_t firstLane = expr.firstLaneArgument();
+        if(firstLane == 2) {
+            ast::ExprStmt &otherVector = expr.arguments()[1];
+            if(!otherVector.exprType().isSameType(&vectorType)) {
+                errorStream_.error(
+                    error::ErrorKind::VectorTypeMismatch,
+                    otherVector.sourceSpan(),
+                    "Cannot shuffle a '%s' with a '%s'.",
+                    vectorType.nameForDisplay().c_str(),
+                    otherVector.exprType().nameForDisplay().c_str());
+                return;
+            }
+        }
+
+        //The lanes of the second vector follow those of the first.
+        unsigned laneCount = vectorType.laneCount() * (unsigned)firstLane;
+        for(size_t i = firstLane; i < expr.arguments().size(); ++i) {
+            ast::ExprStmt &laneExpr = expr.arguments()[i];
+            auto literalLane = tryUpcast<ast::LiteralInt32Expr>(&laneExpr);
+            if(!literalLane) {
+                errorStream_.error(
+                    error::ErrorKind::ShuffleLaneIsNotLiteralInt,
+                    laneExpr.sourceSpan(),
+                    "The lanes of a shuffle must be literal ints.");
+                return;
+            }
+            if(literalLane->value() < 0 || (unsigned)literalLane->value() >= laneCount) {
+                errorStream_.error(
+                    error::ErrorKind::LaneIndexOutOfRange,
+                    laneExpr.sourceSpan(),
+                    "Lane %d is out of range, the shuffled vectors have %d lanes.",
+                    literalLane->value(),
+                    laneCount);
+                return;
+            }
+        }
+
+        size_t resultLaneCount = expr.arguments().size() - firstLane;
+        if(!type::VectorType::find(vectorType.elementType(), (unsigned)resultLaneCount)) {
+            errorStream_.error(
+                error::ErrorKind::InvalidShuffleLaneCount,
+                expr.name().span(),
+                "A shuffle must select 4 or 8 lanes but selects %d.",
+                resultLaneCount);
+        }
+    }
+
+    void checkStore(ast::IntrinsicCallExpr &expr) {
+        if(expr.arguments().size() != 3) {
+            errorStream_.error(
+                error::ErrorKind::IncorrectNumberOfArguments,
+                expr.sourceSpan(),
+                "Incorrect number of arguments.  Expected an array, an index and a vector but found %d arguments",
+                expr.arguments().size());
+            return;
+        }
+        if(!checkVector(expr, 2)) {
+            return;
+        }
+        auto &vectorType = upcast<type::VectorType>(*expr.arguments()[2].get().exprType().actualType());
+        if(checkArrayOf(expr, 0, vectorType.elementType())) {
+            checkIndex(expr, 1);
+        }
+    }
+
+    void checkMath(ast::IntrinsicCallExpr &expr) {
+        size_t expectedCount = expr.mathArgumentCount();
+        if(expr.arguments().size() != expectedCount) {
+            errorStream_.error(
+                error::ErrorKind::IncorrectNumberOfArguments,
+                expr.sourceSpan(),
+                "Incorrect number of arguments.  Expected %d but found %d",
+                expectedCount,
+                expr.arguments().size());
+            return;
+        }
+
+        type::Type &operandsType = *expr.mathOperandsType();
+        if(!isValidMathOperandsType(operandsType, expr.mathAcceptsInts())) {
+            errorStream_.error(
+                error::ErrorKind::InvalidMathArgumentType,
+                expr.name().span(),
+                expr.mathAcceptsInts()
+                    ? "'%s' accepts ints, floats, doubles and vectors but found '%s'."
+                    : "'%s' accepts floats, doubles and vectors of floats but found '%s'.",
+                expr.name().text().c_str(),
+                operandsType.nameForDisplay().c_str());
+            return;
+        }
+        for(size_t i = 0; i < expectedCount; ++i) {
+            castArgument(expr, i, operandsType);
+        }
+    }
+
+    static bool isValidMathOperandsType(type::Type &type, bool acceptsInts) {
+        type::Type *actualType = type.actualType();
+        if(auto vectorType = tryUpcast<type::VectorType>(actualType)) {
+            actualType = &vectorType->elementType();
+        }
+        return actualType->isSameType(&type::ScalarType::Float)
+               || actualType->isSameType(&type::ScalarType::Double)
+               || (acceptsInts && actualType->isSameType(&type::ScalarType::Int32));
+    }
+
+    bool checkArgumentCount(ast::IntrinsicCallExpr &expr, size_t minimum, const char *expected) {
+        if(expr.arguments().size() < minimum) {
+            errorStream_.error(
+                error::ErrorKind::IncorrectNumberOfArguments,
+                expr.sourceSpan(),
+                "Incorrect number of arguments.  Expected %s but found %d",
+                expected,
+                expr.arguments().size());
+            return false;
+        }
+        return true;
+    }
+
+    bool checkVector(ast::IntrinsicCallExpr &expr, size_t index) {
+        if(!checkArgumentCount(expr, index + 1, "a vector")) {
+            return false;
+        }
+        ast::ExprStmt &argument = expr.arguments()[index];
+        if(!isInstanceOf<type::VectorType>(argument.exprType().actualType())) {
+            errorStream_.error(
+                error::ErrorKind::ArgumentIsNotVector,
+                argument.sourceSpan(),
+                "Expected a vector but found '%s'.",
+                argument.exprType().nameForDisplay().c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool checkArrayOf(ast::IntrinsicCallExpr &expr, size_t index, type::ScalarType &elementType) {
+        ast::ExprStmt &argument = expr.arguments()[index];
+        auto arrayType = tryUpcast<type::ArrayType>(argument.exprType().actualType());
+        if(!arrayType) {
+            errorStream_.error(
+                error::ErrorKind::IndexedExpressionIsNotArray,
+                argument.sourceSpan(),
+                "Expected an array but found '%s'.",
+                argument.exprType().nameForDisplay().c_str());
+            return false;
+        }
+        if(!arrayType->elementType().isSameType(&elementType)) {
+            errorStream_.error(
+                error::ErrorKind::VectorTypeMismatch,
+                argument.sourceSpan(),
+                "Expected an array of '%s' but found '%s'.",
+                elementType.nameForDisplay().c_str(),
+                arrayType->nameForDisplay().c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void checkIndex(ast::IntrinsicCallExpr &expr, size_t index) {
+        ast::ExprStmt &argument = expr.arguments()[index];
+        if(!argument.exprType().isSameType(&type::ScalarType::Int32)) {
+            errorStream_.error(
+                error::ErrorKind::ArrayIndexIsNotInt,
+                argument.sourceSpan(),
+                "The index of an array element must be an int but was '%s'.",
+                argument.exprType().nameForDisplay().c_str());
+        }
+    }
+
+    void castArgument(ast::IntrinsicCallExpr &expr, size_t index, type::Type &toType) {
+        ast::ExprStmt &argument = expr.arguments()[index];
+        if(argument.exprType().isSameType(&toType)) {
+            return;
+        }
+        if(!argument.exprType().canImplicitCastTo(toType)) {
+            errorStream_.error(
+                error::ErrorKind::InvalidImplicitCastInFunctionCallArgument,
+                argument.sourceSpan(),
+                "Cannot implicitly cast argument %d from '%s' to '%s'.",
+                index,
+                argument.exprType().nameForDisplay().c_str(),
+                toType.nameForDisplay().c_str());
+            return;
+        }
+        expr.replaceArgument(index, ast::CastExpr::createImplicit(argument, toType));
+    }
+};
+
+}}}
@@ -4,6 +4,7 @@
 #include "ErrorContextAstVisitor.h"
 #include "symbol_search.h"
 #include "run_passes.h"
+#include "common/stats.h"
 
 namespace anode { namespace front  { namespace passes {
 
@@ -38,7 +39,7 @@ public:
             return;
         }
 
-        auto templateSymbol = dynamic_cast<scope::TemplateSymbol*>(foundSymbol);
+        auto templateSymbol = tryUpcast<scope::TemplateSymbol>(foundSymbol);
         if(templateSymbol == nullptr) {
             errorStream_.error(
                 error::ErrorKind::SymbolIsNotATemplate,
@@ -77,10 +78,12 @@ public:
             return;
         }
 
+        stats::PhaseTimer timer{"front.templateExpansion.named"};
+        stats::global().increment("namedTemplateExpansions");
         gc_ref_vector<ast::TemplateArgument> templateArgs;
 
         for(unsigned int i = 0; i < tParams.size(); ++i) {
-            expansion.templateParameterScope().addSymbol(*new scope::TypeSymbol(tParams[i].get().name().text(), tArgs[i].get().type()));
+            expansion.templateParameterScope().addSymbol(*new scope::TypeSymbol(tParams[i].get().name().atom(), tArgs[i].get().type()));
             templateArgs.emplace_back(*new ast::TemplateArgument(tParams[i].get().name(), tArgs[i].get()));
         }
         ast::TemplateExpansionContext context{ast::ExpansionKind::NamedTemplate, templateArgs};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "FusedAstVisitor.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace anode { namespace front  { namespace passes {
+
+/**
+ * Groups an ordered list of passes into as few traversals of the AST as their declared dependencies allow.
+ *
+ * A dependency means that the named pass must have visited the entire tree before the dependent pass may begin, for
+ * example because the dependent pass looks at something which might be defined after the point where it's used.  A pass
+ * without a dependency on any pass of the current stage is fused into that stage, in which case it still runs after all
+ * previously added passes at any given node.
+ */
+class PassPipeline {
+    gc_vector<gc_ref_vector<ast::AstVisitor>> stages_;
+    std::vector<std::vector<std::string>> stageNames_;
+    std::unordered_set<std::string> currentStageNames_;
+    std::unordered_set<std::string> completedStageNames_;
+
+public:
+    NO_COPY_NO_ASSIGN(PassPipeline)
+    PassPipeline() { }
+
+    void add(const std::string &name, ast::AstVisitor &pass, std::initializer_list<std::string> dependencies = {}) {
+        ASSERT(currentStageNames_.count(name) == 0 && completedStageNames_.count(name) == 0 && "Pass names must be unique.");
+
+        bool needsNewStage = stages_.empty();
+        for(const std::string &dependency : dependencies) {
+            if(currentStageNames_.count(dependency)) {
+                needsNewStage = true;
+            } else {
+                ASSERT(completedStageNames_.count(dependency) && "Dependencies must be added to the pipeline first.");
+            }
+        }
+
+        if(needsNewStage) {
+            completedStageNames_.insert(currentStageNames_.begin(), currentStageNames_.end());
+            currentStageNames_.clear();
+            stages_.emplace_back();
+            stageNames_.emplace_back();
+        }
+
+        stages_.back().emplace_back(pass);
+        stageNames_.back().emplace_back(name);
+        currentStageNames_.insert(name);
+    }
+
+    /**
+     * Returns one visitor per traversal of the AST, to be executed in order by runPasses(...).  Stages consisting of a
+     * single pass are also wrapped in a FusedAstVisitor so that every pass is timed by name when statistics are enabled.
+     * Within a stage, a pass which reports an error stops the passes added after it, as runPasses(...) does between stages.
+     */
+    gc_ref_vector<ast::AstVisitor> stages(error::ErrorStream &errorStream) const {
+        gc_ref_vector<ast::AstVisitor> visitors;
+        for(size_t i = 0; i < stages_.size(); ++i) {
+            auto &fused = *new FusedAstVisitor(errorStream);
+            for(size_t j = 0; j < stages_[i].size(); ++j) {
+                fused.addPass(stages_[i][j], stageNames_[i][j]);
+            }
+            visitors.emplace_back(fused);
+        }
+        return visitors;
+    }
+};
+
+}}}
@@ -3,6 +3,7 @@
 
 #include "ErrorContextAstVisitor.h"
 #include "run_passes.h"
+#include "common/stats.h"
 
 namespace anode { namespace front  { namespace passes {
 
@@ -10,42 +11,46 @@ namespace anode { namespace front  { namespace passes {
 /**
  * Adds each CompleteClassDefinition instance and the template arguments used to expand it to the GenericClassDefinition
  * from which it originated so that it may later be resolved.
+ *
+ * The template arguments of a class are those of the innermost template expansion containing it.  These are tracked on a
+ * stack during a single traversal so that the body of each expansion is visited once, no matter how deeply expansions are
+ * nested.
  */
 class PopulateGenericTypesWithCompleteTypesPass : public ErrorContextAstVisitor {
-
-    class PopulateGenericTypesSubPass : public ScopeFollowingAstVisitor {
-        gc_ref_vector<type::Type> templateArguments_;
-    public:
-        PopulateGenericTypesSubPass(error::ErrorStream &errorStream, const gc_ref_vector<type::Type> &templateArgs)
-            : ScopeFollowingAstVisitor(errorStream), templateArguments_(templateArgs) { }
-
-        void visitingCompleteClassDefinition(ast::CompleteClassDefinition &cd) override {
-            auto genericType = upcast<type::ClassType>(cd.definedType()).genericType();
-            if(genericType) {
-                if (genericType->findExpandedClassType(templateArguments_)) {
-                    return;
-                }
-                genericType->addExpandedClass(templateArguments_, upcast<type::ClassType>(cd.definedType()));
-            }
-        }
-    };
-
+    gc_vector<gc_ref_vector<type::Type>> templateArgumentsStack_;
 public:
-    explicit PopulateGenericTypesWithCompleteTypesPass(error::ErrorStream &errorStream) : ErrorContextAstVisitor(errorStream) { }
+    explicit PopulateGenericTypesWithCompleteTypesPass(error::ErrorStream &errorStream)
+        : ErrorContextAstVisitor(errorStream) { }
 
     void visitingTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &expansion) override {
         ErrorContextAstVisitor::visitingTemplateExpansionExprStmt(expansion);
 
         gc_ref_vector<type::Type> typeArguments;
-        gc_ref_vector<scope::TypeSymbol> argumentSymbols = expansion.templateParameterScope().types();
+        const gc_ref_vector<scope::TypeSymbol> &argumentSymbols = expansion.templateParameterScope().types();
         typeArguments.reserve(argumentSymbols.size());
         for(scope::TypeSymbol &argSymbol : argumentSymbols) {
             typeArguments.emplace_back(argSymbol.type());
         }
+        templateArgumentsStack_.push_back(typeArguments);
+    }
 
-        PopulateGenericTypesSubPass pass{errorStream_, typeArguments};
-        pass.pushScope(expansion.templateParameterScope());
-        expansion.expandedTemplate()->accept(pass);
+    void visitedTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &expansion) override {
+        templateArgumentsStack_.pop_back();
+        ErrorContextAstVisitor::visitedTemplateExpansionExprStmt(expansion);
+    }
+
+    void visitingCompleteClassDefinition(ast::CompleteClassDefinition &cd) override {
+        if(templateArgumentsStack_.empty()) {
+            return;
+        }
+        auto genericType = upcast<type::ClassType>(cd.definedType()).genericType();
+        if(genericType) {
+            const gc_ref_vector<type::Type> &templateArguments = templateArgumentsStack_.back();
+            if (genericType->findExpandedClassType(templateArguments)) {
+                return;
+            }
+            genericType->addExpandedClass(templateArguments, upcast<type::ClassType>(cd.definedType()));
+        }
     }
 };
 
@@ -64,7 +69,7 @@ public:
     void visitedResolutionDeferredTypeRef(ast::ResolutionDeferredTypeRef &typeRef) override {
 
         if(typeRef.hasTemplateArguments()) {
-            auto genericType = dynamic_cast<type::GenericType*>(typeRef.type().actualType());
+            auto genericType = tryUpcast<type::GenericType>(typeRef.type().actualType());
             if(!genericType) {
                 errorStream_.error(
                     error::ErrorKind::TypeIsNotGenericButIsReferencedWithGenericArgs,
@@ -88,6 +93,8 @@ public:
 
             auto foundClassType = genericType->findExpandedClassType(templateArgTypes);
             if(foundClassType == nullptr) {
+                stats::PhaseTimer timer{"front.templateExpansion.genericClass"};
+                stats::global().increment("genericClassExpansions");
                 auto &genericClass = world_.getGenericClassDefinition(genericType->astNodeId());
 
                 //FIXME:  the term "template arguments" seems to be rather overloaded here, since "TemplateArgVector" means
@@ -113,11 +120,11 @@ public:
                     completedClass.sourceSpan(),
                     scope::StorageKind::TemplateParameter,
                     compoundExprBody,
-                    genericClass.symbol()->fullyQualifiedName() + scope::ScopeSeparator + "ImplicitExpansion");
+                    genericClass.symbol()->fullyQualifiedName().text() + scope::ScopeSeparator + "ImplicitExpansion");
 
                 for(ast::TemplateArgument &templateArg : argVector) {
                     expandedTemplateWrapper->scope().addSymbol(
-                        *new scope::TypeSymbol(templateArg.parameterName().text(), templateArg.typeRef().type()));
+                        *new scope::TypeSymbol(templateArg.parameterName().atom(), templateArg.typeRef().type()));
                 }
                 ast::ExprStmt *expandedTemplate = expandedTemplateWrapper;
 
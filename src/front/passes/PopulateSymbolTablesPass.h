@@ -24,14 +24,14 @@ public:
         if (!cd.hasTemplateArguments()) {
             type::Type &definedType = cd.definedType();
 
-            if (auto definedClassType = dynamic_cast<type::ClassType *>(&definedType)) {
+            if (auto definedClassType = tryUpcast<type::ClassType>(&definedType)) {
                 if (definedClassType->genericType() != nullptr) {
                     ScopeFollowingAstVisitor::visitingCompleteClassDefinition(cd);
                     return;
                 }
             }
 
-            if(currentScope().findSymbolInCurrentScope(cd.name().text())) {
+            if(currentScope().findSymbolInCurrentScope(cd.name().atom())) {
                 symbolPreviouslyDefinedError(cd.name());
             } else {
                 auto &&classSymbol = *new scope::TypeSymbol(definedType);
@@ -42,17 +42,25 @@ public:
     }
 
     void visitingFuncDefStmt(ast::FuncDefStmt &funcDeclStmt) override {
-        if(currentScope().findSymbolInCurrentScope(funcDeclStmt.name().text())) {
+        //Calls to such a function or method would invoke the intrinsic instead.
+        if(ast::isIntrinsicName(funcDeclStmt.name().text())) {
+            errorStream_.error(
+                error::ErrorKind::FunctionNameIsIntrinsic,
+                funcDeclStmt.name().span(),
+                "'%s' is the name of an intrinsic and cannot be the name of a function",
+                funcDeclStmt.name().text().c_str());
+        }
+        if(currentScope().findSymbolInCurrentScope(funcDeclStmt.name().atom())) {
             symbolPreviouslyDefinedError(funcDeclStmt.name());
         } else {
-            scope::FunctionSymbol &funcSymbol = *new scope::FunctionSymbol(funcDeclStmt.name().text(), &funcDeclStmt.functionType());
+            scope::FunctionSymbol &funcSymbol = *new scope::FunctionSymbol(funcDeclStmt.name().atom(), &funcDeclStmt.functionType());
 
             currentScope().addSymbol(funcSymbol);
             funcDeclStmt.setSymbol(funcSymbol);
 
             for (auto p : funcDeclStmt.parameters()) {
-                scope::VariableSymbol &symbol = *new scope::VariableSymbol(p.get().name().text(), p.get().type());
-                if (funcDeclStmt.parameterScope().findSymbolInCurrentScope(p.get().name().text())) {
+                scope::VariableSymbol &symbol = *new scope::VariableSymbol(p.get().name().atom(), p.get().type());
+                if (funcDeclStmt.parameterScope().findSymbolInCurrentScope(p.get().name().atom())) {
                     errorStream_.error(
                         error::ErrorKind::SymbolAlreadyDefinedInScope,
                         p.get().span(),
@@ -70,10 +78,10 @@ public:
     void visitingVariableDeclExpr(ast::VariableDeclExpr &expr) override {
         ASSERT(expr.name().size() == 1 && "TODO:  semantic error when variable declarations have more than 1 part or refactor VariableDeclExpr and VariableRefExpr.");
 
-        if(currentScope().findSymbolInCurrentScope(expr.name().front().text())) {
+        if(currentScope().findSymbolInCurrentScope(expr.name().front().atom())) {
             symbolPreviouslyDefinedError(expr.name().front());
         } else {
-            auto &&symbol = *new scope::VariableSymbol(expr.name().front().text(), expr.typeRef().type());
+            auto &&symbol = *new scope::VariableSymbol(expr.name().front().atom(), expr.typeRef().type());
             currentScope().addSymbol(symbol);
             expr.setSymbol(symbol);
         }
@@ -83,11 +91,11 @@ public:
 
         //Grab top-level classes within the scope of the template.
         for (auto exprStmt : templ.body().expressions()) {
-            if (auto cd = dynamic_cast<ast::GenericClassDefinition *>(&exprStmt.get())) {
-                if (currentScope().findSymbolInCurrentScope(cd->name().text())) {
+            if (auto cd = tryUpcast<ast::GenericClassDefinition>(&exprStmt.get())) {
+                if (currentScope().findSymbolInCurrentScope(cd->name().atom())) {
                     symbolPreviouslyDefinedError(cd->name());
                 } else {
-                    auto &&symbol = *new scope::TypeSymbol(cd->name().text(), cd->definedType());
+                    auto &&symbol = *new scope::TypeSymbol(cd->name().atom(), cd->definedType());
                     currentScope().addSymbol(symbol);
                     cd->setSymbol(symbol);
                 }
@@ -96,10 +104,10 @@ public:
     }
 
     void visitingNamedTemplateExprStmt(ast::NamedTemplateExprStmt &templ) override {
-        if (currentScope().findSymbolInCurrentScope(templ.name().text())) {
+        if (currentScope().findSymbolInCurrentScope(templ.name().atom())) {
             symbolPreviouslyDefinedError(templ.name());
         } else {
-            auto &&symbol = *new scope::TemplateSymbol(templ.name().text(), templ.nodeId());
+            auto &&symbol = *new scope::TemplateSymbol(templ.name().atom(), templ.nodeId());
             currentScope().addSymbol(symbol);
         }
     }
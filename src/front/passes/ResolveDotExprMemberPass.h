@@ -12,6 +12,10 @@ public:
     explicit ResolveDotExprMemberPass(error::ErrorStream &errorStream) : errorStream_{errorStream} { }
 
     void visitedDotExpr(ast::DotExpr &expr) override {
+        if(isInstanceOf<type::ArrayType>(expr.lValue().exprType().actualType())) {
+            resolveArrayMember(expr);
+            return;
+        }
         if(!expr.lValue().exprType().isClass()) {
             errorStream_.error(
                 error::ErrorKind::LeftOfDotNotClass,
@@ -21,7 +25,7 @@ public:
             return;
         }
         auto classType = static_cast<const type::ClassType*>(expr.lValue().exprType().actualType());
-        type::ClassField *field = classType->findField(expr.memberName().text());
+        type::ClassField *field = classType->findField(expr.memberName().atom());
         if(!field) {
             errorStream_.error(
                 error::ErrorKind::ClassMemberNotFound,
@@ -34,14 +38,28 @@ public:
         expr.setField(field);
     }
 
+    /** The only member of an array is its length. */
+    void resolveArrayMember(ast::DotExpr &expr) {
+        if(expr.memberName().text() != "length") {
+            errorStream_.error(
+                error::ErrorKind::ClassMemberNotFound,
+                expr.dotSourceSpan(),
+                "Array type '%s' does not have a member named '%s'",
+                expr.lValue().exprType().nameForDisplay().c_str(),
+                expr.memberName().text().c_str());
+            return;
+        }
+        expr.setIsArrayLength();
+    }
+
     void visitedFuncCallExpr(ast::FuncCallExpr &expr) override {
-        auto methodRef = dynamic_cast<ast::MethodRefExpr*>(&expr.funcExpr());
+        auto methodRef = tryUpcast<ast::MethodRefExpr>(&expr.funcExpr());
         if(methodRef && expr.instanceExpr()) {
             type::Type *instanceType = expr.instanceExpr()->exprType().actualType();
             type::ClassMethod *method = nullptr;
 
-            if(auto classType = dynamic_cast<type::ClassType*>(instanceType)) {
-                method = classType->findMethod(methodRef->name().text());
+            if(auto classType = tryUpcast<type::ClassType>(instanceType)) {
+                method = classType->findMethod(methodRef->name().atom());
             }
 
             if(method) {
@@ -17,15 +17,28 @@ public:
         if(typeRef.isResolved()) {
             return;
         }
+        //The element type has already been visited.  It may be resolved later, i.e. to a class expanded from a generic
+        //class, which ArrayType allows for by referring to the element type's ResolutionDeferredType.
+        if(typeRef.isArray()) {
+            typeRef.setType(*new type::ArrayType(typeRef.elementTypeRef().type()));
+            return;
+        }
         auto &resolvedName = typeRef.name();
         type::Type *type = nullptr;
 
         if(resolvedName.size() == 1) {
             type = type::ScalarType::fromKeyword(resolvedName.front().text());
+            if(!type) {
+                type = type::VectorType::fromKeyword(resolvedName.front().text());
+            }
             if(type) {
                 typeRef.setType(*type);
                 return;
             }
+            if(resolvedName.front().text() == "task") {
+                resolveTaskType(typeRef);
+                return;
+            }
         }
 
         scope::Symbol* maybeType = findQualifiedSymbol(topScope(),  typeRef.name(), errorStream_);
@@ -36,7 +49,7 @@ public:
             return;
         }
 
-        auto *typeSymbol = dynamic_cast<scope::TypeSymbol*>(maybeType);
+        auto *typeSymbol = tryUpcast<scope::TypeSymbol>(maybeType);
 
         //Symbol does exist but isn't a type.
         if(typeSymbol == nullptr) {
@@ -47,6 +60,21 @@ public:
 
         typeRef.setType(typeSymbol->type());
     }
+
+private:
+    /** Task types have exactly one argument:  the type of the result of the spawned function, i.e. "task<int>". */
+    void resolveTaskType(ast::ResolutionDeferredTypeRef &typeRef) {
+        const gc_ref_vector<ast::ResolutionDeferredTypeRef> &templateArgs = typeRef.templateArgTypeRefs();
+        if(templateArgs.size() != 1) {
+            errorStream_.error(
+                error::ErrorKind::IncorrectNumberOfGenericArguments,
+                typeRef.sourceSpan(),
+                "Incorrect number of generic arguments for type 'task' - expected 1 but found %d",
+                templateArgs.size());
+            return;
+        }
+        typeRef.setType(*new type::TaskType(templateArgs.front().get().type()));
+    }
 };
 
 
@@ -45,6 +45,10 @@ public:
         symbolTableStack_.push_back(st);
     }
 
+    void pushStartingScope(scope::SymbolTable &st) override {
+        pushScope(st);
+    }
+
     void visitingFuncDefStmt(ast::FuncDefStmt &funcDeclStmt) override {
         symbolTableStack_.emplace_back(funcDeclStmt.parameterScope());
     }
@@ -69,7 +73,7 @@ public:
 private:
     scope::SymbolTable *descendIntoNamespace(scope::SymbolTable *current, const ast::Identifier &nsName) {
         ASSERT(current);
-        auto found = current->findSymbolInCurrentScope(nsName.text());
+        auto found = current->findSymbolInCurrentScope(nsName.atom());
         //No symbol matching the current part was found... create a new namespace in the current scope and descend into it.
         if(found == nullptr) {
 
@@ -84,7 +88,7 @@ private:
             current = &newNs.symbolTable();
         }
             //A symbol was found and it is a previously created namespace -- descend into it
-        else if(auto nsSymbol = dynamic_cast<scope::NamespaceSymbol*>(found)) {
+        else if(auto nsSymbol = tryUpcast<scope::NamespaceSymbol>(found)) {
             current = &nsSymbol->symbolTable();
         }
             //A symbol was found and it isn't a previously created namespace.
@@ -110,6 +114,15 @@ public:
         symbolTableStack_.pop_back();
     }
 
+    void visitingForExpr(ast::ForExpr &forExpr) override {
+        symbolTableStack_.emplace_back(forExpr.scope());
+    }
+
+    void visitedForExpr(ast::ForExpr &forExpr) override {
+        ASSERT(&forExpr.scope() == &symbolTableStack_.back().get());
+        symbolTableStack_.pop_back();
+    }
+
     void visitingTemplateExpansionExprStmt(ast::TemplateExpansionExprStmt &expansion) override {
         ErrorContextAstVisitor::visitingTemplateExpansionExprStmt(expansion);
         symbolTableStack_.emplace_back(expansion.templateParameterScope());
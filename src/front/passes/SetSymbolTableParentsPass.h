@@ -40,6 +40,13 @@ public:
         }
         ScopeFollowingAstVisitor::visitingCompoundExpr(expr);
     }
+
+    void visitingForExpr(ast::ForExpr &expr) override {
+        if(!expr.scope().parent()) {
+            expr.scope().setParent(topScope());
+        }
+        ScopeFollowingAstVisitor::visitingForExpr(expr);
+    }
 };
 
 
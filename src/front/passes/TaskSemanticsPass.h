@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ErrorContextAstVisitor.h"
+
+namespace anode { namespace front  { namespace passes {
+
+/**
+ * Checks that only calls to functions are spawned and that only tasks are joined.  Methods may not be spawned because
+ * the back end passes the arguments of a spawned call to the task but not its instance.
+ */
+class TaskSemanticsPass : public ErrorContextAstVisitor {
+public:
+    explicit TaskSemanticsPass(error::ErrorStream &errorStream) : ErrorContextAstVisitor(errorStream) { }
+
+    void visitedSpawnExpr(ast::SpawnExpr &spawnExpr) override {
+        if(!isFunctionCall(spawnExpr.callExpr())) {
+            errorStream_.error(
+                error::ErrorKind::SpawnedExpressionIsNotFunctionCall,
+                spawnExpr.callExpr().sourceSpan(),
+                "Only function calls may be spawned.");
+        }
+    }
+
+    void visitedJoinExpr(ast::JoinExpr &joinExpr) override {
+        type::Type &taskType = joinExpr.taskExpr().exprType();
+        if(!isInstanceOf<type::TaskType>(taskType.actualType())) {
+            errorStream_.error(
+                error::ErrorKind::JoinedExpressionIsNotTask,
+                joinExpr.taskExpr().sourceSpan(),
+                "Cannot join a value of type '%s' which is not a task.",
+                taskType.nameForDisplay().c_str());
+        }
+    }
+
+private:
+    static bool isFunctionCall(ast::ExprStmt &expr) {
+        auto funcCallExpr = tryUpcast<ast::FuncCallExpr>(expr);
+        if(!funcCallExpr || funcCallExpr->instanceExpr()) {
+            return false;
+        }
+        auto variableRef = tryUpcast<ast::VariableRefExpr>(funcCallExpr->funcExpr());
+        if(!variableRef) {
+            return false;
+        }
+        auto functionSymbol = tryUpcast<scope::FunctionSymbol>(variableRef->symbol());
+        return functionSymbol && functionSymbol->storageKind() != scope::StorageKind::Instance;
+    }
+};
+
+}}}
@@ -12,10 +12,15 @@
 #include "BinaryExprSemanticsPass.h"
 #include "CastExprSemanticPass.h"
 #include "FuncCallSemanticsPass.h"
+#include "TaskSemanticsPass.h"
+#include "ForExprSemanticsPass.h"
+#include "ArrayExprSemanticsPass.h"
+#include "IntrinsicSemanticsPass.h"
 #include "SetSymbolTableParentsPass.h"
 
 #include "run_passes.h"
 #include "AnonymousTemplateSemanticPass.h"
+#include "PassPipeline.h"
 
 namespace anode { namespace front  { namespace passes {
 
@@ -27,13 +32,30 @@ class PrepareClassesVisitor : public ast::AstVisitor {
 
 class MarkDotExprWritesPass : public ast::AstVisitor {
     void visitedBinaryExpr(ast::BinaryExpr &binaryExpr) override {
-        auto dotExpr = dynamic_cast<ast::DotExpr *>(&binaryExpr.lValue());
+        auto dotExpr = tryUpcast<ast::DotExpr>(&binaryExpr.lValue());
         if (dotExpr && binaryExpr.operation() == ast::BinaryOperationKind::Assign) {
             dotExpr->setIsWrite(true);
         }
     }
 };
 
+/** Assigning a lane of a vector writes the vector, so the back end must emit the address of the vector. */
+class MarkVectorLaneWritesPass : public ast::AstVisitor {
+    void visitedIndexExpr(ast::IndexExpr &indexExpr) override {
+        if(!indexExpr.isWrite() || !isInstanceOf<type::VectorType>(indexExpr.arrayExpr().exprType().actualType())) {
+            return;
+        }
+        ast::ExprStmt &vectorExpr = indexExpr.arrayExpr();
+        if(auto varRef = tryUpcast<ast::VariableRefExpr>(&vectorExpr)) {
+            varRef->setVariableAccess(ast::VariableAccess::Write);
+        } else if(auto dotExpr = tryUpcast<ast::DotExpr>(&vectorExpr)) {
+            dotExpr->setIsWrite(true);
+        } else if(auto elementExpr = tryUpcast<ast::IndexExpr>(&vectorExpr)) {
+            elementExpr->setIsWrite(true);
+        }
+    }
+};
+
 /** Stores the all templates in the AnodeWorld instance by UniqueId so they can be fetched later when they're expanded.
  * FIXME:  this class needs a better name. */
 class TemplateWorldRecorderPass : public ScopeFollowingAstVisitor {
@@ -67,11 +89,15 @@ bool runPasses(
     scope::SymbolTable *startingSymbolTable) {
 
     for(ast::AstVisitor &pass : visitors) {
-        if(startingSymbolTable)
-        if(auto sfav = dynamic_cast<ScopeFollowingAstVisitor*>(&pass)) {
-            sfav->pushScope(*startingSymbolTable);
+        if(startingSymbolTable) {
+            pass.pushStartingScope(*startingSymbolTable);
         }
         node.accept(pass);
+        if(stats::global().enabled()) {
+            if(auto fused = dynamic_cast<FusedAstVisitor*>(&pass)) {
+                fused->recordStatistics();
+            }
+        }
         //If an error occurs during any pass, stop executing passes immediately because
         //some passes depend on the success of previous passes.
         if(es.errorCount() > 0) {
@@ -99,13 +125,27 @@ gc_ref_vector<ast::AstVisitor> getPreTemplateExpansionPassses(ast::AnodeWorld &w
     return passes;
 }
 
+bool runModuleLocalPasses(ast::AnodeWorld &world, ast::Module &module, error::ErrorStream &es) {
+    ASSERT(!module.localPassesComplete());
+    gc_ref_vector<ast::AstVisitor> passes;
+    //Only reads the address of the world's global scope, which is the parent of every module's scope.
+    passes.emplace_back(*new SetSymbolTableParentsPass(es, world));
+    passes.emplace_back(*new PopulateSymbolTablesPass(es));
+
+    stats::PhaseTimer timer{"front.moduleLocalPasses"};
+    if(runPasses(passes, module, es)) {
+        return true;
+    }
+    module.setLocalPassesComplete();
+    return false;
+}
+
 //TODO:  make this a method on AnodeWorld! Will need to move AnodeWorld out of ::ast first, however...
 void runAllPasses(ast::AnodeWorld &world, ast::Module &module, error::ErrorStream &es) {
 
-    //Having so many visitors is probably not great for performance because most of these visit the
-    //entire tree but does very little in each individual pass. When/if performance becomes an issue it should
-    //be possible to merge some of these passes together. For now, the modularity of the existing
-    //arrangement is highly desirable.
+    //Most of these passes visit the entire tree but do very little in each individual pass, so passes that do not
+    //depend on a prior pass having visited the entire tree are fused by PassPipeline into a single traversal.  This
+    //preserves the modularity of the individual passes.  When adding a pass, be sure to declare its dependencies.
 
     // Order of the individual passes is important because there is necessary "temporal coupling"  and a requirement of
     // an at least partially mutable AST here but there's not an easy way around these as far as
@@ -113,42 +153,63 @@ void runAllPasses(ast::AnodeWorld &world, ast::Module &module, error::ErrorStrea
 
     gc_ref_vector<ast::AstVisitor> passes;
 
-    passes = getPreTemplateExpansionPassses(world, module, es);
-    if(runPasses(passes, module, es)) return;
+    if(!module.localPassesComplete() && runModuleLocalPasses(world, module, es)) {
+        return;
+    }
+
+    //The same as getPreTemplateExpansionPassses(...) minus the passes that were run by runModuleLocalPasses(...).
+    passes.emplace_back(*new TemplateWorldRecorderPass(es, world));
+    passes.emplace_back(*new NamedTemplateExpanderPass(es, module, world));
+    {
+        stats::PhaseTimer timer{"front.preTemplateExpansionPasses"};
+        if(runPasses(passes, module, es)) return;
+    }
 
-    passes.clear();
+    PassPipeline pipeline;
 
     //Resolve all ast::TypeRefs here (i.e. variables, arguments, class fields, function arguments, etc)
     //will know to the type::Type after this phase
-    passes.emplace_back(*new ResolveTypesPass(es));
+    pipeline.add("ResolveTypes", *new ResolveTypesPass(es));
 
-    passes.emplace_back(*new ExpandClassesWithinAnonymousTemplates(es, module, world));
+    pipeline.add("ExpandClassesWithinAnonymousTemplates", *new ExpandClassesWithinAnonymousTemplates(es, module, world),
+                 {"ResolveTypes"});
 
-    passes.emplace_back(*new PopulateGenericTypesWithCompleteTypesPass(es));
+    pipeline.add("PopulateGenericTypesWithCompleteTypes", *new PopulateGenericTypesWithCompleteTypesPass(es),
+                 {"ExpandClassesWithinAnonymousTemplates"});
 
-    passes.emplace_back(*new ConvertGenericTypeRefsToCompletePass(es));
+    pipeline.add("ConvertGenericTypeRefsToComplete", *new ConvertGenericTypeRefsToCompletePass(es),
+                 {"PopulateGenericTypesWithCompleteTypes"});
 
     //Symbol references (i.e. variable, call sites, etc) find their corresponding symbols here.
-    passes.emplace_back(*new ResolveSymbolsPass(es));
+    pipeline.add("ResolveSymbols", *new ResolveSymbolsPass(es), {"ExpandClassesWithinAnonymousTemplates"});
     //Create type::ClassType and populate all the fields, for all classes
-    passes.emplace_back(*new PrepareClassesVisitor());
-    //Resolve all member references
-    passes.emplace_back(*new ResolveDotExprMemberPass(es));
-    //Insert implicit casts where they are allowed
-    passes.emplace_back(*new AddImplicitCastsPass(es));
+    pipeline.add("PrepareClasses", *new PrepareClassesVisitor(), {"ExpandClassesWithinAnonymousTemplates"});
+    //Resolve all member references.  A member may be referenced before its class is defined.
+    pipeline.add("ResolveDotExprMember", *new ResolveDotExprMemberPass(es),
+                 {"PrepareClasses", "ResolveSymbols", "ConvertGenericTypeRefsToComplete"});
+    //Insert implicit casts where they are allowed.  The type of a while condition is examined before it is visited.
+    pipeline.add("AddImplicitCasts", *new AddImplicitCastsPass(es), {"ResolveDotExprMember"});
+    //Also inserts implicit casts, of the arguments of intrinsics.
+    pipeline.add("IntrinsicSemantics", *new IntrinsicSemanticsPass(es), {"ResolveDotExprMember"});
     //
-    passes.emplace_back(*new BinaryExprSemanticsPass(es));
+    pipeline.add("BinaryExprSemantics", *new BinaryExprSemanticsPass(es), {"ResolveDotExprMember"});
 
     //Finally, on to some semantics checking:
-    passes.emplace_back(*new AnonymousTemplatesSemanticPass(es));
-    passes.emplace_back(*new CastExprSemanticPass(es));
-    passes.emplace_back(*new FuncCallSemanticsPass(es));
+    pipeline.add("AnonymousTemplatesSemantic", *new AnonymousTemplatesSemanticPass(es), {"ResolveDotExprMember"});
+    //Also double-checks the implicit casts added by AddImplicitCastsPass, so it must see all of them.
+    pipeline.add("CastExprSemantic", *new CastExprSemanticPass(es), {"AddImplicitCasts", "IntrinsicSemantics"});
+    pipeline.add("FuncCallSemantics", *new FuncCallSemanticsPass(es), {"ResolveDotExprMember"});
+    pipeline.add("TaskSemantics", *new TaskSemanticsPass(es), {"ResolveDotExprMember"});
+    pipeline.add("ForExprSemantics", *new ForExprSemanticsPass(es), {"ResolveDotExprMember"});
+    pipeline.add("ArrayExprSemantics", *new ArrayExprSemanticsPass(es), {"ResolveDotExprMember"});
 
     //Dot expressions immediately to the left of '=' should be properly marked as "writes" so the correct
     //LLVM IR can be emitted for them.  (No way to know this at parse time.)
-    passes.emplace_back(*new MarkDotExprWritesPass());
+    pipeline.add("MarkDotExprWrites", *new MarkDotExprWritesPass(), {"ResolveDotExprMember"});
+    pipeline.add("MarkVectorLaneWrites", *new MarkVectorLaneWritesPass(), {"ResolveDotExprMember"});
 
-    runPasses(passes, module, es);
+    stats::PhaseTimer timer{"front.semanticPasses"};
+    runPasses(pipeline.stages(es), module, es);
 }
 
 }}}
\ No newline at end of file
@@ -19,7 +19,7 @@ namespace anode { namespace front {
 scope::Symbol *findQualifiedSymbol(scope::SymbolTable &startingScope, const ast::MultiPartIdentifier &id, error::ErrorStream &errorStream) {
     //Identifier has only one element, just do a simple search up the parentage chain for that symbol.
     if (id.size() == 1) {
-        scope::Symbol *foundSymbol = startingScope.findSymbolInCurrentScopeOrParents(id.front().text());
+        scope::Symbol *foundSymbol = startingScope.findSymbolInCurrentScopeOrParents(id.front().atom());
         if (foundSymbol == nullptr) {
             errorStream.error(
                 error::ErrorKind::SymbolNotDefined,
@@ -32,7 +32,7 @@ scope::Symbol *findQualifiedSymbol(scope::SymbolTable &startingScope, const ast:
         //The identifier has more than one element, so some complexity is involved.
 
         //Use entire scope parentage chain to search for the first identifier.
-        scope::Symbol *maybeNamespace = startingScope.findSymbolInCurrentScopeOrParents(id.front().text());
+        scope::Symbol *maybeNamespace = startingScope.findSymbolInCurrentScopeOrParents(id.front().atom());
         if (maybeNamespace == nullptr) {
             errorStream.error(
                 error::ErrorKind::NamespaceDoesNotExist,
@@ -44,7 +44,7 @@ scope::Symbol *findQualifiedSymbol(scope::SymbolTable &startingScope, const ast:
 
         //Make sure it's a namespace.
         scope::SymbolTable *currentNamespace = nullptr;
-        if (scope::NamespaceSymbol *nss = dynamic_cast<scope::NamespaceSymbol *>(maybeNamespace)) {
+        if (scope::NamespaceSymbol *nss = tryUpcast<scope::NamespaceSymbol>(maybeNamespace)) {
             currentNamespace = &nss->symbolTable();
         } else {
             errorStream.error(
@@ -60,7 +60,7 @@ scope::Symbol *findQualifiedSymbol(scope::SymbolTable &startingScope, const ast:
         //the scope parentage chain, thereby descending through scopes.
         ast::MultiPartIdentifier::middle_vector middleParts = id.middle();
         for (const ast::Identifier &part : middleParts) {
-            scope::Symbol *maybeNamespace = currentNamespace->findSymbolInCurrentScope(part.text());
+            scope::Symbol *maybeNamespace = currentNamespace->findSymbolInCurrentScope(part.atom());
             if (maybeNamespace == nullptr) {
                 errorStream.error(
                     error::ErrorKind::ChildNamespaceDoesNotExist,
@@ -71,7 +71,7 @@ scope::Symbol *findQualifiedSymbol(scope::SymbolTable &startingScope, const ast:
                 return nullptr;
             }
             //Make sure what we got was a namespace.
-            if (scope::NamespaceSymbol *nss = dynamic_cast<scope::NamespaceSymbol *>(maybeNamespace)) {
+            if (scope::NamespaceSymbol *nss = tryUpcast<scope::NamespaceSymbol>(maybeNamespace)) {
                 currentNamespace = &nss->symbolTable();
             } else {
                 errorStream.error(
@@ -90,7 +90,7 @@ scope::Symbol *findQualifiedSymbol(scope::SymbolTable &startingScope, const ast:
         ASSERT(currentNamespace);
 
         //Finally, resolve the element of the identifier in the current scope only.
-        scope::Symbol *foundSymbol = currentNamespace->findSymbolInCurrentScope(id.back().text());
+        scope::Symbol *foundSymbol = currentNamespace->findSymbolInCurrentScope(id.back().atom());
         if (foundSymbol == nullptr) {
             errorStream.error(
                 error::ErrorKind::NamespaceMemberDoesNotExist,
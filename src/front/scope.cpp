@@ -24,7 +24,20 @@ SymbolBase::SymbolBase()
 
 }
 
-Symbol *SymbolTable::findSymbolInCurrentScope(const std::string &name) const {
+Atom SymbolTable::fullName() {
+    if(!parent_) {
+        return name_;
+    }
+
+    Atom parentFullName = parent_->fullName();
+    if(fullName_.empty() || parentFullName != fullNameOfParent_) {
+        fullName_ = Atom(parentFullName.text() + ScopeSeparator + name_.text());
+        fullNameOfParent_ = parentFullName;
+    }
+    return fullName_;
+}
+
+Symbol *SymbolTable::findSymbolInCurrentScope(Atom name) const {
     auto found = symbols_.find(name);
     if (found == symbols_.end()) {
         return nullptr;
@@ -32,7 +45,7 @@ Symbol *SymbolTable::findSymbolInCurrentScope(const std::string &name) const {
     return &found->second.get();
 }
 
-Symbol *SymbolTable::findSymbolInCurrentScopeOrParents(const std::string &name) const {
+Symbol *SymbolTable::findSymbolInCurrentScopeOrParents(Atom name) const {
     SymbolTable const *current = this;
     while(current) {
         Symbol* found = current->findSymbolInCurrentScope(name);
@@ -62,44 +75,21 @@ void SymbolTable::addSymbol(Symbol &symbol) {
     symbol.setStorageKind(storageKind_);
     symbols_.emplace(symbol.name(), symbol);
     orderedSymbols_.emplace_back(symbol);
-}
-
-gc_ref_vector<VariableSymbol> SymbolTable::variables() {
-    gc_ref_vector<VariableSymbol> variables;
-    for (auto symbol : orderedSymbols_) {
-        auto variable = dynamic_cast<VariableSymbol*>(&symbol.get());
-        if(variable)
-            variables.emplace_back(*variable);
-    }
-
-    return variables;
-}
 
-gc_ref_vector<TypeSymbol> SymbolTable::types() {
-    gc_ref_vector<TypeSymbol> classes;
-    for (auto symbol : orderedSymbols_) {
-        auto type = dynamic_cast<scope::TypeSymbol*>(&symbol.get());
-        if(type)
-            classes.emplace_back(*type);
+    switch(symbol.symbolKind()) {
+        case SymbolKind::Variable:
+            variables_.emplace_back(static_cast<VariableSymbol&>(symbol));
+            break;
+        case SymbolKind::Type:
+            types_.emplace_back(static_cast<TypeSymbol&>(symbol));
+            break;
+        case SymbolKind::Function:
+            functions_.emplace_back(static_cast<FunctionSymbol&>(symbol));
+            break;
+        case SymbolKind::Template:
+        case SymbolKind::Namespace:
+            break;
     }
-
-    return classes;
-}
-
-gc_ref_vector<FunctionSymbol> SymbolTable::functions() const {
-    gc_ref_vector<FunctionSymbol> symbols;
-    for (auto symbol : orderedSymbols_) {
-        auto function = dynamic_cast<FunctionSymbol*>(&symbol.get());
-        if(function != nullptr) {
-            symbols.emplace_back(*function);
-        }
-    }
-
-    return symbols;
-}
-
-gc_ref_vector<Symbol> SymbolTable::symbols() const {
-    return orderedSymbols_;
 }
 
 }}}
@@ -12,6 +12,11 @@ ScalarType ScalarType::Double("double", PrimitiveType::Double, true);
 ScalarType ScalarType::Bool("bool", PrimitiveType::Bool, false);
 ScalarType ScalarType::Void("void", PrimitiveType::Void, false);
 
+VectorType VectorType::Float4("float4", ScalarType::Float, 4);
+VectorType VectorType::Float8("float8", ScalarType::Float, 8);
+VectorType VectorType::Int4("int4", ScalarType::Int32, 4);
+VectorType VectorType::Int8("int8", ScalarType::Int32, 8);
+
 ScalarType *ScalarType::fromKeyword(const std::string &keyword) {
     if(keyword == "int") {
         return &Int32;
@@ -28,6 +33,29 @@ ScalarType *ScalarType::fromKeyword(const std::string &keyword) {
     }
 }
 
+VectorType *VectorType::fromKeyword(const std::string &keyword) {
+    if(keyword == "float4") {
+        return &Float4;
+    } else if(keyword == "float8") {
+        return &Float8;
+    } else if(keyword == "int4") {
+        return &Int4;
+    } else if(keyword == "int8") {
+        return &Int8;
+    } else {
+        return nullptr;
+    }
+}
+
+VectorType *VectorType::find(const Type &elementType, unsigned laneCount) {
+    for(VectorType *vectorType : { &Float4, &Float8, &Int4, &Int8 }) {
+        if(vectorType->elementType().isSameType(&elementType) && vectorType->laneCount() == laneCount) {
+            return vectorType;
+        }
+    }
+    return nullptr;
+}
+
 
 
 std::string to_string(PrimitiveType dataType) {
@@ -50,8 +78,10 @@ std::string to_string(PrimitiveType dataType) {
 
 Type &ClassMethod::type() const { return symbol_.type(); }
 
-void ClassType::addMethod(const std::string &name, scope::FunctionSymbol &symbol) {
-    methods_.emplace(name, *new ClassMethod(name, symbol));
+void ClassType::addMethod(Atom name, scope::FunctionSymbol &symbol) {
+    auto &method = *new ClassMethod(name, symbol);
+    methods_.emplace(name, method);
+    orderedMethods_.emplace_back(method);
 }
 
 
@@ -77,6 +77,42 @@ public:
         writer_.decIndent();
     }
 
+    void visitingSpawnExpr(SpawnExpr &) override {
+        writer_.writeln("SpawnExpr:");
+        writer_.incIndent();
+    }
+
+    void visitedSpawnExpr(SpawnExpr &) override {
+        writer_.decIndent();
+    }
+
+    void visitingJoinExpr(JoinExpr &) override {
+        writer_.writeln("JoinExpr:");
+        writer_.incIndent();
+    }
+
+    void visitedJoinExpr(JoinExpr &) override {
+        writer_.decIndent();
+    }
+
+    void visitingIndexExpr(IndexExpr &) override {
+        writer_.writeln("IndexExpr:");
+        writer_.incIndent();
+    }
+
+    void visitedIndexExpr(IndexExpr &) override {
+        writer_.decIndent();
+    }
+
+    void visitingIntrinsicCallExpr(IntrinsicCallExpr &expr) override {
+        writer_.writeln("IntrinsicCallExpr(%s):", expr.name().text().c_str());
+        writer_.incIndent();
+    }
+
+    void visitedIntrinsicCallExpr(IntrinsicCallExpr &) override {
+        writer_.decIndent();
+    }
+
     void visitLiteralBoolExpr(LiteralBoolExpr &expr) override {
         writer_.writeln("LiteralBoolExpr: %s", expr.value() ? "true" : "false");
     }
@@ -121,6 +157,15 @@ public:
         writer_.decIndent();
     }
 
+    void visitingForExpr(ForExpr &expr) override {
+        writer_.writeln(expr.isParallel() ? "ForExpr: parallel" : "ForExpr:");
+        writer_.incIndent();
+    }
+
+    void visitedForExpr(ForExpr &) override {
+        writer_.decIndent();
+    }
+
 
     void visitingAssertExprStmt(AssertExprStmt &) override {
         writer_.writeln("AssertExprStmt:");
@@ -139,7 +184,7 @@ public:
     }
 
     void visitingNewExpr(NewExpr &expr) override {
-        writer_.writeln("NewExpr(%s):", expr.typeRef().name().qualifedName().c_str());
+        writer_.writeln(expr.isArray() ? "NewExpr(%s[]):" : "NewExpr(%s):", expr.typeRef().name().qualifedName().c_str());
 
         writer_.incIndent();
     }
@@ -165,7 +210,11 @@ public:
     }
 
     void visitingFuncDefStmt(FuncDefStmt &func) override {
-        writer_.writeln("FuncDefStmt: " + func.name().text());
+        if(func.floatingPointMode() == FloatingPointMode::Default) {
+            writer_.writeln("FuncDefStmt: " + func.name().text());
+        } else {
+            writer_.writeln("FuncDefStmt: " + func.name().text() + " fpmode(" + to_string(func.floatingPointMode()) + ")");
+        }
 //                auto parameters = func.parameters();
 //                for(auto p : parameters) {
 //                    if(p != parameters.front()) {
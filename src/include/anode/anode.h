@@ -7,6 +7,8 @@
 
 
 #include "common/string.h"
+#include <type_traits>
+#include <utility>
 //TO DO:  make these no-ops for release builds.
 #define ASSERT_FAIL(message) \
     throw ::anode::exception::DebugAssertionFailedException(::anode::string::format("%s:%d: Debug assertion failed: %s", __FILE__, __LINE__, message));
@@ -56,6 +58,20 @@ public:
     }
 };
 
+/** Thrown by runtime libraries when an array is indexed outside of its bounds. */
+class AnodeIndexOutOfBoundsException : public std::runtime_error {
+public:
+    explicit AnodeIndexOutOfBoundsException(const std::string &message) : runtime_error(message) {
+    }
+};
+
+/** Thrown by runtime libraries when an array is created with a negative length. */
+class AnodeNegativeArrayLengthException : public std::runtime_error {
+public:
+    explicit AnodeNegativeArrayLengthException(const std::string &message) : runtime_error(message) {
+    }
+};
+
 class FatalException : public Exception {
 public:
     explicit FatalException(const std::string &message) : Exception(message) { }
@@ -76,35 +92,83 @@ public:
 
 } //end namespace exception
 
-template<typename TObject>
-bool isInstanceOf(Object *node) {
-    return dynamic_cast<TObject*>(node);
+namespace detail {
+
+/** True when TObject has a classof(...) member function accepting a pointer to TFrom, i.e. TObject is an AstNode, Type or
+ * Symbol.  Note that every class in those hierarchies must then define its own classof(...) since it is inherited. */
+template<typename TObject, typename TFrom, typename = void>
+struct HasClassof : std::false_type { };
+
+template<typename TObject, typename TFrom>
+struct HasClassof<TObject, TFrom, decltype((void)TObject::classof(std::declval<const TFrom*>()))> : std::true_type { };
+
+template<typename TObject, typename TFrom>
+typename std::enable_if<HasClassof<TObject, TFrom>::value, bool>::type isInstanceOf(const TFrom *from) {
+    return TObject::classof(from);
+}
+
+template<typename TObject, typename TFrom>
+typename std::enable_if<!HasClassof<TObject, TFrom>::value, bool>::type isInstanceOf(const TFrom *from) {
+    return dynamic_cast<const TObject*>(from) != nullptr;
 }
 
-template<typename TObject>
-bool isInstanceOf(Object &node) {
-    return dynamic_cast<TObject*>(&node);
+template<typename TObject, typename TFrom>
+typename std::enable_if<HasClassof<TObject, TFrom>::value, TObject*>::type uncheckedCast(TFrom *from) {
+    return static_cast<TObject*>(from);
 }
 
-template<typename TObject>
-TObject *upcast(Object *node) {
-    TObject *upcasted = dynamic_cast<TObject*>(node);
-    if(!upcasted){
+template<typename TObject, typename TFrom>
+typename std::enable_if<!HasClassof<TObject, TFrom>::value, TObject*>::type uncheckedCast(TFrom *from) {
+    return dynamic_cast<TObject*>(from);
+}
+
+}
+
+/*
+ * isInstanceOf(...), upcast(...) and tryUpcast(...) are the equivalent of LLVM's isa<>, cast<> and dyn_cast<>.  AstNode,
+ * Type and Symbol identify their concrete classes with a kind, which is checked by the static classof(...) member function
+ * of each class, avoiding the cost of dynamic_cast.  Other classes fall back to dynamic_cast.
+ */
+
+template<typename TObject, typename TFrom>
+bool isInstanceOf(TFrom *node) {
+    return node && detail::isInstanceOf<TObject>(node);
+}
+
+template<typename TObject, typename TFrom>
+bool isInstanceOf(TFrom &node) {
+    return detail::isInstanceOf<TObject>(&node);
+}
+
+template<typename TObject, typename TFrom>
+TObject *upcast(TFrom *node) {
+    if(!isInstanceOf<TObject>(node)){
         ASSERT_FAIL("Attempted to perform an invalid upcast");
     }
 
-    return upcasted;
+    return detail::uncheckedCast<TObject>(node);
 }
 
 
-template<typename TObject>
-TObject &upcast(Object &node) {
-    TObject *upcasted = dynamic_cast<TObject*>(&node);
-    if(!upcasted){
+template<typename TObject, typename TFrom>
+TObject &upcast(TFrom &node) {
+    if(!isInstanceOf<TObject>(node)){
         ASSERT_FAIL("Attempted to perform an invalid upcast");
     }
 
-    return *upcasted;
+    return *detail::uncheckedCast<TObject>(&node);
+}
+
+/** Returns nullptr if node is null or not an instance of TObject. */
+template<typename TObject, typename TFrom>
+TObject *tryUpcast(TFrom *node) {
+    return isInstanceOf<TObject>(node) ? detail::uncheckedCast<TObject>(node) : nullptr;
+}
+
+/** Returns nullptr if node is not an instance of TObject. */
+template<typename TObject, typename TFrom>
+TObject *tryUpcast(TFrom &node) {
+    return isInstanceOf<TObject>(node) ? detail::uncheckedCast<TObject>(&node) : nullptr;
 }
 
 
@@ -9,6 +9,8 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #pragma GCC diagnostic ignored "-Wgnu-statement-expression"
 #include <cstring>
+#include <string>
+#include <unordered_map>
 #include <llvm/Target/TargetMachine.h>
 #include "llvm/IR/Module.h"
 #pragma GCC diagnostic pop
@@ -25,7 +27,34 @@ namespace anode { namespace back {
     const char * const ASSERT_FAILED_FUNC_NAME = "__assert_failed__";
     const char * const ASSERT_PASSED_FUNC_NAME = "__assert_passed__";
     const char * const MALLOC_FUNC_NAME = "__malloc__";
-    const char * const EXECUTION_CONTEXT_GLOBAL_NAME = "__execution__context__";
+    const char * const SPAWN_FUNC_NAME = "__spawn__";
+    const char * const JOIN_FUNC_NAME = "__join__";
+    const char * const PARALLEL_FOR_FUNC_NAME = "__parallel_for__";
+    const char * const NEW_ARRAY_FUNC_NAME = "__new_array__";
+    const char * const INDEX_OUT_OF_BOUNDS_FUNC_NAME = "__index_out_of_bounds__";
+    /** Returns the ExecutionContext of the calling thread, see runtime::currentExecutionContext(). */
+    const char * const EXECUTION_CONTEXT_FUNC_NAME = "__execution_context__";
+    /** Registers the counters of an instrumented module, see runtime::instrumentation. */
+    const char * const REGISTER_COUNTERS_FUNC_NAME = "__register_counters__";
+
+    /** The counts written by an instrumented run (see runtime::instrumentation::writeCounters), keyed by counter name. */
+    typedef std::unordered_map<std::string, uint64_t> ProfileCounts;
+
+    /**
+     * How the code of a module is instrumented or optimized according to a profile.  The counters of an instrumented
+     * module are named "<module>;<LLVM function name>;entry" for the number of calls to each function and
+     * "<module>;<LLVM function name>;<kind>.<ordinal>.true" (or ".false") for the number of times each branch of the
+     * function was taken, where kind is "if", "while", "and", "or", "assert", "forGuard" or "forLatch" and the ordinal
+     * counts the branches of that kind within the function.  Thus the names stay the same as long as the source does.
+     * The module's name is included since the internal functions emitted for spawn and parallel for expressions have
+     * the same names in every module.
+     */
+    struct ProfileOptions {
+        /** Count function calls and branches, see runtime::instrumentation. */
+        bool instrument = false;
+        /** Weight branches and functions with the counts of a previous instrumented run, unless null. */
+        const ProfileCounts *counts = nullptr;
+    };
 
     class TypeMap  {
         gc_unordered_map<const front::type::Type *, llvm::Type *> typeMap_;
@@ -39,6 +68,11 @@ namespace anode { namespace back {
             mapTypes(&front::type::ScalarType::Int32, llvm::Type::getInt32Ty(llvmContext_));
             mapTypes(&front::type::ScalarType::Float, llvm::Type::getFloatTy(llvmContext_));
             mapTypes(&front::type::ScalarType::Double, llvm::Type::getDoubleTy(llvmContext_));
+
+            mapTypes(&front::type::VectorType::Float4, llvm::VectorType::get(llvm::Type::getFloatTy(llvmContext_), 4));
+            mapTypes(&front::type::VectorType::Float8, llvm::VectorType::get(llvm::Type::getFloatTy(llvmContext_), 8));
+            mapTypes(&front::type::VectorType::Int4, llvm::VectorType::get(llvm::Type::getInt32Ty(llvmContext_), 4));
+            mapTypes(&front::type::VectorType::Int8, llvm::VectorType::get(llvm::Type::getInt32Ty(llvmContext_), 8));
         }
 
         void mapTypes(front::type::Type *anodeType, llvm::Type *llvmType) {
@@ -48,9 +82,23 @@ namespace anode { namespace back {
         llvm::Type *toLlvmType(front::type::Type &anodeType) {
             ASSERT(&anodeType);
             front::type::Type *actualType = anodeType.actualType();
+            //Handles to tasks are opaque pointers to objects allocated by the runtime.
+            if(isInstanceOf<front::type::TaskType>(actualType)) {
+                return llvm::Type::getInt8PtrTy(llvmContext_);
+            }
+            //Arrays are pointers to a header containing the length followed immediately by the elements.  Literal
+            //structs are uniqued by LLVM so arrays of the same element type always map to the same LLVM type.
+            auto arrayType = tryUpcast<front::type::ArrayType>(actualType);
+            if(arrayType) {
+                llvm::Type *elementType = toLlvmType(arrayType->elementType());
+                return llvm::StructType::get(
+                    llvmContext_,
+                    { llvm::Type::getInt32Ty(llvmContext_), llvm::ArrayType::get(elementType, 0) }
+                )->getPointerTo(0);
+            }
             llvm::Type *foundType = typeMap_[actualType];
             
-            auto classType = dynamic_cast<front::type::ClassType*>(actualType);
+            auto classType = tryUpcast<front::type::ClassType>(actualType);
             if(foundType == nullptr && classType != nullptr) {
                 gc_ref_vector<front::type::ClassField> fields = classType->fields();
 
@@ -74,12 +122,22 @@ namespace anode { namespace back {
         }
     };
 
+    /**
+     * Emits the LLVM IR of a module which has been through passes::runAllPasses(...).  floatingPointMode applies to
+     * the module's code except within functions which specify their own (see ast::FuncDefStmt).  profileOptions
+     * determines whether the module is instrumented or optimized according to a profile.
+     */
     std::unique_ptr<llvm::Module> emitModule(
         anode::front::ast::AnodeWorld &world,
         anode::front::ast::Module *module,
         anode::back::TypeMap &typeMap,
         llvm::LLVMContext &llvmContext,
-        llvm::TargetMachine *targetMachine
+        llvm::TargetMachine *targetMachine,
+        front::ast::FloatingPointMode floatingPointMode = front::ast::FloatingPointMode::Precise,
+        const ProfileOptions &profileOptions = ProfileOptions()
     );
 
+    /** Counts the LLVM instructions in every function of the specified module, for --stats. */
+    unsigned long countInstructions(const llvm::Module &llvmModule);
+
 }}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace anode {
+
+/**
+ * Computes a 64-bit FNV-1a hash incrementally.  This is used to detect when content has changed and is not suitable for
+ * anything requiring resistance to deliberate collisions.
+ */
+class ContentHasher {
+    uint64_t hash_ = 14695981039346656037ull;
+public:
+    void add(const char *bytes, size_t size) {
+        for(size_t i = 0; i < size; ++i) {
+            hash_ ^= (uint8_t)bytes[i];
+            hash_ *= 1099511628211ull;
+        }
+    }
+
+    void add(uint64_t value) {
+        add(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    /** The size is included so that the boundaries between consecutive strings affect the hash. */
+    void add(const std::string &str) {
+        add((uint64_t)str.size());
+        add(str.data(), str.size());
+    }
+
+    uint64_t hash() const { return hash_; }
+};
+
+inline uint64_t contentHash(const std::string &content) {
+    ContentHasher hasher;
+    hasher.add(content.data(), content.size());
+    return hasher.hash();
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "anode.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace anode {
+
+/** A read-only memory mapping of an entire file, which is unmapped when this is destroyed. */
+class MappedFile {
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    NO_COPY_NO_ASSIGN(MappedFile)
+
+    /** Throws exception::Exception if the file cannot be opened or mapped. */
+    explicit MappedFile(const std::string &filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd < 0) {
+            throw exception::Exception("Couldn't open " + filename + ": " + std::strerror(errno));
+        }
+
+        struct stat fileStat{};
+        if(::fstat(fd, &fileStat) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw exception::Exception("Couldn't stat " + filename + ": " + std::strerror(error));
+        }
+
+        size_ = (size_t)fileStat.st_size;
+        //mmap(...) fails when the length is 0.
+        if(size_ > 0) {
+            void *mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw exception::Exception("Couldn't map " + filename + ": " + std::strerror(error));
+            }
+            data_ = static_cast<const char*>(mapped);
+        }
+        //The mapping remains valid after the descriptor is closed.
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if(data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+}
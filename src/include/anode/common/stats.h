@@ -0,0 +1,467 @@
+#pragma once
+
+#include "anode.h"
+#include "common/string.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace anode { namespace stats {
+
+typedef std::chrono::steady_clock clock;
+
+/** Values of the CPU's performance counters, or the difference between two readings of them. */
+struct CounterValues {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+
+    CounterValues &operator+=(const CounterValues &other) {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        cacheMisses += other.cacheMisses;
+        branchMisses += other.branchMisses;
+        return *this;
+    }
+
+    CounterValues operator-(const CounterValues &other) const {
+        CounterValues difference;
+        difference.cycles = cycles - other.cycles;
+        difference.instructions = instructions - other.instructions;
+        difference.cacheMisses = cacheMisses - other.cacheMisses;
+        difference.branchMisses = branchMisses - other.branchMisses;
+        return difference;
+    }
+
+    /** Instructions per cycle. */
+    double ipc() const { return cycles ? (double)instructions / cycles : 0; }
+
+    bool any() const { return cycles || instructions || cacheMisses || branchMisses; }
+};
+
+/**
+ * The CPU's performance counters for the calling thread (see perf_event_open(2)), which count only while the thread
+ * executes in user space.  An event which cannot be counted, because the hardware lacks it or the kernel doesn't permit
+ * it (see /proc/sys/kernel/perf_event_paranoid), always reads as 0.  When there are more events than hardware counters
+ * the kernel multiplexes them and the values are scaled estimates.
+ */
+class HardwareCounters {
+    static const size_t EventCount = 4;
+    int fds_[EventCount];
+
+#ifdef __linux__
+    static int open(uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    uint64_t read(size_t event) const {
+        if(fds_[event] < 0) return 0;
+        //The value followed by the time the event was enabled and the time it was actually counted.
+        uint64_t values[3];
+        if(::read(fds_[event], values, sizeof(values)) != (ssize_t)sizeof(values) || values[2] == 0) return 0;
+        return values[2] < values[1] ? (uint64_t)((double)values[0] * values[1] / values[2]) : values[0];
+    }
+#endif
+
+public:
+    NO_COPY_NO_ASSIGN(HardwareCounters)
+
+    HardwareCounters() {
+#ifdef __linux__
+        fds_[0] = open(PERF_COUNT_HW_CPU_CYCLES);
+        fds_[1] = open(PERF_COUNT_HW_INSTRUCTIONS);
+        fds_[2] = open(PERF_COUNT_HW_CACHE_MISSES);
+        fds_[3] = open(PERF_COUNT_HW_BRANCH_MISSES);
+#else
+        for(int &fd : fds_) fd = -1;
+#endif
+    }
+
+    ~HardwareCounters() {
+#ifdef __linux__
+        for(int fd : fds_) {
+            if(fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    /** True if at least one event is counted. */
+    bool available() const {
+        for(int fd : fds_) {
+            if(fd >= 0) return true;
+        }
+        return false;
+    }
+
+    CounterValues read() const {
+        CounterValues values;
+#ifdef __linux__
+        values.cycles = read(0);
+        values.instructions = read(1);
+        values.cacheMisses = read(2);
+        values.branchMisses = read(3);
+#endif
+        return values;
+    }
+
+    /** The counters of the calling thread, which are opened when first used by that thread. */
+    static HardwareCounters &forThisThread() {
+        thread_local HardwareCounters counters;
+        return counters;
+    }
+};
+
+/**
+ * Accumulated wall time of every execution of a single compiler phase and, if enabled, the hardware events counted on
+ * the thread which executed it.  Work a phase hands to other threads is not counted.
+ */
+struct PhaseTiming {
+    std::string name;
+    unsigned long count = 0;
+    clock::duration elapsed = clock::duration::zero();
+    CounterValues counters;
+};
+
+/** Named values that describe a single module, i.e. the number of AST nodes or LLVM instructions it contains. */
+struct ModuleStatistics {
+    std::string name;
+    std::vector<std::pair<std::string, unsigned long>> values;
+};
+
+class AtomicCounter;
+
+/**
+ * Collects the wall time of each compiler phase, global counters and per-module statistics for --time-passes and --stats.
+ * Nothing is collected unless enabled.  Phases are reported in the order in which they were first executed.  Phases may
+ * be nested (i.e. a template expansion runs passes which are timed individually) so their times should not be summed.
+ */
+class Statistics {
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> hardwareCountersEnabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<PhaseTiming> phases_;
+    std::unordered_map<std::string, size_t> phaseIndex_;
+    std::vector<std::pair<std::string, unsigned long>> counters_;
+    std::unordered_map<std::string, size_t> counterIndex_;
+    std::vector<AtomicCounter*> atomicCounters_;
+    std::vector<ModuleStatistics> modules_;
+    std::unordered_map<std::string, size_t> moduleIndex_;
+
+    static std::string escapeJson(const std::string &str) {
+        std::string escaped;
+        escaped.reserve(str.size());
+        for(char c : str) {
+            switch(c) {
+                case '"': escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\t': escaped += "\\t"; break;
+                default:
+                    if((unsigned char)c < 0x20) {
+                        escaped += string::format("\\u%04x", (unsigned)c);
+                    } else {
+                        escaped += c;
+                    }
+            }
+        }
+        return escaped;
+    }
+
+    static double toMilliseconds(clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    /** The counters followed by each AtomicCounter which has counted anything.  The caller must hold mutex_. */
+    std::vector<std::pair<std::string, unsigned long>> allCounters() const;
+
+    /** Zeroes every AtomicCounter.  The caller must hold mutex_. */
+    void resetAtomicCounters();
+
+    /**
+     * Writes the performance counters of each phase in which any were counted, for writeStatisticsReport(...).  The
+     * caller must hold mutex_.
+     */
+    void writeCountersReport(std::ostream &out) const {
+        out << "===- Anode hardware counters -===\n";
+        bool anyCounted = false;
+        for(const PhaseTiming &timing : phases_) {
+            if(!timing.counters.any()) continue;
+            if(!anyCounted) {
+                out << std::left << std::setw(48) << "Phase" << std::right << std::setw(16) << "Cycles" << std::setw(16)
+                    << "Instructions" << std::setw(6) << "IPC" << std::setw(14) << "Cache misses" << std::setw(14)
+                    << "Branch misses" << "\n";
+                anyCounted = true;
+            }
+            out << std::left << std::setw(48) << timing.name << std::right
+                << std::setw(16) << timing.counters.cycles << std::setw(16) << timing.counters.instructions
+                << std::setw(6) << std::fixed << std::setprecision(2) << timing.counters.ipc()
+                << std::setw(14) << timing.counters.cacheMisses << std::setw(14) << timing.counters.branchMisses << "\n";
+        }
+        if(!anyCounted) {
+            out << "None were counted, perf_event_open(2) is either not supported or not permitted "
+                << "(see /proc/sys/kernel/perf_event_paranoid).\n";
+        }
+    }
+
+public:
+    NO_COPY_NO_ASSIGN(Statistics)
+    Statistics() { }
+
+    bool enabled() const { return enabled_; }
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    bool hardwareCountersEnabled() const { return enabled_ && hardwareCountersEnabled_; }
+
+    /** Whether phases also collect the CPU's performance counters, which requires statistics to be enabled as well. */
+    void setHardwareCountersEnabled(bool enabled) { hardwareCountersEnabled_ = enabled; }
+
+    /** The performance counters of the calling thread, or zeros if they are not enabled. */
+    CounterValues readCounters() const {
+        return hardwareCountersEnabled() ? HardwareCounters::forThisThread().read() : CounterValues();
+    }
+
+    void addTiming(const std::string &phase, clock::duration elapsed, const CounterValues &counters = CounterValues()) {
+        if(!enabled_) return;
+        std::lock_guard<std::mutex> lock{mutex_};
+        auto found = phaseIndex_.find(phase);
+        if(found == phaseIndex_.end()) {
+            found = phaseIndex_.emplace(phase, phases_.size()).first;
+            phases_.emplace_back();
+            phases_.back().name = phase;
+        }
+        PhaseTiming &timing = phases_[found->second];
+        timing.count++;
+        timing.elapsed += elapsed;
+        timing.counters += counters;
+    }
+
+    void increment(const std::string &counter, unsigned long amount = 1) {
+        if(!enabled_) return;
+        std::lock_guard<std::mutex> lock{mutex_};
+        auto found = counterIndex_.find(counter);
+        if(found == counterIndex_.end()) {
+            found = counterIndex_.emplace(counter, counters_.size()).first;
+            counters_.emplace_back(counter, 0);
+        }
+        counters_[found->second].second += amount;
+    }
+
+    /** Called by AtomicCounter's constructor so that its value is reported with the other counters. */
+    void registerCounter(AtomicCounter &counter) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        atomicCounters_.push_back(&counter);
+    }
+
+    /** Adds to the named statistic of the named module. */
+    void addModuleStatistic(const std::string &moduleName, const std::string &statistic, unsigned long amount) {
+        if(!enabled_) return;
+        std::lock_guard<std::mutex> lock{mutex_};
+        auto found = moduleIndex_.find(moduleName);
+        if(found == moduleIndex_.end()) {
+            found = moduleIndex_.emplace(moduleName, modules_.size()).first;
+            modules_.emplace_back();
+            modules_.back().name = moduleName;
+        }
+        auto &values = modules_[found->second].values;
+        for(auto &value : values) {
+            if(value.first == statistic) {
+                value.second += amount;
+                return;
+            }
+        }
+        values.emplace_back(statistic, amount);
+    }
+
+    std::vector<PhaseTiming> phases() const {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return phases_;
+    }
+
+    std::vector<std::pair<std::string, unsigned long>> counters() const {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return allCounters();
+    }
+
+    std::vector<ModuleStatistics> modules() const {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return modules_;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        phases_.clear();
+        phaseIndex_.clear();
+        counters_.clear();
+        counterIndex_.clear();
+        resetAtomicCounters();
+        modules_.clear();
+        moduleIndex_.clear();
+    }
+
+    /** Writes the wall time of each phase in a human readable form (--time-passes). */
+    void writeTimingReport(std::ostream &out) const {
+        std::lock_guard<std::mutex> lock{mutex_};
+        out << "===- Anode phase timing -===\n";
+        out << std::left << std::setw(56) << "Phase" << std::right << std::setw(8) << "Count" << std::setw(14) << "Wall (ms)" << "\n";
+        for(const PhaseTiming &timing : phases_) {
+            out << std::left << std::setw(56) << timing.name
+                << std::right << std::setw(8) << timing.count
+                << std::setw(14) << std::fixed << std::setprecision(3) << toMilliseconds(timing.elapsed) << "\n";
+        }
+    }
+
+    /** Writes the counters and per-module statistics in a human readable form (--stats). */
+    void writeStatisticsReport(std::ostream &out) const {
+        std::lock_guard<std::mutex> lock{mutex_};
+        out << "===- Anode statistics -===\n";
+        for(const auto &counter : allCounters()) {
+            out << std::right << std::setw(12) << counter.second << " " << counter.first << "\n";
+        }
+        for(const ModuleStatistics &module : modules_) {
+            out << "Module '" << module.name << "':\n";
+            for(const auto &value : module.values) {
+                out << std::right << std::setw(12) << value.second << " " << value.first << "\n";
+            }
+        }
+        if(hardwareCountersEnabled()) {
+            writeCountersReport(out);
+        }
+    }
+
+    /** Writes everything that was collected as a single JSON object. */
+    void writeJson(std::ostream &out) const {
+        std::lock_guard<std::mutex> lock{mutex_};
+        out << "{\n  \"phases\": [";
+        for(size_t i = 0; i < phases_.size(); ++i) {
+            const PhaseTiming &timing = phases_[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << escapeJson(timing.name) << "\", \"count\": " << timing.count
+                << ", \"wallMs\": " << std::fixed << std::setprecision(6) << toMilliseconds(timing.elapsed);
+            if(timing.counters.any()) {
+                out << ", \"cycles\": " << timing.counters.cycles << ", \"instructions\": " << timing.counters.instructions
+                    << ", \"cacheMisses\": " << timing.counters.cacheMisses
+                    << ", \"branchMisses\": " << timing.counters.branchMisses;
+            }
+            out << "}";
+        }
+        out << "\n  ],\n  \"counters\": {";
+        std::vector<std::pair<std::string, unsigned long>> counters = allCounters();
+        for(size_t i = 0; i < counters.size(); ++i) {
+            out << (i ? ",\n" : "\n") << "    \"" << escapeJson(counters[i].first) << "\": " << counters[i].second;
+        }
+        out << "\n  },\n  \"modules\": [";
+        for(size_t i = 0; i < modules_.size(); ++i) {
+            const ModuleStatistics &module = modules_[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << escapeJson(module.name) << "\"";
+            for(const auto &value : module.values) {
+                out << ", \"" << escapeJson(value.first) << "\": " << value.second;
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+};
+
+/** The one and only instance of Statistics. */
+inline Statistics &global() {
+    static Statistics statistics;
+    return statistics;
+}
+
+/**
+ * A counter for code which is too hot to take the mutex of Statistics for every event, i.e. the task scheduler.  It only
+ * increments an atomic and is reported with the counters of global() once it has counted anything.  Callers must check
+ * global().enabled() themselves.  Registers itself with global() and is never unregistered, so it must be static.
+ */
+class AtomicCounter {
+    const std::string name_;
+    std::atomic<unsigned long> value_{0};
+public:
+    NO_COPY_NO_ASSIGN(AtomicCounter)
+
+    explicit AtomicCounter(const char *name) : name_{name} {
+        global().registerCounter(*this);
+    }
+
+    const std::string &name() const { return name_; }
+
+    unsigned long value() const { return value_.load(std::memory_order_relaxed); }
+
+    void increment() { value_.fetch_add(1, std::memory_order_relaxed); }
+
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+};
+
+inline std::vector<std::pair<std::string, unsigned long>> Statistics::allCounters() const {
+    std::vector<std::pair<std::string, unsigned long>> counters = counters_;
+    for(const AtomicCounter *counter : atomicCounters_) {
+        if(unsigned long value = counter->value()) {
+            counters.emplace_back(counter->name(), value);
+        }
+    }
+    return counters;
+}
+
+inline void Statistics::resetAtomicCounters() {
+    for(AtomicCounter *counter : atomicCounters_) {
+        counter->reset();
+    }
+}
+
+/**
+ * Adds the wall time of its lifetime (and the performance counters, if enabled) to the named phase, but only if statistics
+ * are enabled when it is constructed.
+ */
+class PhaseTimer {
+    std::string phase_;
+    bool active_;
+    clock::time_point start_;
+    CounterValues startCounters_;
+public:
+    NO_COPY_NO_ASSIGN(PhaseTimer)
+
+    explicit PhaseTimer(const char *phase) : active_{global().enabled()} {
+        if(active_) {
+            phase_ = phase;
+            startCounters_ = global().readCounters();
+            start_ = clock::now();
+        }
+    }
+
+    explicit PhaseTimer(const std::string &phase) : active_{global().enabled()} {
+        if(active_) {
+            phase_ = phase;
+            startCounters_ = global().readCounters();
+            start_ = clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if(active_) {
+            clock::duration elapsed = clock::now() - start_;
+            global().addTiming(phase_, elapsed, global().readCounters() - startCounters_);
+        }
+    }
+};
+
+}}
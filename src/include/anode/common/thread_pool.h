@@ -0,0 +1,128 @@
+#pragma once
+
+#include "anode.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+
+namespace anode {
+
+/**
+ * Registers the calling thread with the garbage collector for the lifetime of this object so that its stack and registers
+ * are scanned for pointers to live objects.  Every thread other than the main thread must do this before allocating or
+ * referencing garbage collected objects.  The thread must have been created after GC_INIT().
+ */
+class GcThreadRegistration {
+    bool registered_;
+public:
+    NO_COPY_NO_ASSIGN(GcThreadRegistration)
+
+    GcThreadRegistration() {
+        GC_stack_base stackBase;
+        GC_get_stack_base(&stackBase);
+        //GC_DUPLICATE is returned if the thread was already registered, in which case it is not ours to unregister.
+        registered_ = GC_register_my_thread(&stackBase) == GC_SUCCESS;
+    }
+
+    ~GcThreadRegistration() {
+        if(registered_) {
+            GC_unregister_my_thread();
+        }
+    }
+};
+
+/**
+ * A fixed number of worker threads which execute submitted tasks in the order they were submitted.  The worker threads are
+ * registered with the garbage collector.
+ *
+ * Tasks must not throw--any exception should be caught and reported by the task itself.
+ */
+class ThreadPool {
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable allTasksComplete_;
+    unsigned runningCount_ = 0;
+    bool stopping_ = false;
+
+    void workerMain() {
+        GcThreadRegistration registration;
+        std::unique_lock<std::mutex> lock{mutex_};
+        while(true) {
+            taskAvailable_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if(tasks_.empty()) {
+                return;
+            }
+            std::function<void()> task = std::move(tasks_.front());
+            tasks_.pop_front();
+            ++runningCount_;
+
+            lock.unlock();
+            task();
+            lock.lock();
+
+            --runningCount_;
+            if(tasks_.empty() && runningCount_ == 0) {
+                allTasksComplete_.notify_all();
+            }
+        }
+    }
+
+public:
+    NO_COPY_NO_ASSIGN(ThreadPool)
+
+    /** A thread count of 0 selects defaultThreadCount(). */
+    explicit ThreadPool(unsigned threadCount = 0) {
+        //Must be called by a registered thread (i.e. the main thread) before any other threads register themselves.
+        GC_allow_register_threads();
+        if(threadCount == 0) {
+            threadCount = defaultThreadCount();
+        }
+        threads_.reserve(threadCount);
+        for(unsigned i = 0; i < threadCount; ++i) {
+            threads_.emplace_back([this] { workerMain(); });
+        }
+    }
+
+    /** Completes all submitted tasks before returning. */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stopping_ = true;
+        }
+        taskAvailable_.notify_all();
+        for(std::thread &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    unsigned threadCount() const { return (unsigned)threads_.size(); }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            ASSERT(!stopping_);
+            tasks_.emplace_back(std::move(task));
+        }
+        taskAvailable_.notify_one();
+    }
+
+    /** Blocks until every task submitted so far has completed. */
+    void waitForAll() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        allTasksComplete_.wait(lock, [this] { return tasks_.empty() && runningCount_ == 0; });
+    }
+
+    /** The number of hardware threads, or 1 if that can't be determined. */
+    static unsigned defaultThreadCount() {
+        unsigned count = std::thread::hardware_concurrency();
+        return count ? count : 1;
+    }
+};
+
+}
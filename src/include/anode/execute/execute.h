@@ -2,8 +2,11 @@
 #pragma once
 #include "anode.h"
 #include "../front/ast.h"
+#include "common/stats.h"
 
 #include <functional>
+#include <istream>
+#include <ostream>
 
 namespace anode { namespace execute {
 //        typedef float (*FloatFuncPtr)(void);
@@ -88,21 +91,91 @@ public:
 
     virtual void setPrettyPrintAst(bool value) = 0;
     virtual void setDumpIROnLoad(bool value) = 0;
+
+    /**
+     * The floating point mode of modules compiled from now on, except within functions which specify their own (see
+     * front::ast::FloatingPointMode).  The default is FloatingPointMode::Precise.
+     */
+    virtual void setFloatingPointMode(front::ast::FloatingPointMode mode) = 0;
+
+    /**
+     * The optimization level (0-3) of modules compiled from now on, where 0 (the default) skips the optimization passes.
+     * Since every ExecutionContext shares the same JIT this affects them all.
+     */
+    virtual void setOptimizationLevel(unsigned level) = 0;
     virtual bool prepareModule(front::ast::Module *) = 0;
 
+    /** The world shared by every module prepared by this ExecutionContext. */
+    virtual front::ast::AnodeWorld &world() = 0;
+
     typedef std::function<void(ExecutionContext*, front::type::PrimitiveType, void*)> ResultCallbackFunctor;
 
     virtual void setResultCallback(ResultCallbackFunctor functor) = 0;
 
+    /**
+     * Enables the cache of analyzed and compiled modules, which are stored in the specified directory as module interfaces.
+     * A module is cached under a key computed by the caller which must identify its source as well as anything it may
+     * reference other than its imports, such as the globals of the modules executed before it.  Only modules whose
+     * interfaces export everything they define are cached.
+     */
+    virtual void setModuleCacheDirectory(const std::string &directory) = 0;
+
+    /** True if a module has been cached under cacheKey, in which case executeCachedModule(...) will most likely succeed. */
+    virtual bool hasCachedModule(uint64_t cacheKey) = 0;
+
+    /**
+     * Loads and executes the module named moduleName which was cached under cacheKey, skipping parsing, semantic analysis
+     * and code generation.  Returns false if nothing was executed, because the module isn't cached or because the
+     * interface of one of its imports has changed since it was cached.
+     */
+    virtual bool executeCachedModule(const std::string &moduleName, uint64_t cacheKey) = 0;
+
+    /** Like executeModule(...) but also caches the module under cacheKey if caching is enabled. */
+    virtual void executeAndCacheModule(front::ast::Module *module, const std::string &sourceText, uint64_t cacheKey) = 0;
+
     /** Loads the specified module and executes its initialization function. */
     void executeModule(front::ast::Module *module) {
         ASSERT(module);
         uint64_t funcPtr = loadModule(module);
         //void (*func)() = reinterpret_cast<__attribute__((cdecl)) void (*)(void)>(funcPtr);
         void (*func)() = reinterpret_cast<void (*)(void)>(funcPtr);
+        stats::PhaseTimer timer{"execute.initModule"};
         func();
     };
 };
 
 std::unique_ptr<ExecutionContext> createExecutionContext();
+
+/**
+ * Starts sampling the stacks of the threads executing code, frequency times per second of CPU time (see
+ * runtime/profiler.h).  Should be invoked before any module is compiled, since only code compiled afterwards keeps its
+ * frame pointers.
+ */
+void startProfiler(unsigned frequency);
+
+/**
+ * Stops the profiler and writes the samples as folded stacks (one line per distinct stack, its frames separated by ';'
+ * and followed by the number of samples), which flame graph tools accept.  Returns the number of samples which were
+ * dropped because there were too many.
+ */
+size_t writeProfile(std::ostream &out);
+
+/**
+ * Whether the modules compiled from now on are instrumented to count the calls to each of their functions and how many
+ * times each destination of each of their branches is taken (see back::ProfileOptions).  The counts are written by
+ * writeInstrumentationProfile(...).
+ */
+void setInstrumentationEnabled(bool enabled);
+
+/** Writes the counts of every instrumented module loaded so far and returns the number of counters written. */
+size_t writeInstrumentationProfile(std::ostream &out);
+
+/**
+ * Reads counts written by writeInstrumentationProfile(...) and uses them to optimize the modules compiled from now on:
+ * their branches are weighted by how many times each destination was taken and their functions by how many times they
+ * were called.  Counts are matched to functions and branches by name (see back::ProfileOptions), so those of functions
+ * whose source has changed since may be misattributed.  Throws ExecutionException if the profile is malformed or names a
+ * counter more than once.
+ */
+void useInstrumentationProfile(std::istream &in);
 }}
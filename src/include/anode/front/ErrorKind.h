@@ -23,6 +23,7 @@ BETTER_ENUM(
     Syntax,
     SurpriseToken,
     CannotNestTemplates,
+    InvalidUnrollCount,
 
     //Semantic errors
     InvalidImplicitCastInBinaryExpr,
@@ -63,7 +64,36 @@ BETTER_ENUM(
     IdentifierIsNotNamespace,
     ChildNamespaceDoesNotExist,
     MemberOfNamespaceIsNotNamespace,
-    NamespaceMemberDoesNotExist
+    NamespaceMemberDoesNotExist,
+
+    //Import related
+    ImportedModuleNotFound,
+    ImportedModuleFailed,
+    CircularImport,
+
+    //Task related
+    SpawnedExpressionIsNotFunctionCall,
+    JoinedExpressionIsNotTask,
+
+    //Loop related
+    RangeBoundIsNotInt,
+    ReducedExpressionIsNotNumeric,
+    CannotAssignToLoopVariable,
+
+    //Array related
+    IndexedExpressionIsNotArray,
+    ArrayIndexIsNotInt,
+    ArrayLengthIsNotInt,
+
+    //Vector related
+    ArgumentIsNotVector,
+    VectorTypeMismatch,
+    LaneIndexOutOfRange,
+    ShuffleLaneIsNotLiteralInt,
+    InvalidShuffleLaneCount,
+    //Math intrinsic related
+    InvalidMathArgumentType,
+    FunctionNameIsIntrinsic
 );
 
 }}}
\ No newline at end of file
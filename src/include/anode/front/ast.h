@@ -31,12 +31,17 @@ class MethodRefExpr;
 //class ReturnStmt;
 class IfExprStmt;
 class WhileExpr;
+class ForExpr;
+class IndexExpr;
+class IntrinsicCallExpr;
 class LiteralBoolExpr;
 class LiteralInt32Expr;
 class LiteralFloatExpr;
 class UnaryExpr;
 class BinaryExpr;
 class DotExpr;
+class SpawnExpr;
+class JoinExpr;
 class VariableDeclExpr;
 class VariableRefExpr;
 class CastExpr;
@@ -56,6 +61,9 @@ class AstVisitor : public gc {
 public:
     virtual bool shouldVisitChildren() { return true; }
 
+    /** Invoked by runPasses(...) before visiting a node whose enclosing scopes will not be visited. */
+    virtual void pushStartingScope(scope::SymbolTable &) { }
+
     //////////// Statements
     virtual void visitingParameterDef(ParameterDef &) { }
     virtual void visitedParameterDef(ParameterDef &) { }
@@ -91,6 +99,9 @@ public:
     virtual void visitingWhileExpr(WhileExpr &) { }
     virtual void visitedWhileExpr(WhileExpr &) { }
 
+    virtual void visitingForExpr(ForExpr &) { }
+    virtual void visitedForExpr(ForExpr &) { }
+
     virtual void visitingBinaryExpr(BinaryExpr &) { }
     virtual void visitedBinaryExpr(BinaryExpr &) { }
 
@@ -116,6 +127,18 @@ public:
     virtual void visitingDotExpr(DotExpr &) { }
     virtual void visitedDotExpr(DotExpr &) { }
 
+    virtual void visitingSpawnExpr(SpawnExpr &) { }
+    virtual void visitedSpawnExpr(SpawnExpr &) { }
+
+    virtual void visitingJoinExpr(JoinExpr &) { }
+    virtual void visitedJoinExpr(JoinExpr &) { }
+
+    virtual void visitingIndexExpr(IndexExpr &) { }
+    virtual void visitedIndexExpr(IndexExpr &) { }
+
+    virtual void visitingIntrinsicCallExpr(IntrinsicCallExpr &) { }
+    virtual void visitedIntrinsicCallExpr(IntrinsicCallExpr &) { }
+
     virtual void visitingCompoundExpr(CompoundExpr &) { }
     virtual void visitedCompoundExpr(CompoundExpr &) { }
 
@@ -147,18 +170,23 @@ public:
 
 
 extern unsigned long astNodesDestroyedCount;
+/** The number of AST nodes created by the current thread, used to report per-module node counts with --stats. */
+extern thread_local unsigned long astNodesCreatedCount;
 
 
 class Identifier {
     source::SourceSpan span_;
-    std::string text_;
+    Atom text_;
 
 public:
     Identifier(const Identifier &) = default;
+    Identifier(source::SourceSpan span, Atom text)
+        : span_(span), text_(text) { }
     Identifier(source::SourceSpan span, const std::string &text)
         : span_(span), text_(text) { }
 
-    const std::string &text() const { return text_; }
+    const std::string &text() const { return text_.text(); }
+    Atom atom() const { return text_; }
     const source::SourceSpan &span() const { return span_; }
 
 };
@@ -228,6 +256,52 @@ public:
     }
 };
 
+/**
+ * Identifies the concrete class of an AstNode without RTTI.  Subclasses of each abstract class are listed contiguously so
+ * that the classof(...) member function of each abstract class can check a range.
+ */
+enum class AstNodeKind : unsigned char {
+    //TypeRef
+    KnownTypeRef,
+    ResolutionDeferredTypeRef,
+    //Stmt
+    TemplateParameter,
+    //ExprStmt
+    ExpressionList,
+    CompoundExpr,
+    TemplateExpansionExprStmt,
+    LiteralBoolExpr,
+    LiteralInt32Expr,
+    LiteralFloatExpr,
+    UnaryExpr,
+    BinaryExpr,
+    VariableRefExpr,
+    VariableDeclExpr,
+    CastExpr,
+    NewExpr,
+    IfExprStmt,
+    MethodRefExpr,
+    FuncCallExpr,
+    DotExpr,
+    SpawnExpr,
+    JoinExpr,
+    ForExpr,
+    IndexExpr,
+    IntrinsicCallExpr,
+    //VoidExprStmt
+    AnonymousTemplateExprStmt,
+    NamedTemplateExprStmt,
+    WhileExpr,
+    FuncDefStmt,
+    NamespaceExpr,
+    CompleteClassDefinition,
+    GenericClassDefinition,
+    AssertExprStmt,
+    //Others
+    ParameterDef,
+    Module
+};
+
 /** Base class for all nodes */
 class AstNode : public Object {
     UniqueId nodeId_;
@@ -240,6 +314,10 @@ public:
         astNodesDestroyedCount++;
     }
 
+    /** Identifies the concrete class of this node, see isInstanceOf(...), upcast(...) and tryUpcast(...). */
+    virtual AstNodeKind nodeKind() const = 0;
+    static bool classof(const AstNode *) { return true; }
+
     UniqueId nodeId() { return nodeId_; }
 
     virtual void accept(AstVisitor &visitor) = 0;
@@ -254,6 +332,10 @@ protected:
     explicit Stmt(const source::SourceSpan &sourceSpan) : sourceSpan_(sourceSpan) { }
     explicit Stmt(const Stmt &from) : AstNode(from), sourceSpan_{from.sourceSpan_} {}
 public:
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::TemplateParameter && node->nodeKind() <= AstNodeKind::AssertExprStmt;
+    }
+
     //virtual StmtKind stmtKind() const = 0;
 
     const source::SourceSpan &sourceSpan() const {
@@ -267,6 +349,10 @@ class TypeRef : public AstNode {
 protected:
     TypeRef(const source::SourceSpan &sourceSpan) : sourceSpan_{sourceSpan} { }
 public:
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::KnownTypeRef && node->nodeKind() <= AstNodeKind::ResolutionDeferredTypeRef;
+    }
+
     source::SourceSpan sourceSpan() const {
 
 
@@ -284,6 +370,9 @@ class KnownTypeRef : public TypeRef {
     type::Type &referencedType_;
     const MultiPartIdentifier name_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::KnownTypeRef; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::KnownTypeRef; }
+
     KnownTypeRef(source::SourceSpan sourceSpan, type::Type &dataType)
         : TypeRef(sourceSpan), referencedType_{dataType}, name_{
                 MultiPartIdentifier(Identifier(source::SourceSpan::Any, referencedType_.name()))}
@@ -302,10 +391,14 @@ public:
 };
 
 
-/** A reference to a data type that doesn't exist at parse time. i.e.: classes.  Resolved during an AST pass. */
+/**
+ * A reference to a data type that doesn't exist at parse time. i.e.: classes.  Resolved during an AST pass.  A reference
+ * to an array type (i.e. "SomeClass[]") refers to the type of its elements with another ResolutionDeferredTypeRef.
+ */
 class ResolutionDeferredTypeRef : public TypeRef {
     const MultiPartIdentifier name_;
     gc_ref_vector<ResolutionDeferredTypeRef> templateArgs_;
+    ResolutionDeferredTypeRef *elementTypeRef_ = nullptr;
     type::ResolutionDeferredType *referencedType_;
 
     inline static gc_ref_vector<type::Type> getTypesFromTypeRefs(const gc_ref_vector<ResolutionDeferredTypeRef> &typeRefs) {
@@ -317,11 +410,27 @@ class ResolutionDeferredTypeRef : public TypeRef {
         return types;
     }
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::ResolutionDeferredTypeRef; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::ResolutionDeferredTypeRef; }
+
     ResolutionDeferredTypeRef(const source::SourceSpan &sourceSpan, const MultiPartIdentifier &name, const gc_ref_vector<ResolutionDeferredTypeRef> &args)
         : TypeRef(sourceSpan), name_{name}, templateArgs_{args}, referencedType_(new type::ResolutionDeferredType(getTypesFromTypeRefs(templateArgs_))) { }
 
+    /** A reference to an array of the type referenced by elementTypeRef. */
+    ResolutionDeferredTypeRef(const source::SourceSpan &sourceSpan, ResolutionDeferredTypeRef &elementTypeRef)
+        : TypeRef(sourceSpan),
+          name_{elementTypeRef.name()},
+          elementTypeRef_{&elementTypeRef},
+          referencedType_(new type::ResolutionDeferredType(gc_ref_vector<type::Type>())) { }
+
     const MultiPartIdentifier &name() const override { return name_; }
 
+    bool isArray() const { return elementTypeRef_ != nullptr; }
+    ResolutionDeferredTypeRef &elementTypeRef() const {
+        ASSERT(elementTypeRef_);
+        return *elementTypeRef_;
+    }
+
     type::Type &type() const override {
          return *referencedType_;
     }
@@ -350,6 +459,9 @@ public:
     }
 
     void accept(AstVisitor &visitor) override {
+        if(elementTypeRef_) {
+            elementTypeRef_->accept(visitor);
+        }
         for(ResolutionDeferredTypeRef &ta : templateArgs_) {
             ta.accept(visitor);
         }
@@ -357,6 +469,11 @@ public:
     }
 
     TypeRef& deepCopyForTemplate() const override {
+        if(elementTypeRef_) {
+            return *new ResolutionDeferredTypeRef(
+                sourceSpan(),
+                upcast<ResolutionDeferredTypeRef>(elementTypeRef_->deepCopyForTemplate()));
+        }
         gc_ref_vector<ResolutionDeferredTypeRef> templateArgs;
         for(ResolutionDeferredTypeRef &ta : templateArgs_) {
             templateArgs.emplace_back(upcast<ResolutionDeferredTypeRef>(ta.deepCopyForTemplate()));
@@ -389,6 +506,9 @@ typedef gc_ref_vector<TemplateArgument> TemplateArgVector;
 class TemplateParameter : public Stmt {
     const Identifier name_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::TemplateParameter; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::TemplateParameter; }
+
     TemplateParameter(const source::SourceSpan &sourceSpan, const Identifier &name) : Stmt(sourceSpan), name_{name} { }
 
     const Identifier &name() const { return name_; }
@@ -422,6 +542,10 @@ protected:
     explicit ExprStmt(const source::SourceSpan &sourceSpan) : Stmt(sourceSpan) { }
     explicit ExprStmt(const ExprStmt &from) : Stmt(from) { }
 public:
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::ExpressionList && node->nodeKind() <= AstNodeKind::AssertExprStmt;
+    }
+
     ~ExprStmt() override = default;
 
     virtual type::Type &exprType() const  = 0;
@@ -435,6 +559,10 @@ class VoidExprStmt : public ExprStmt {
 protected:
     VoidExprStmt(const source::SourceSpan &sourceSpan) : ExprStmt(sourceSpan) { }
 public:
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::AnonymousTemplateExprStmt && node->nodeKind() <= AstNodeKind::AssertExprStmt;
+    }
+
     type::Type &exprType() const override { return type::ScalarType::Void; };
     bool canWrite() const override { return false; }
 };
@@ -443,6 +571,9 @@ public:
 class ExpressionList : public ExprStmt {
     gc_ref_vector<ExprStmt> expressions_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::ExpressionList; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::ExpressionList; }
+
     ExpressionList(source::SourceSpan sourceSpan, const gc_ref_vector<ExprStmt> &expressions)
         : ExprStmt(sourceSpan),
           expressions_{expressions}
@@ -494,6 +625,9 @@ class CompoundExpr : public ExprStmt {
     scope::SymbolTable scope_;
     gc_ref_vector<ExprStmt> expressions_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::CompoundExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::CompoundExpr; }
+
     CompoundExpr(
         source::SourceSpan sourceSpan,
         scope::StorageKind storageKind,
@@ -543,7 +677,7 @@ public:
         for(ExprStmt &exprStmt : expressions_) {
             clonedExprs.emplace_back(exprStmt.deepCopyExpandTemplate(expansionContext));
         }
-        return *new CompoundExpr(sourceSpan_, scope_.storageKind(), clonedExprs, scope_.name());
+        return *new CompoundExpr(sourceSpan_, scope_.storageKind(), clonedExprs, scope_.name().text());
     }
 
 };
@@ -567,6 +701,11 @@ protected:
     }
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::AnonymousTemplateExprStmt; }
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::AnonymousTemplateExprStmt && node->nodeKind() <= AstNodeKind::NamedTemplateExprStmt;
+    }
+
     AnonymousTemplateExprStmt(
         const source::SourceSpan &sourceSpan,
         const gc_ref_vector<ast::TemplateParameter> &parameters,
@@ -604,6 +743,9 @@ public:
 class NamedTemplateExprStmt : public AnonymousTemplateExprStmt {
     const Identifier name_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::NamedTemplateExprStmt; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::NamedTemplateExprStmt; }
+
     NamedTemplateExprStmt(
         const source::SourceSpan &sourceSpan,
         const Identifier &name,
@@ -642,6 +784,9 @@ class TemplateExpansionExprStmt : public ExprStmt {
     scope::SymbolTable templateParameterScope_;
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::TemplateExpansionExprStmt; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::TemplateExpansionExprStmt; }
+
     TemplateExpansionExprStmt(
         source::SourceSpan sourceSpan,
         const MultiPartIdentifier &templateName,
@@ -696,6 +841,9 @@ public:
 class LiteralBoolExpr : public ExprStmt {
     bool const value_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::LiteralBoolExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::LiteralBoolExpr; }
+
     LiteralBoolExpr(source::SourceSpan sourceSpan, const bool value) : ExprStmt(sourceSpan), value_(value) {}
     type::Type &exprType() const override { return type::ScalarType::Bool; }
     bool value() const { return value_; }
@@ -715,6 +863,9 @@ public:
 class LiteralInt32Expr : public ExprStmt {
     int const value_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::LiteralInt32Expr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::LiteralInt32Expr; }
+
     LiteralInt32Expr(source::SourceSpan sourceSpan, const int value) : ExprStmt(sourceSpan), value_(value) {}
     type::Type &exprType() const override { return type::ScalarType::Int32; }
     int value() const { return value_; }
@@ -734,6 +885,9 @@ public:
 class LiteralFloatExpr : public ExprStmt {
     float const value_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::LiteralFloatExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::LiteralFloatExpr; }
+
     LiteralFloatExpr(source::SourceSpan sourceSpan, const float value) : ExprStmt(sourceSpan), value_(value) {}
 
     type::Type &exprType() const override {  return type::ScalarType::Float; }
@@ -764,6 +918,9 @@ class UnaryExpr : public ExprStmt {
     const UnaryOperationKind operation_;
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::UnaryExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::UnaryExpr; }
+
     /** Constructs a new Binary expression.  Note: assumes ownership of lValue and rValue */
     UnaryExpr(source::SourceSpan sourceSpan, ExprStmt &valueExpr, UnaryOperationKind operation, source::SourceSpan operatorSpan)
         : ExprStmt{sourceSpan}, operatorSpan_{operatorSpan}, valueExpr_{&valueExpr}, operation_{operation} {
@@ -838,6 +995,9 @@ class BinaryExpr : public ExprStmt {
     const source::SourceSpan operatorSpan_;
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::BinaryExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::BinaryExpr; }
+
     /** Constructs a new Binary expression.  Note: assumes ownership of lValue and rValue */
     BinaryExpr(source::SourceSpan sourceSpan,
     ExprStmt &lValue,
@@ -956,6 +1116,11 @@ protected:
     };
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::VariableRefExpr; }
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::VariableRefExpr && node->nodeKind() <= AstNodeKind::VariableDeclExpr;
+    }
+
     VariableRefExpr(source::SourceSpan sourceSpan, const MultiPartIdentifier &name, VariableAccess access = VariableAccess::Read)
         : ExprStmt(sourceSpan), access_{access}, name_{ name } { }
 
@@ -995,6 +1160,9 @@ class VariableDeclExpr : public VariableRefExpr {
 private:
     explicit VariableDeclExpr(const VariableDeclExpr &copyFrom) : VariableRefExpr(copyFrom), typeRef_{copyFrom.typeRef_.deepCopyForTemplate()} { }
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::VariableDeclExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::VariableDeclExpr; }
+
     VariableDeclExpr(source::SourceSpan sourceSpan, const MultiPartIdentifier &name, TypeRef& typeRef, VariableAccess access = VariableAccess::Read)
         : VariableRefExpr(sourceSpan, name, access),
           typeRef_(typeRef)
@@ -1036,6 +1204,9 @@ class CastExpr : public ExprStmt {
     const CastKind castKind_;
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::CastExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::CastExpr; }
+
     /** Use this constructor when the type::Type of the cast *is* known in advance. */
     CastExpr(source::SourceSpan sourceSpan, type::Type &toType, ExprStmt& valueExpr, CastKind castKind)
         : ExprStmt(sourceSpan), toType_(*new KnownTypeRef(sourceSpan, toType)), valueExpr_(valueExpr), castKind_(castKind)
@@ -1076,12 +1247,20 @@ public:
 };
 
 /** Represents a new expression... i.e. foo:int= new<int>(someDouble); */
+/**
+ * Allocates an instance of a class, i.e. "new SomeClass()", or an array, i.e. "new int[length]".  The typeRef of the
+ * latter refers to the type of the array and not that of its elements.
+ */
 class NewExpr : public ExprStmt {
     TypeRef &typeRef_;
+    ExprStmt *lengthExpr_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::NewExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::NewExpr; }
+
 
-    NewExpr(source::SourceSpan sourceSpan, TypeRef &typeRef)
-        : ExprStmt(sourceSpan), typeRef_(typeRef)
+    NewExpr(source::SourceSpan sourceSpan, TypeRef &typeRef, ExprStmt *lengthExpr = nullptr)
+        : ExprStmt(sourceSpan), typeRef_(typeRef), lengthExpr_{lengthExpr}
     {
         ASSERT(&typeRef);
     }
@@ -1089,6 +1268,10 @@ public:
     type::Type &exprType() const  override { return typeRef_.type(); }
     TypeRef &typeRef() const { return typeRef_; }
 
+    bool isArray() const { return lengthExpr_ != nullptr; }
+    /** The number of elements of the new array, or null if this allocates an instance of a class. */
+    ExprStmt *lengthExpr() const { return lengthExpr_; }
+
     virtual bool canWrite() const override { return false; };
 
     void accept(AstVisitor &visitor) override {
@@ -1096,13 +1279,19 @@ public:
 
         if(visitor.shouldVisitChildren()) {
             typeRef_.accept(visitor);
+            if(lengthExpr_) {
+                lengthExpr_->accept(visitor);
+            }
         }
 
         visitor.visitedNewExpr(*this);
     }
 
-    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &) const override {
-        return *new NewExpr(sourceSpan_, typeRef_.deepCopyForTemplate());
+    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &expansionContext) const override {
+        return *new NewExpr(
+            sourceSpan_,
+            typeRef_.deepCopyForTemplate(),
+            lengthExpr_ ? &lengthExpr_->deepCopyExpandTemplate(expansionContext) : nullptr);
     }
 };
 
@@ -1112,6 +1301,9 @@ class IfExprStmt : public ExprStmt {
     ExprStmt* thenExpr_;
     ExprStmt* elseExpr_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::IfExprStmt; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::IfExprStmt; }
+
 
     /** Note:  assumes ownership of condition, truePart and falsePart.  */
     IfExprStmt(source::SourceSpan sourceSpan,
@@ -1171,6 +1363,9 @@ class WhileExpr : public VoidExprStmt {
     ExprStmt* condition_;
     ExprStmt& body_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::WhileExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::WhileExpr; }
+
 
     /** Note:  assumes ownership of condition, truePart and falsePart.  */
     WhileExpr(source::SourceSpan sourceSpan,
@@ -1211,12 +1406,116 @@ public:
     }
 };
 
+/** The operator with which the values of the iterations of a reducing ForExpr are combined. */
+enum class ReductionKind : unsigned char {
+    None,
+    Add,
+    Mul,
+    Min,
+    Max
+};
+
+/** Hints for the optimizer which are attached to the loop emitted for a ForExpr, i.e. "for(i in 0..n) vectorize unroll(4)". */
+struct LoopHints {
+    bool vectorize = false;
+    /** The number of times the loop should be unrolled, where 0 leaves it to the optimizer and 1 disables unrolling. */
+    unsigned unrollCount = 0;
+
+    bool any() const { return vectorize || unrollCount > 0; }
+};
+
+/**
+ * A loop over the half-open range of integers [rangeBegin, rangeEnd), i.e. "for(i in 0..10) body".  The loop variable is
+ * declared in a scope of its own.  A parallel for ("parallel for(i in 0..10) body") executes its iterations concurrently
+ * on the worker threads of the runtime.
+ *
+ * A loop without a reduction is void.  One with a reduction ("for(i in 0..10) reduce(+) body") evaluates to the values of
+ * the body combined with the reduction's operator, or the operator's identity if the range is empty.
+ *
+ * Either may be followed by LoopHints, which come after the reduction if there is one.
+ */
+class ForExpr : public ExprStmt {
+    scope::SymbolTable scope_;
+    VariableDeclExpr &inductionVar_;
+    ExprStmt &rangeBegin_;
+    ExprStmt &rangeEnd_;
+    ExprStmt &body_;
+    const bool isParallel_;
+    const ReductionKind reduction_;
+    const LoopHints hints_;
+public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::ForExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::ForExpr; }
+
+    ForExpr(source::SourceSpan sourceSpan,
+            VariableDeclExpr &inductionVar,
+            ExprStmt &rangeBegin,
+            ExprStmt &rangeEnd,
+            ExprStmt &body,
+            bool isParallel,
+            ReductionKind reduction,
+            LoopHints hints)
+        : ExprStmt(sourceSpan),
+          scope_{scope::StorageKind::Local, "for"},
+          inductionVar_{inductionVar},
+          rangeBegin_{rangeBegin},
+          rangeEnd_{rangeEnd},
+          body_{body},
+          isParallel_{isParallel},
+          reduction_{reduction},
+          hints_{hints} { }
+
+    scope::SymbolTable &scope() { return scope_; }
+    VariableDeclExpr &inductionVar() const { return inductionVar_; }
+    ExprStmt &rangeBegin() const { return rangeBegin_; }
+    ExprStmt &rangeEnd() const { return rangeEnd_; }
+    ExprStmt &body() const { return body_; }
+    bool isParallel() const { return isParallel_; }
+    ReductionKind reduction() const { return reduction_; }
+    const LoopHints &hints() const { return hints_; }
+
+    type::Type &exprType() const override {
+        return reduction_ == ReductionKind::None ? type::ScalarType::Void : body_.exprType();
+    }
+
+    bool canWrite() const override { return false; };
+
+    /** The range is visited before the loop variable so that referencing the loop variable within it is an error. */
+    void accept(AstVisitor &visitor) override {
+        visitor.visitingForExpr(*this);
+
+        if(visitor.shouldVisitChildren()) {
+            rangeBegin_.accept(visitor);
+            rangeEnd_.accept(visitor);
+            inductionVar_.accept(visitor);
+            body_.accept(visitor);
+        }
+
+        visitor.visitedForExpr(*this);
+    }
+
+    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &expansionContext) const override {
+        return *new ForExpr(
+            sourceSpan_,
+            upcast<VariableDeclExpr>(inductionVar_.deepCopyExpandTemplate(expansionContext)),
+            rangeBegin_.deepCopyExpandTemplate(expansionContext),
+            rangeEnd_.deepCopyExpandTemplate(expansionContext),
+            body_.deepCopyExpandTemplate(expansionContext),
+            isParallel_,
+            reduction_,
+            hints_);
+    }
+};
+
 class ParameterDef : public AstNode {
     source::SourceSpan span_;
     const Identifier name_;
     TypeRef& typeRef_;
     scope::VariableSymbol *symbol_ = nullptr;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::ParameterDef; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::ParameterDef; }
+
     ParameterDef(source::SourceSpan span, const Identifier &name, TypeRef &typeRef)
         : span_{span}, name_{name}, typeRef_{typeRef} { }
 
@@ -1246,6 +1545,25 @@ public:
 };
 type::FunctionType &createFunctionType(type::Type &returnType, const gc_ref_vector<ParameterDef> &parameters);
 
+/**
+ * How strictly floating point arithmetic follows IEEE 754, from the most to the least strict.  Relaxing it lets LLVM
+ * fuse multiplications and additions into FMAs (Contract) and also reassociate operations, which vectorizing floating
+ * point reductions requires, and assume that there are no NaNs or infinities (Fast).
+ */
+enum class FloatingPointMode : unsigned char {
+    /** The mode of the module, see back::emitModule(...). */
+    Default,
+    Precise,
+    Contract,
+    Fast
+};
+
+std::string to_string(FloatingPointMode mode);
+
+/**
+ * A function definition, i.e. "func add:int(a:int, b:int) a + b".  The parameters may be followed by "fpmode(fast)",
+ * "fpmode(contract)" or "fpmode(precise)", which overrides the FloatingPointMode of the module within the function.
+ */
 class FuncDefStmt : public VoidExprStmt {
     const Identifier name_;
     scope::FunctionSymbol *symbol_= nullptr;
@@ -1254,26 +1572,31 @@ class FuncDefStmt : public VoidExprStmt {
     gc_ref_vector<ParameterDef> parameters_;
     ExprStmt* body_;
     type::FunctionType &functionType_;
+    const FloatingPointMode floatingPointMode_;
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::FuncDefStmt; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::FuncDefStmt; }
+
     FuncDefStmt(
         source::SourceSpan sourceSpan,
         const Identifier &name,
         TypeRef& returnTypeRef,
         gc_ref_vector<ParameterDef> parameters,
-        ExprStmt& body
+        ExprStmt& body,
+        FloatingPointMode floatingPointMode = FloatingPointMode::Default
     ) : VoidExprStmt(sourceSpan),
         name_{name},
         parameterScope_{scope::StorageKind::Argument, name.text() + scope::ScopeSeparator + "parameters"},
         returnTypeRef_{returnTypeRef},
         parameters_{parameters},
         body_{&body},
-        functionType_{createFunctionType(returnTypeRef.type(), parameters)}
-    {
-        parameterScope_.name() = name_.text() + "-parameters";
-    }
+        functionType_{createFunctionType(returnTypeRef.type(), parameters)},
+        floatingPointMode_{floatingPointMode}
+    { }
 
     const Identifier &name() const { return name_; }
+    FloatingPointMode floatingPointMode() const { return floatingPointMode_; }
     type::Type &returnType() const { return *functionType_.returnType(); }
     type::FunctionType &functionType() { return functionType_; }
     scope::SymbolTable &parameterScope() { return parameterScope_; };
@@ -1315,7 +1638,8 @@ public:
                                name_,
                                returnTypeRef_.deepCopyForTemplate(),
                                clonedParameters,
-                                body_->deepCopyExpandTemplate(expansionContext));
+                               body_->deepCopyExpandTemplate(expansionContext),
+                               floatingPointMode_);
     }
 };
 
@@ -1323,6 +1647,9 @@ class MethodRefExpr : public ExprStmt {
     const Identifier name_;
     scope::FunctionSymbol *symbol_ = nullptr;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::MethodRefExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::MethodRefExpr; }
+
     explicit MethodRefExpr(const Identifier &name) : ExprStmt(name.span()), name_{ name } {
         ASSERT(name.text().size() > 0);
     }
@@ -1357,6 +1684,9 @@ class FuncCallExpr : public ExprStmt {
     ExprStmt &funcExpr_;
     gc_ref_vector<ExprStmt> arguments_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::FuncCallExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::FuncCallExpr; }
+
     FuncCallExpr(
         const source::SourceSpan &span,
         ExprStmt *instanceExpr,
@@ -1423,6 +1753,9 @@ class NamespaceExpr : public VoidExprStmt {
     ExpressionList &body_;
     scope::SymbolTable *scope_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::NamespaceExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::NamespaceExpr; }
+
     NO_COPY_NO_ASSIGN(NamespaceExpr)
 
     NamespaceExpr(const source::SourceSpan &sourceSpan, const MultiPartIdentifier &qualifiedName, ExpressionList &body)
@@ -1466,6 +1799,10 @@ protected:
         body_{body}
     { }
 public:
+    static bool classof(const AstNode *node) {
+        return node->nodeKind() >= AstNodeKind::CompleteClassDefinition && node->nodeKind() <= AstNodeKind::GenericClassDefinition;
+    }
+
     /** The type of the class being defined. */
     virtual type::Type &definedType() const = 0;
 
@@ -1487,6 +1824,9 @@ class CompleteClassDefinition : public ClassDefinition {
     type::Type &definedType_;
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::CompleteClassDefinition; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::CompleteClassDefinition; }
+
     CompleteClassDefinition(
         source::SourceSpan span,
         const Identifier &name,
@@ -1518,7 +1858,7 @@ public:
         }
 
         for (auto &&method : this->body().scope().functions()) {
-            method.get().setThisSymbol(new scope::VariableSymbol("this", this->definedType()));
+            method.get().setThisSymbol(new scope::VariableSymbol(Atom("this"), this->definedType()));
             ct.addMethod(method.get().name(), method);
         }
     }
@@ -1565,6 +1905,9 @@ private:
     }
 
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::GenericClassDefinition; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::GenericClassDefinition; }
+
     GenericClassDefinition(
         source::SourceSpan span,
         const Identifier &name,
@@ -1629,8 +1972,12 @@ class DotExpr : public ExprStmt {
     ExprStmt &lValue_;
     const Identifier memberName_;
     type::ClassField *field_ = nullptr;
+    bool isArrayLength_ = false;
     bool isWrite_ = false;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::DotExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::DotExpr; }
+
     DotExpr(const source::SourceSpan &sourceSpan,
             const source::SourceSpan &dotSourceSpan,
             ExprStmt &lValue,
@@ -1639,7 +1986,8 @@ public:
 
     source::SourceSpan dotSourceSpan() { return dotSourceSpan_; };
 
-    bool canWrite() const override { return true; };
+    /** The length of an array cannot be changed. */
+    bool canWrite() const override { return !isArrayLength_; };
 
     bool isWrite() { return isWrite_; }
     void setIsWrite(bool isWrite) {
@@ -1653,7 +2001,14 @@ public:
     type::ClassField *field() { return field_; }
     void setField(type::ClassField *field) { field_ = field; }
 
+    /** True if this is "someArray.length" instead of a reference to a field. */
+    bool isArrayLength() { return isArrayLength_; }
+    void setIsArrayLength() { isArrayLength_ = true; }
+
     type::Type &exprType() const override {
+        if(isArrayLength_) {
+            return type::ScalarType::Int32;
+        }
         ASSERT(field_ && "Field must be resolved first");
         return field_->type();
     }
@@ -1671,9 +2026,352 @@ public:
     }
 };
 
+/**
+ * Starts a call to a function on another thread, i.e. "spawn fibonacci(30)".  The arguments are evaluated by the spawning
+ * thread.  The value of the expression is a handle to the task, see JoinExpr.
+ */
+class SpawnExpr : public ExprStmt {
+    ExprStmt &callExpr_;
+    mutable type::TaskType *taskType_ = nullptr;
+public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::SpawnExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::SpawnExpr; }
+
+    SpawnExpr(const source::SourceSpan &sourceSpan, ExprStmt &callExpr)
+        : ExprStmt(sourceSpan), callExpr_{callExpr} { }
+
+    /** Should be a FuncCallExpr which invokes a function (and not a method), which is checked by TaskSemanticsPass. */
+    ExprStmt &callExpr() const { return callExpr_; }
+
+    bool canWrite() const override { return false; };
+
+    type::Type &exprType() const override {
+        //The result type of the call isn't known until after its symbol has been resolved.
+        if(!taskType_) {
+            taskType_ = new type::TaskType(callExpr_.exprType());
+        }
+        return *taskType_;
+    }
+
+    void accept(AstVisitor &visitor) override {
+        visitor.visitingSpawnExpr(*this);
+        if(visitor.shouldVisitChildren()) {
+            callExpr_.accept(visitor);
+        }
+        visitor.visitedSpawnExpr(*this);
+    }
+
+    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &expansionContext) const override {
+        return *new SpawnExpr(sourceSpan_, callExpr_.deepCopyExpandTemplate(expansionContext));
+    }
+};
+
+/**
+ * Waits for a task started by a SpawnExpr to complete, i.e. "join(someTask)", and evaluates to the result of the function
+ * which was spawned.  While waiting, the joining thread executes other tasks.  A task may be joined more than once.
+ */
+class JoinExpr : public ExprStmt {
+    ExprStmt &taskExpr_;
+public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::JoinExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::JoinExpr; }
+
+    JoinExpr(const source::SourceSpan &sourceSpan, ExprStmt &taskExpr)
+        : ExprStmt(sourceSpan), taskExpr_{taskExpr} { }
+
+    ExprStmt &taskExpr() const { return taskExpr_; }
+
+    bool canWrite() const override { return false; };
+
+    type::Type &exprType() const override {
+        auto taskType = tryUpcast<type::TaskType>(taskExpr_.exprType().actualType());
+        //Not a task?  TaskSemanticsPass reports the error.
+        return taskType ? taskType->resultType() : type::UnresolvedType::Instance;
+    }
+
+    void accept(AstVisitor &visitor) override {
+        visitor.visitingJoinExpr(*this);
+        if(visitor.shouldVisitChildren()) {
+            taskExpr_.accept(visitor);
+        }
+        visitor.visitedJoinExpr(*this);
+    }
+
+    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &expansionContext) const override {
+        return *new JoinExpr(sourceSpan_, taskExpr_.deepCopyExpandTemplate(expansionContext));
+    }
+};
+
+/**
+ * References an element of an array or a lane of a vector, i.e. "someArray[index]" or "someFloat4[lane]".  Indexes start
+ * at 0.  The back end checks that the index is within the bounds of the array or vector.
+ */
+class IndexExpr : public ExprStmt {
+    source::SourceSpan openBracketSpan_;
+    ExprStmt &arrayExpr_;
+    ExprStmt &indexExpr_;
+    bool isWrite_ = false;
+public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::IndexExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::IndexExpr; }
+
+    IndexExpr(const source::SourceSpan &sourceSpan,
+              const source::SourceSpan &openBracketSpan,
+              ExprStmt &arrayExpr,
+              ExprStmt &indexExpr)
+        : ExprStmt(sourceSpan), openBracketSpan_{openBracketSpan}, arrayExpr_{arrayExpr}, indexExpr_{indexExpr} { }
+
+    source::SourceSpan openBracketSpan() const { return openBracketSpan_; }
+    ExprStmt &arrayExpr() const { return arrayExpr_; }
+    ExprStmt &indexExpr() const { return indexExpr_; }
+
+    /** The elements of arrays can always be written.  A lane of a vector can be written if the vector itself can. */
+    bool canWrite() const override {
+        return !isInstanceOf<type::VectorType>(arrayExpr_.exprType().actualType()) || arrayExpr_.canWrite();
+    };
+
+    /** True if this is the left side of an assignment, in which case the back end emits the address of the element. */
+    bool isWrite() const { return isWrite_; }
+    void setIsWrite(bool isWrite) { isWrite_ = isWrite; }
+
+    type::Type &exprType() const override {
+        type::Type *operandType = arrayExpr_.exprType().actualType();
+        if(auto arrayType = tryUpcast<type::ArrayType>(operandType)) {
+            return arrayType->elementType();
+        }
+        if(auto vectorType = tryUpcast<type::VectorType>(operandType)) {
+            return vectorType->elementType();
+        }
+        //Not an array or vector?  ArrayExprSemanticsPass reports the error.
+        return type::UnresolvedType::Instance;
+    }
+
+    void accept(AstVisitor &visitor) override {
+        visitor.visitingIndexExpr(*this);
+        if(visitor.shouldVisitChildren()) {
+            arrayExpr_.accept(visitor);
+            indexExpr_.accept(visitor);
+        }
+        visitor.visitedIndexExpr(*this);
+    }
+
+    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &expansionContext) const override {
+        auto &copy = *new IndexExpr(
+            sourceSpan_,
+            openBracketSpan_,
+            arrayExpr_.deepCopyExpandTemplate(expansionContext),
+            indexExpr_.deepCopyExpandTemplate(expansionContext));
+        copy.setIsWrite(isWrite_);
+        return copy;
+    }
+};
+
+/** Identifies an intrinsic, see IntrinsicCallExpr. */
+enum class IntrinsicKind : unsigned char {
+    MakeVector,
+    Shuffle,
+    Store,
+    ReduceLanes,
+    //Math intrinsics must follow, see IntrinsicCallExpr::isMath().
+    Sqrt,
+    Fabs,
+    Floor,
+    Ceil,
+    Min,
+    Max,
+    Fma,
+    Pow,
+    Exp,
+    Log,
+    Sin,
+    Cos
+};
+
+/** Returns nullptr if the name is not that of a math intrinsic, i.e. "sqrt". */
+const IntrinsicKind *findMathIntrinsic(const std::string &name);
+
+/** True if calls to functions of the specified name are parsed as calls to an intrinsic, i.e. "float4", "store" or "min". */
+bool isIntrinsicName(const std::string &name);
+
+/**
+ * Invokes an intrinsic, which looks like a function call in source but is recognized by name, may accept arguments of
+ * more than one type and is emitted inline by the back end:
+ *
+ *  - "float4(x)", "float4(x0, x1, x2, x3)" or "float4(someArray, index)" makes a vector from one value for every lane,
+ *    one value for each lane or the elements of an array beginning at index.  The same goes for float8, int4 and int8.
+ *  - "shuffle(v, lane, ...)" makes a vector from the specified lanes of v and "shuffle(v, w, lane, ...)" from the lanes
+ *    of v followed by those of w.  The lanes are literal ints and the result must have 4 or 8 of them.
+ *  - "store(someArray, index, v)" stores the lanes of v to the elements of the array beginning at index.
+ *  - "reduce(+) v" combines the lanes of v with +, *, min or max.
+ *  - The math functions sqrt, fabs, floor, ceil, min, max, fma, pow, exp, log, sin and cos, which accept floats, doubles
+ *    and vectors of floats and are applied to each lane of vectors.  min and max also accept ints and vectors of ints.
+ *    The arguments are cast to a common type, which is also the result type, and ints are cast to float where only
+ *    floating point values are accepted.
+ *
+ * The arguments are checked by IntrinsicSemanticsPass.
+ */
+class IntrinsicCallExpr : public ExprStmt {
+    const IntrinsicKind kind_;
+    const Identifier name_;
+    gc_ref_vector<ExprStmt> arguments_;
+    type::VectorType *vectorType_;
+    const ReductionKind reduction_;
+public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::IntrinsicCallExpr; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::IntrinsicCallExpr; }
+
+    IntrinsicCallExpr(
+        const source::SourceSpan &sourceSpan,
+        IntrinsicKind kind,
+        const Identifier &name,
+        const gc_ref_vector<ExprStmt> &arguments,
+        type::VectorType *vectorType = nullptr,
+        ReductionKind reduction = ReductionKind::None)
+        : ExprStmt(sourceSpan),
+          kind_{kind},
+          name_{name},
+          arguments_{arguments},
+          vectorType_{vectorType},
+          reduction_{reduction} {
+        ASSERT(kind_ != IntrinsicKind::MakeVector || vectorType_);
+        ASSERT(kind_ != IntrinsicKind::ReduceLanes || reduction_ != ReductionKind::None);
+    }
+
+    IntrinsicKind kind() const { return kind_; }
+    const Identifier &name() const { return name_; }
+
+    const gc_ref_vector<ExprStmt> &arguments() const { return arguments_; }
+
+    void replaceArgument(size_t index, ExprStmt &newExpr) {
+        ASSERT(index < arguments_.size());
+        arguments_[index] = newExpr;
+    }
+
+    /** The vector made by a MakeVector intrinsic. */
+    type::VectorType *vectorType() const { return vectorType_; }
+
+    /** The operator with which a ReduceLanes intrinsic combines the lanes. */
+    ReductionKind reduction() const { return reduction_; }
+
+    /** True if this is a MakeVector intrinsic which loads the lanes from an array. */
+    bool isLoad() const {
+        return kind_ == IntrinsicKind::MakeVector
+               && arguments_.size() == 2
+               && isInstanceOf<type::ArrayType>(arguments_.front().get().exprType().actualType());
+    }
+
+    /** The index of the first lane argument of a Shuffle intrinsic, which follows one or two vectors. */
+    size_t firstLaneArgument() const {
+        ASSERT(kind_ == IntrinsicKind::Shuffle);
+        return arguments_.size() > 1 && isInstanceOf<type::VectorType>(arguments_[1].get().exprType().actualType()) ? 2 : 1;
+    }
+
+    bool isMath() const { return kind_ >= IntrinsicKind::Sqrt; }
+
+    /** The number of arguments a math intrinsic accepts. */
+    size_t mathArgumentCount() const {
+        ASSERT(isMath());
+        switch(kind_) {
+            case IntrinsicKind::Fma:
+                return 3;
+            case IntrinsicKind::Min:
+            case IntrinsicKind::Max:
+            case IntrinsicKind::Pow:
+                return 2;
+            default:
+                return 1;
+        }
+    }
+
+    /** True if the math intrinsic also accepts ints and vectors of ints. */
+    bool mathAcceptsInts() const {
+        ASSERT(isMath());
+        return kind_ == IntrinsicKind::Min || kind_ == IntrinsicKind::Max;
+    }
+
+    /**
+     * The type the arguments of a math intrinsic are cast to:  the type of the argument to which all of the others can
+     * be implicitly cast.  Returns nullptr if there are no arguments.  Whether the type is acceptable to the intrinsic
+     * is checked by IntrinsicSemanticsPass.
+     */
+    type::Type *mathOperandsType() const {
+        ASSERT(isMath());
+        if(arguments_.empty()) {
+            return nullptr;
+        }
+        type::Type *operandsType = arguments_.front().get().exprType().actualType();
+        for(const ExprStmt &argument : arguments_) {
+            type::Type *argumentType = argument.exprType().actualType();
+            if(operandsType->canImplicitCastTo(argumentType)) {
+                operandsType = argumentType;
+            }
+        }
+        if(!mathAcceptsInts() && operandsType->isSameType(&type::ScalarType::Int32)) {
+            return &type::ScalarType::Float;
+        }
+        return operandsType;
+    }
+
+    bool canWrite() const override { return false; };
+
+    type::Type &exprType() const override {
+        if(isMath()) {
+            type::Type *operandsType = mathOperandsType();
+            if(operandsType) return *operandsType;
+            return type::UnresolvedType::Instance;
+        }
+
+        type::VectorType *operandType = arguments_.empty()
+            ? nullptr
+            : tryUpcast<type::VectorType>(arguments_.front().get().exprType().actualType());
+
+        //When the arguments are invalid, IntrinsicSemanticsPass reports the error.
+        switch(kind_) {
+            case IntrinsicKind::MakeVector:
+                return *vectorType_;
+            case IntrinsicKind::Shuffle: {
+                type::VectorType *resultType = operandType
+                    ? type::VectorType::find(operandType->elementType(), (unsigned)(arguments_.size() - firstLaneArgument()))
+                    : nullptr;
+                if(resultType) return *resultType;
+                return type::UnresolvedType::Instance;
+            }
+            case IntrinsicKind::Store:
+                return type::ScalarType::Void;
+            case IntrinsicKind::ReduceLanes:
+                if(operandType) return operandType->elementType();
+                return type::UnresolvedType::Instance;
+            default:
+                ASSERT_FAIL("Unhandled IntrinsicKind");
+        }
+    }
+
+    void accept(AstVisitor &visitor) override {
+        visitor.visitingIntrinsicCallExpr(*this);
+        if(visitor.shouldVisitChildren()) {
+            for (auto argument : arguments_) {
+                argument.get().accept(visitor);
+            }
+        }
+        visitor.visitedIntrinsicCallExpr(*this);
+    }
+
+    ExprStmt &deepCopyExpandTemplate(const TemplateExpansionContext &expansionContext) const override {
+        gc_ref_vector<ExprStmt> clonedArguments;
+        clonedArguments.reserve(arguments_.size());
+        for(ExprStmt &a : arguments_) {
+            clonedArguments.emplace_back(a.deepCopyExpandTemplate(expansionContext));
+        }
+        return *new IntrinsicCallExpr(sourceSpan_, kind_, name_, clonedArguments, vectorType_, reduction_);
+    }
+};
+
 class AssertExprStmt : public VoidExprStmt {
     ast::ExprStmt *condition_;
 public:
+    AstNodeKind nodeKind() const override { return AstNodeKind::AssertExprStmt; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::AssertExprStmt; }
+
     AssertExprStmt(const source::SourceSpan &sourceSpan, ExprStmt &condition)
         : VoidExprStmt(sourceSpan), condition_{&condition} {
         ASSERT(condition_);
@@ -1701,10 +2399,16 @@ public:
 class Module : public AstNode {
     std::string name_;
     CompoundExpr &body_;
+    std::vector<MultiPartIdentifier> imports_;
+    std::vector<uint64_t> importInterfaceHashes_;
     //gc_unordered_map<std::string, TemplateExprStmt*> templates_;
+    bool localPassesComplete_ = false;
 public:
-    Module(const std::string &name, CompoundExpr& body)
-        : name_{name}, body_{body} {
+    AstNodeKind nodeKind() const override { return AstNodeKind::Module; }
+    static bool classof(const AstNode *node) { return node->nodeKind() == AstNodeKind::Module; }
+
+    Module(const std::string &name, CompoundExpr& body, const std::vector<MultiPartIdentifier> &imports = {})
+        : name_{name}, body_{body}, imports_{imports} {
     }
 
     std::string name() const { return name_; }
@@ -1713,6 +2417,20 @@ public:
 
     CompoundExpr &body() { return body_; }
 
+    /** The modules named by import statements, which must be loaded before this module is prepared. */
+    const std::vector<MultiPartIdentifier> &imports() const { return imports_; }
+
+    /**
+     * The interface hash of each import, in the same order as imports(), as of when they were loaded.  Empty until then.
+     * See interface::ModuleInterfaceReader::interfaceHash().
+     */
+    const std::vector<uint64_t> &importInterfaceHashes() const { return importInterfaceHashes_; }
+    void setImportInterfaceHashes(const std::vector<uint64_t> &hashes) { importInterfaceHashes_ = hashes; }
+
+    /** True once the passes that depend only on this module have been run, see passes::runModuleLocalPasses(...). */
+    bool localPassesComplete() const { return localPassesComplete_; }
+    void setLocalPassesComplete() { localPassesComplete_ = true; }
+
     void accept(AstVisitor &visitor) override {
         visitor.visitingModule(*this);
         if(visitor.shouldVisitChildren()) {
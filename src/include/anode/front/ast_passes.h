@@ -7,7 +7,17 @@
 
 namespace anode { namespace front  { namespace passes {
 
-    /** Runs all AST passes that are part of the compilation process, except for code generation. */
+    /**
+     * Runs the passes which depend only on the module itself:  linking its symbol tables together and populating them.
+     * Nothing shared is modified, so this may be invoked on several modules concurrently (each with its own ErrorStream) as
+     * long as nothing else is using the AnodeWorld at the same time.  Returns true if an error occurred.
+     */
+    bool runModuleLocalPasses(ast::AnodeWorld &world, ast::Module &module, error::ErrorStream &es);
+
+    /**
+     * Runs all AST passes that are part of the compilation process, except for code generation.  Modules sharing the same
+     * AnodeWorld must be passed to this one at a time.  runModuleLocalPasses(...) is skipped if it was already invoked.
+     */
     void runAllPasses(ast::AnodeWorld &world, ast::Module &module, error::ErrorStream &es);
 
 }}}
\ No newline at end of file
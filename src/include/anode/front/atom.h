@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <functional>
+
+namespace anode { namespace front {
+
+/**
+ * An interned string.  Every Atom with the same text refers to the same entry in a global intern table, so comparing two
+ * Atoms is a pointer compare and the hash is computed exactly once, when the text is first interned.  Entries are never
+ * released.
+ *
+ * Identifiers, symbol names and class member names are all Atoms so that symbol table and member lookups don't have to
+ * hash or compare strings.
+ */
+class Atom {
+public:
+    struct Entry {
+        const std::string text;
+        const std::size_t hash;
+    };
+
+private:
+    const Entry *entry_;
+
+    static const Entry &intern(const std::string &text);
+
+public:
+    /** Constructs the empty Atom. */
+    Atom();
+    explicit Atom(const std::string &text) : entry_{&intern(text)} { }
+    explicit Atom(const char *text) : entry_{&intern(std::string(text))} { }
+
+    const std::string &text() const { return entry_->text; }
+    const char *c_str() const { return entry_->text.c_str(); }
+    std::size_t size() const { return entry_->text.size(); }
+    bool empty() const { return entry_->text.empty(); }
+    std::size_t hash() const { return entry_->hash; }
+
+    bool operator==(const Atom &other) const { return entry_ == other.entry_; }
+    bool operator!=(const Atom &other) const { return entry_ != other.entry_; }
+
+    /** Lexical ordering, for when a stable sort order is needed (i.e. when displaying symbol tables). */
+    bool operator<(const Atom &other) const { return entry_->text < other.entry_->text; }
+
+    /** The number of distinct strings interned so far. */
+    static std::size_t internedCount();
+};
+
+}}
+
+namespace std {
+template<>
+struct hash<anode::front::Atom> {
+    std::size_t operator()(const anode::front::Atom &atom) const { return atom.hash(); }
+};
+}
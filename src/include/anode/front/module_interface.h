@@ -0,0 +1,152 @@
+/**
+ * Module interfaces allow a library module to be imported without being parsed or analyzed again.  An interface records
+ * everything another module needs to reference the library:
+ *
+ *  - the signatures of its global variables and functions,
+ *  - the layouts and method signatures of its classes,
+ *  - the source text of its templates (which are expanded by each importer, so their ASTs are needed),
+ *  - the libraries it imports and
+ *  - opaque blocks of compiled code (LLVM bitcode and optionally machine code) which are stored verbatim.
+ *
+ * To support incremental recompilation an interface also records the content hash of the library's source, the hash of
+ * the interface itself (see ModuleInterfaceReader::interfaceHash()), the interface hash of each import at the time the
+ * library was compiled and how its code was generated.  The library only needs to be compiled again if its source
+ * changed, if the interface of one of its imports changed or if its code would now be generated differently.
+ *
+ * The format is a compact binary one in host byte order, intended to be read directly from a memory mapped file.
+ */
+
+#pragma once
+
+#include "front/ast.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace anode { namespace front { namespace interface {
+
+/**
+ * Identifies interface files.  The version is incremented whenever the format changes or the compiled code stored in
+ * interfaces is no longer compatible with the runtime.
+ */
+const char InterfaceMagic[4] = {'A', 'N', 'I', 'F'};
+const uint32_t InterfaceVersion = 6;
+
+/** The extension of interface files, which are written next to the source of the library they describe. */
+const std::string InterfaceFileExtension = ".ani";
+
+/** Thrown when an interface is malformed or refers to something that hasn't been imported. */
+class InterfaceException : public exception::Exception {
+public:
+    explicit InterfaceException(const std::string &message) : Exception(message) { }
+};
+
+/** A library imported by a module, along with the hash of its interface at the time the module was compiled. */
+struct InterfaceImport {
+    std::string qualifiedName;
+    uint64_t interfaceHash;
+};
+
+/** What is recorded in an interface in addition to what is derived from the module itself. */
+struct CompiledModule {
+    /** The module's source, from which the text of its top-level templates is extracted. */
+    std::string sourceText;
+    /** Identifies the source, i.e. contentHash(sourceText), see ModuleInterfaceReader::sourceHash(). */
+    uint64_t sourceHash = 0;
+    /** The interface hash of each of the module's imports, in the same order as ast::Module::imports(). */
+    std::vector<uint64_t> importInterfaceHashes;
+    /** Identifies the build of the compiler which generated the code. */
+    uint64_t compilerIdentity = 0;
+    /** The floating point mode and optimization level the code was generated with. */
+    ast::FloatingPointMode floatingPointMode = ast::FloatingPointMode::Precise;
+    uint32_t optimizationLevel = 0;
+    /** LLVM bitcode. */
+    std::string code;
+    /** Machine code compiled from the bitcode for objectTriple, which may both be empty. */
+    std::string objectTriple;
+    std::string object;
+};
+
+/**
+ * Writes the interface of a module which has been through passes::runAllPasses(...) and returns its interface hash.
+ *
+ * Variables and functions whose signatures refer to expanded generic classes are not exported, nor is anything within a
+ * namespace.
+ */
+uint64_t writeModuleInterface(ast::Module &module, const CompiledModule &compiled, std::ostream &out);
+
+/**
+ * True if every variable, function and class defined in the module's scope would be written to its interface, i.e.
+ * loading the interface makes the same symbols available to other modules as compiling the module does.
+ */
+bool exportsAllSymbols(ast::Module &module);
+
+/**
+ * Reads an interface from memory which must remain valid for the lifetime of this object.  The header (name, imports,
+ * template sources and code) is read immediately, symbols only by importSymbols(...), which should be invoked after the
+ * modules named by imports() have been loaded since their classes may be referenced.
+ */
+class ModuleInterfaceReader {
+    const char *data_;
+    size_t size_;
+    std::string moduleName_;
+    uint64_t sourceHash_ = 0;
+    uint64_t interfaceHash_ = 0;
+    uint64_t compilerIdentity_ = 0;
+    ast::FloatingPointMode floatingPointMode_ = ast::FloatingPointMode::Precise;
+    uint32_t optimizationLevel_ = 0;
+    std::vector<InterfaceImport> imports_;
+    std::vector<std::string> templateSources_;
+    const char *code_ = nullptr;
+    size_t codeSize_ = 0;
+    std::string objectTriple_;
+    const char *object_ = nullptr;
+    size_t objectSize_ = 0;
+    //Where the symbols begin.
+    size_t symbolsOffset_ = 0;
+
+public:
+    NO_COPY_NO_ASSIGN(ModuleInterfaceReader)
+    /** Throws InterfaceException if the data is not an interface of the current version. */
+    ModuleInterfaceReader(const char *data, size_t size);
+
+    /** The name of the module, from which the name of its initialization function is derived. */
+    const std::string &moduleName() const { return moduleName_; }
+
+    /** Identifies the source the module was compiled from, see CompiledModule::sourceHash. */
+    uint64_t sourceHash() const { return sourceHash_; }
+
+    /**
+     * The hash of everything an importer depends upon:  the exported symbols and their types and the template sources.
+     * This does not change when only the implementation of the module changes, in which case its importers need not be
+     * compiled again.
+     */
+    uint64_t interfaceHash() const { return interfaceHash_; }
+
+    /** How the code was generated, see CompiledModule. */
+    uint64_t compilerIdentity() const { return compilerIdentity_; }
+    ast::FloatingPointMode floatingPointMode() const { return floatingPointMode_; }
+    uint32_t optimizationLevel() const { return optimizationLevel_; }
+
+    /** The imports of the module, as written in its source (i.e. "some::library"). */
+    const std::vector<InterfaceImport> &imports() const { return imports_; }
+
+    /** The source text of each top-level template and generic class. */
+    const std::vector<std::string> &templateSources() const { return templateSources_; }
+
+    const char *code() const { return code_; }
+    size_t codeSize() const { return codeSize_; }
+
+    const std::string &objectTriple() const { return objectTriple_; }
+    const char *object() const { return object_; }
+    size_t objectSize() const { return objectSize_; }
+
+    /**
+     * Adds the module's exported variables, functions and classes to the world's global scope as external symbols.
+     * Throws InterfaceException if a referenced class is unknown or if a symbol is already defined.
+     */
+    void importSymbols(ast::AnodeWorld &world) const;
+};
+
+}}}
@@ -8,6 +8,7 @@
 #include <fstream>
 
 #include <string>
+#include <vector>
 #include "front/ErrorKind.h"
 #include "front/ErrorStream.h"
 
@@ -18,6 +19,18 @@ ast::Module &parseModule(std::istream &inputStream, const std::string &name);
 ast::Module &parseModule(std::istream &inputStream, const std::string &name, error::ErrorStream &errorStream);
 ast::Module &parseModule(const std::string &lineOfCode, const std::string &inputName);
 
+/**
+ * Parses each of the specified files and runs passes::runModuleLocalPasses(...) on the result, one file per task on a
+ * ThreadPool with threadCount worker threads (0 selects one per hardware thread).  world must not be used by anything
+ * else until this returns.  Errors are written to errorOutput grouped by file, in the same order as filenames, which is
+ * also the order of the returned modules.  If any file fails, ParseAbortedException is thrown after all files are done.
+ */
+gc_ref_vector<ast::Module> parseModules(
+    const std::vector<std::string> &filenames,
+    ast::AnodeWorld &world,
+    unsigned threadCount,
+    std::ostream &errorOutput);
+
 /** Thrown when the parser has determined that it is unable to continue parsing.*/
 class ParseAbortedException : public exception::Exception {
 public:
@@ -4,6 +4,7 @@
 #include "common/exception.h"
 #include "type.h"
 #include "front/unique_id.h"
+#include "front/atom.h"
 #include "common/string.h"
 #include <string>
 
@@ -19,6 +20,15 @@ enum class StorageKind : unsigned char {
     TemplateParameter
 };
 
+/** Identifies the concrete class of a Symbol without RTTI. */
+enum class SymbolKind : unsigned char {
+    Variable,
+    Function,
+    Template,
+    Type,
+    Namespace
+};
+
 class Symbol;
 class VariableSymbol;
 class FunctionSymbol;
@@ -30,18 +40,19 @@ const std::string ScopeSeparator = "::";
 class SymbolTable : public gc {
 
     SymbolTable *parent_ = nullptr;
-    gc_ref_unordered_map<std::string, scope::Symbol> symbols_;
+    gc_ref_unordered_map<Atom, scope::Symbol> symbols_;
     gc_ref_vector<scope::Symbol> orderedSymbols_;
+    //Indexes of orderedSymbols_ by kind, maintained by addSymbol(...) so they needn't be rebuilt each time they're needed.
+    gc_ref_vector<VariableSymbol> variables_;
+    gc_ref_vector<TypeSymbol> types_;
+    gc_ref_vector<FunctionSymbol> functions_;
     StorageKind storageKind_;
-    std::string name_;
+    Atom name_;
 
-    void appendName(std::string &appendTo) {
-        if (parent_) {
-            parent_->appendName(appendTo);
-            appendTo.append(ScopeSeparator);
-        }
-        appendTo.append(name());
-    }
+    /** Cached result of fullName() and the full name of parent_ at the time it was computed, which is used to detect when
+     * the cached value has become stale because this or any ancestor symbol table was re-parented. */
+    Atom fullName_;
+    Atom fullNameOfParent_;
 
 public:
     NO_COPY_NO_ASSIGN(SymbolTable)
@@ -58,15 +69,11 @@ public:
         parent_ = &parent;
     }
 
-    std::string name() const {
+    Atom name() const {
         return name_;
     }
 
-    std::string fullName() {
-        std::string fn;
-        appendName(fn);
-        return fn;
-    }
+    Atom fullName();
 
     StorageKind storageKind() const {
         return storageKind_;
@@ -77,33 +84,39 @@ public:
     }
 
     /** Finds the named symbol in the current scope */
-    Symbol *findSymbolInCurrentScope(const std::string &name) const;
+    Symbol *findSymbolInCurrentScope(Atom name) const;
 
     /** Finds the named symbol in the current scope or any parent. */
-    Symbol *findSymbolInCurrentScopeOrParents(const std::string &name) const;
+    Symbol *findSymbolInCurrentScopeOrParents(Atom name) const;
 
     void addSymbol(Symbol &symbol);
 
-    gc_ref_vector<VariableSymbol> variables();
+    /** The variables in the current scope, in the order they were added.  */
+    const gc_ref_vector<VariableSymbol> &variables() const { return variables_; }
 
-    gc_ref_vector<TypeSymbol> types();
+    /** The types in the current scope, in the order they were added.  */
+    const gc_ref_vector<TypeSymbol> &types() const { return types_; }
 
-    gc_ref_vector<FunctionSymbol> functions() const;
+    /** The functions in the current scope, in the order they were added.  */
+    const gc_ref_vector<FunctionSymbol> &functions() const { return functions_; }
 
-    gc_ref_vector<Symbol> symbols() const;
+    /** All symbols in the current scope, in the order they were added.  */
+    const gc_ref_vector<Symbol> &symbols() const { return orderedSymbols_; }
 };
 
 class Symbol : public Object {
 public:
     NO_COPY_NO_ASSIGN(Symbol)
     Symbol() { }
+    virtual SymbolKind symbolKind() const = 0;
+    static bool classof(const Symbol *) { return true; }
     virtual UniqueId symbolId() = 0;
     virtual bool isFullyQualified() = 0;
     virtual void fullyQualify(SymbolTable *symbolTable) = 0;
-    virtual std::string name() const = 0;
+    virtual Atom name() const = 0;
     virtual std::string toString() const = 0;
     virtual type::Type &type() const = 0;
-    virtual std::string fullyQualifiedName() = 0;
+    virtual Atom fullyQualifiedName() = 0;
     virtual StorageKind storageKind() const = 0;
     virtual void setStorageKind(StorageKind storageKind) = 0;
     virtual bool isExternal() const = 0;
@@ -114,7 +127,7 @@ class SymbolBase : public Symbol {
     UniqueId symbolId_;
     bool isExternal_ = false;
     StorageKind storageKind_ = StorageKind::NotSet;
-    std::string fullyQualifiedName_;
+    Atom fullyQualifiedName_;
     SymbolTable *mySymbolTable_ = nullptr;
 protected:
     SymbolBase();
@@ -131,6 +144,8 @@ public:
     NO_ASSIGN(SymbolBase)
     virtual ~SymbolBase() = default;
 
+    static bool classof(const Symbol *) { return true; }
+
     UniqueId symbolId() override { return symbolId_; }
 
     bool isFullyQualified() override { return !fullyQualifiedName_.empty(); }
@@ -145,7 +160,7 @@ public:
         mySymbolTable_ = mySymbolTable;
 
         if (fullyQualifiedName_.empty())
-            fullyQualifiedName_ = mySymbolTable_->fullName() + ScopeSeparator + name();
+            fullyQualifiedName_ = Atom(mySymbolTable_->fullName().text() + ScopeSeparator + name().text());
     }
 
     /**
@@ -163,11 +178,23 @@ public:
         return results;
     }
 
-    std::string fullyQualifiedName() override {
+    Atom fullyQualifiedName() override {
         ASSERT(!fullyQualifiedName_.empty());
         return fullyQualifiedName_;
     }
 
+    /**
+     * Marks a symbol read from a module interface as external.  Its fully qualified name is the one recorded in the
+     * interface because that is the name of its definition in the compiled module.  Must be invoked before the symbol is
+     * added to mySymbolTable.
+     */
+    void setImported(SymbolTable &mySymbolTable, Atom fullyQualifiedName) {
+        ASSERT(!mySymbolTable_ && "Symbol has already been added to a symbol table.");
+        mySymbolTable_ = &mySymbolTable;
+        fullyQualifiedName_ = fullyQualifiedName;
+        isExternal_ = true;
+    }
+
     StorageKind storageKind() const override { return storageKind_; }
 
     void setStorageKind(StorageKind storageKind) override { storageKind_ = storageKind; }
@@ -179,24 +206,27 @@ public:
 
 class VariableSymbol : public SymbolBase {
     type::Type &type_;
-    std::string name_;
+    Atom name_;
 
     /** "Cloning" constructor. */
     explicit VariableSymbol(const VariableSymbol &other) : SymbolBase(other), type_{other.type_}, name_{other.name_} {}
 
 public:
-    VariableSymbol(const std::string &name, type::Type &type) : SymbolBase(), type_{type}, name_{name} {}
+    VariableSymbol(Atom name, type::Type &type) : SymbolBase(), type_{type}, name_{name} {}
+
+    SymbolKind symbolKind() const override { return SymbolKind::Variable; }
+    static bool classof(const Symbol *symbol) { return symbol->symbolKind() == SymbolKind::Variable; }
 
     virtual type::Type &type() const override {
         return type_;
     }
 
-    virtual std::string name() const override {
+    virtual Atom name() const override {
         return name_;
     }
 
     virtual std::string toString() const override {
-        return name_ + ":" + type().nameForDisplay();
+        return name_.text() + ":" + type().nameForDisplay();
     }
 
     Symbol &cloneForExport() override {
@@ -206,7 +236,7 @@ public:
 };
 
 class FunctionSymbol : public SymbolBase {
-    std::string name_;
+    Atom name_;
     type::FunctionType *functionType_;
     VariableSymbol *thisSymbol_ = nullptr;
 
@@ -217,11 +247,14 @@ class FunctionSymbol : public SymbolBase {
           thisSymbol_{other.thisSymbol_ ? static_cast<VariableSymbol *>(&other.thisSymbol_->cloneForExport()) : nullptr} {}
 
 public:
-    FunctionSymbol(const std::string &name, type::FunctionType *functionType) : name_{std::move(name)}, functionType_{functionType} {}
+    FunctionSymbol(Atom name, type::FunctionType *functionType) : name_{name}, functionType_{functionType} {}
 
-    std::string name() const override { return name_; };
+    SymbolKind symbolKind() const override { return SymbolKind::Function; }
+    static bool classof(const Symbol *symbol) { return symbol->symbolKind() == SymbolKind::Function; }
 
-    std::string toString() const override { return name_ + ":" + functionType_->returnType()->nameForDisplay() + "()"; }
+    Atom name() const override { return name_; };
+
+    std::string toString() const override { return name_.text() + ":" + functionType_->returnType()->nameForDisplay() + "()"; }
 
     type::Type &type() const override { return *functionType_; }
 
@@ -247,14 +280,17 @@ public:
 };
 
 class TemplateSymbol : public SymbolBase {
-    std::string name_;
+    Atom name_;
     UniqueId astNodeId_;
     TemplateSymbol(const TemplateSymbol &other) : SymbolBase(other), name_{other.name_}, astNodeId_{other.astNodeId_} { }
 
 public:
-    TemplateSymbol(const std::string &name, UniqueId astNodeId) : name_{name}, astNodeId_(astNodeId) { }
+    TemplateSymbol(Atom name, UniqueId astNodeId) : name_{name}, astNodeId_(astNodeId) { }
+
+    SymbolKind symbolKind() const override { return SymbolKind::Template; }
+    static bool classof(const Symbol *symbol) { return symbol->symbolKind() == SymbolKind::Template; }
 
-    std::string name() const override { return name_; }
+    Atom name() const override { return name_; }
     std::string toString() const override { return string::format("%s-%d", name_.c_str(), astNodeId_); }
     type::Type &type() const override { return type::ScalarType::Void; }
     UniqueId astNodeId() { return astNodeId_; }
@@ -268,15 +304,18 @@ public:
 
 
 class TypeSymbol : public SymbolBase {
-    std::string name_;
+    Atom name_;
     type::Type &type_;
     TypeSymbol(const TypeSymbol &other) : SymbolBase(other), name_{other.name_}, type_{other.type_} {}
 
 public:
     TypeSymbol(type::Type &type) : name_{type.name()}, type_(type) {}
-    TypeSymbol(const std::string &name, type::Type &type) : name_{name}, type_(type) {}
+    TypeSymbol(Atom name, type::Type &type) : name_{name}, type_(type) {}
 
-    std::string name() const override { return name_; }
+    SymbolKind symbolKind() const override { return SymbolKind::Type; }
+    static bool classof(const Symbol *symbol) { return symbol->symbolKind() == SymbolKind::Type; }
+
+    Atom name() const override { return name_; }
 
     std::string toString() const override { return type_.nameForDisplay(); }
 
@@ -295,9 +334,12 @@ public:
 
     explicit NamespaceSymbol(SymbolTable &symbolTable) : symbolTable_{symbolTable} { }
 
-    std::string name() const override { return symbolTable_.name(); }
+    SymbolKind symbolKind() const override { return SymbolKind::Namespace; }
+    static bool classof(const Symbol *symbol) { return symbol->symbolKind() == SymbolKind::Namespace; }
+
+    Atom name() const override { return symbolTable_.name(); }
 
-    std::string toString() const override { return "NS: " + symbolTable_.name(); }
+    std::string toString() const override { return "NS: " + symbolTable_.name().text(); }
 
     type::Type &type() const override { return type::ScalarType::Void; }
 
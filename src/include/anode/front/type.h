@@ -1,6 +1,7 @@
 
 #pragma once
 #include "unique_id.h"
+#include "atom.h"
 #include "common/exception.h"
 #include "common/containers.h"
 
@@ -34,10 +35,28 @@ class ScalarType;
 class GenericType;
 class ClassType;
 
+/** Identifies the concrete class of a Type without RTTI. */
+enum class TypeKind : unsigned char {
+    Unresolved,
+    ResolutionDeferred,
+    Scalar,
+    Function,
+    Class,
+    Generic,
+    Task,
+    Array,
+    Vector
+};
+
 class Type : public Object {
 public:
     NO_COPY_NO_ASSIGN(Type)
     Type() {}
+
+    /** Identifies the concrete class of this type, which for ResolutionDeferredType is not that of its actualType(). */
+    virtual TypeKind typeKind() const = 0;
+    static bool classof(const Type *) { return true; }
+
     virtual UniqueId astNodeId() const { return (UniqueId)-1; }
     virtual std::string name() const = 0;
     virtual std::string nameForDisplay() const { return name(); }
@@ -59,6 +78,13 @@ public:
     virtual bool canImplicitCastTo(const Type *) const { return false; }
     virtual bool canExplicitCastTo(const Type *) const { return false; }
     virtual Type* actualType() const { return const_cast<Type*>(this); }
+
+    /** A hash of the type, such that any two types for which isSameType(...) returns true have the same canonicalHash(). */
+    virtual std::size_t canonicalHash() const {
+        //Types which merely refer to another, i.e. ResolutionDeferredType, hash as the type they refer to.
+        Type *actual = actualType();
+        return actual != this ? actual->canonicalHash() : std::hash<const Type*>()(this);
+    }
 };
 
 /**
@@ -70,6 +96,9 @@ public:
  */
 class UnresolvedType : public Type {
 public:
+    TypeKind typeKind() const override { return TypeKind::Unresolved; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Unresolved; }
+
     UniqueId astNodeId() const override { return (UniqueId)-1; }
     std::string name() const override { return "<unresolved type>"; }
     std::string nameForDisplay() const override { return "<unresolved type>"; }
@@ -100,6 +129,9 @@ public:
     ResolutionDeferredType(const gc_ref_vector<Type> &typeArguments)
         : typeArguments_{typeArguments} { }
 
+    TypeKind typeKind() const override { return TypeKind::ResolutionDeferred; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::ResolutionDeferred; }
+
     bool isActualType() override { return false; }
 
     bool isResolved() const {
@@ -108,7 +140,7 @@ public:
         }
 
         //Have an actual type that is another ResolutionDeferredType?  Ask it instead.
-        if(auto rdt = dynamic_cast<ResolutionDeferredType*>(actualType_)) {
+        if(auto rdt = tryUpcast<ResolutionDeferredType>(actualType_)) {
             return rdt->isResolved();
         }
 
@@ -201,6 +233,9 @@ public:
     ScalarType(const std::string &name, PrimitiveType primitiveType_, bool canDoArithmetic)
         : name_{name}, primitiveType_(primitiveType_), canDoArithmetic_(canDoArithmetic) {}
 
+    TypeKind typeKind() const override { return TypeKind::Scalar; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Scalar; }
+
     std::string name() const override { return name_; }
 
     bool isSameType(const type::Type *other) const override {
@@ -217,7 +252,9 @@ public:
     /** Returns true when a value of the specified type can be implicitly cast to this type.
      * Returns false if the other type is the same as this type (as this does not require casting). */
     bool canImplicitCastTo(const Type *other) const override  {
-        auto otherScalar = dynamic_cast<const ScalarType*>(other->actualType());
+        if(canSplatTo(other)) return true;
+
+        auto otherScalar = tryUpcast<ScalarType>(other->actualType());
         if(otherScalar == nullptr) return false;
 
         if(primitiveType_ == otherScalar->primitiveType()) return false;
@@ -234,7 +271,7 @@ public:
     /** Returns true when a value of the specified type may be be explicitly cast to this type.
      * Returns false if the other type is the same as this type (as this does not require casting). */
     bool canExplicitCastTo(const Type *other) const override {
-        auto otherScalar = dynamic_cast<const ScalarType*>(other->actualType());
+        auto otherScalar = tryUpcast<ScalarType>(other->actualType());
 
         if(otherScalar == nullptr) return false;
 
@@ -251,26 +288,80 @@ public:
     static ScalarType Bool;
     static ScalarType Void;
     static ScalarType *fromKeyword(const std::string &keyword);
+
+    /** True if the other type is a vector of this type, in which case this type's values are copied to each lane. */
+    bool canSplatTo(const Type *other) const;
+};
+
+/**
+ * The type of a SIMD vector, i.e. "float4" or "int8":  a fixed number of lanes, each holding a value of the element type.
+ * The back end maps vector types to LLVM vector types and arithmetic operators apply to each lane.  Like ScalarType,
+ * there is only one instance of each vector type.
+ */
+class VectorType : public Type {
+    std::string name_;
+    ScalarType &elementType_;
+    unsigned laneCount_;
+public:
+    VectorType(const std::string &name, ScalarType &elementType, unsigned laneCount)
+        : name_{name}, elementType_{elementType}, laneCount_{laneCount} { }
+
+    TypeKind typeKind() const override { return TypeKind::Vector; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Vector; }
+
+    std::string name() const override { return name_; }
+
+    bool isSameType(const type::Type *other) const override { return this == other->actualType(); }
+
+    bool canDoArithmetic() const override { return true; }
+
+    /** Vectors with the same number of lanes may be cast to each other, which casts each lane. */
+    bool canExplicitCastTo(const Type *other) const override {
+        auto otherVector = tryUpcast<VectorType>(other->actualType());
+        return otherVector && otherVector != this && otherVector->laneCount_ == laneCount_;
+    }
+
+    ScalarType &elementType() const { return elementType_; }
+    unsigned laneCount() const { return laneCount_; }
+
+    static VectorType Float4;
+    static VectorType Float8;
+    static VectorType Int4;
+    static VectorType Int8;
+    static VectorType *fromKeyword(const std::string &keyword);
+    /** Returns nullptr if there is no vector type with the specified element type and number of lanes. */
+    static VectorType *find(const Type &elementType, unsigned laneCount);
 };
 
+inline bool ScalarType::canSplatTo(const Type *other) const {
+    auto otherVector = tryUpcast<VectorType>(other->actualType());
+    return otherVector && &otherVector->elementType() == this;
+}
+
 class FunctionType : public Type {
     Type *returnType_;
     gc_ref_vector<type::Type> parameterTypes_;
 public:
     FunctionType(Type *returnType, const gc_ref_vector<type::Type> parameterTypes) : returnType_{returnType}, parameterTypes_{parameterTypes}  { }
 
+    TypeKind typeKind() const override { return TypeKind::Function; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Function; }
+
     std::string name() const override { return "func:" + returnType_->name(); }
 
     bool isSameType(const type::Type *other) const override {
         if(this == other) return true;
         if(!other->isFunction()) return false;
 
-        auto otherFunctionType = dynamic_cast<const FunctionType*>(other);
+        auto otherFunctionType = tryUpcast<const FunctionType>(other);
         return otherFunctionType && this->returnType_->isSameType(otherFunctionType->returnType_);
     }
 
     bool isFunction() const override { return true; }
 
+    /** Function types having the same return type are considered the same type by isSameType(...), see above. */
+    std::size_t canonicalHash() const override { return ~returnType_->canonicalHash(); }
+
     Type *returnType() const { return returnType_; }
 
     const gc_ref_vector<type::Type> &parameterTypes() {
@@ -278,21 +369,83 @@ public:
     }
 };
 
+/**
+ * The type of a handle to a task started by a spawn expression, written "task<resultType>" in source.  Joining the task
+ * yields a value of the result type, which is that of the function which was spawned.
+ */
+class TaskType : public Type {
+    Type &resultType_;
+public:
+    explicit TaskType(Type &resultType) : resultType_{resultType} { }
+
+    TypeKind typeKind() const override { return TypeKind::Task; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Task; }
+
+    std::string name() const override { return "task<" + resultType_.name() + ">"; }
+    std::string nameForDisplay() const override { return "task<" + resultType_.nameForDisplay() + ">"; }
+
+    /** More than one instance may exist for the same result type, so task types are compared by their result types. */
+    bool isSameType(const type::Type *other) const override {
+        auto otherTaskType = tryUpcast<const TaskType>(other->actualType());
+        return otherTaskType && resultType_.isSameType(otherTaskType->resultType_);
+    }
+
+    std::size_t canonicalHash() const override { return resultType_.canonicalHash() * 31 + (std::size_t)TypeKind::Task; }
+
+    Type &resultType() const { return resultType_; }
+};
+
+/**
+ * The type of a fixed-length array, written "elementType[]" in source, i.e. "int[]", "float[][]" or "SomeClass[]".  Like
+ * classes, arrays are allocated on the heap and referenced through a pointer.  The length of the array precedes its
+ * elements, which are stored contiguously and unboxed:  the elements of an int[] are ints and those of a SomeClass[] are
+ * references to instances of SomeClass.
+ */
+class ArrayType : public Type {
+    Type &elementType_;
+public:
+    explicit ArrayType(Type &elementType) : elementType_{elementType} { }
+
+    TypeKind typeKind() const override { return TypeKind::Array; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Array; }
+
+    std::string name() const override { return elementType_.name() + "[]"; }
+    std::string nameForDisplay() const override { return elementType_.nameForDisplay() + "[]"; }
+
+    /** More than one instance may exist for the same element type, so array types are compared by their element types. */
+    bool isSameType(const type::Type *other) const override {
+        auto otherArrayType = tryUpcast<const ArrayType>(other->actualType());
+        return otherArrayType && elementType_.isSameType(otherArrayType->elementType_);
+    }
+
+    std::size_t canonicalHash() const override { return elementType_.canonicalHash() * 31 + (std::size_t)TypeKind::Array; }
+
+    Type &elementType() const { return elementType_; }
+
+    /**
+     * True if the elements may reference other objects, in which case the garbage collector must scan them.  Arrays of
+     * primitives and vectors are allocated in memory which the collector does not scan.
+     */
+    bool elementsContainPointers() const {
+        return !elementType_.isPrimitive() && !isInstanceOf<VectorType>(elementType_.actualType());
+    }
+};
+
 class ClassMember : public gc {
-    std::string name_;
+    Atom name_;
 public:
-    explicit ClassMember(const std::string &name) : name_(name) {}
+    explicit ClassMember(Atom name) : name_(name) {}
 
     virtual Type &type() const = 0;
 
-    std::string name() const { return name_; }
+    Atom name() const { return name_; }
 };
 
 class ClassField : public ClassMember {
     unsigned const ordinal_;
     type::Type &type_;
 public:
-    explicit ClassField(const std::string &name, type::Type &type, unsigned ordinal)
+    explicit ClassField(Atom name, type::Type &type, unsigned ordinal)
         : ClassMember(name), ordinal_{ordinal}, type_(type) { }
 
     unsigned ordinal() const { return ordinal_; }
@@ -302,7 +455,7 @@ public:
 class ClassMethod : public ClassMember {
     scope::FunctionSymbol &symbol_;
 public:
-    explicit ClassMethod(const std::string &name, scope::FunctionSymbol &symbol) : ClassMember(name), symbol_{symbol} { }
+    explicit ClassMethod(Atom name, scope::FunctionSymbol &symbol) : ClassMember(name), symbol_{symbol} { }
     Type &type() const override;
     scope::FunctionSymbol &symbol() const { return symbol_; }
 };
@@ -314,8 +467,9 @@ class ClassType : public Type {
     const UniqueId astNodeId_;
     std::string name_;
     gc_ref_vector<ClassField> orderedFields_;
-    gc_ref_unordered_map<std::string, ClassField> fields_;
-    gc_ref_unordered_map<std::string, ClassMethod> methods_;
+    gc_ref_unordered_map<Atom, ClassField> fields_;
+    gc_ref_unordered_map<Atom, ClassMethod> methods_;
+    gc_ref_vector<ClassMethod> orderedMethods_;
     GenericType *genericType_ = nullptr;
     gc_ref_vector<Type> typeArguments_;
 
@@ -328,6 +482,9 @@ public:
         ASSERT(!name_.empty());
     }
 
+    TypeKind typeKind() const override { return TypeKind::Class; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Class; }
+
     UniqueId astNodeId() const override { return astNodeId_; }
     std::string name() const override { return name_; }
 
@@ -364,12 +521,12 @@ public:
     bool canImplicitCastTo(const Type *) const override { return false; };
     bool canExplicitCastTo(const Type *) const override { return false; };
 
-    ClassField *findField(const std::string &name) const {
+    ClassField *findField(Atom name) const {
         auto &&found = fields_.find(name);
         return found == fields_.end() ? nullptr : &found->second.get();
     }
 
-    void addField(const std::string &name, type::Type &type) {
+    void addField(Atom name, type::Type &type) {
         auto &&field = *new ClassField(name, type, (unsigned) orderedFields_.size());
 
         orderedFields_.emplace_back(field);
@@ -380,29 +537,43 @@ public:
         return orderedFields_;
     }
 
-    ClassMethod *findMethod(const std::string &name) const {
+    ClassMethod *findMethod(Atom name) const {
         auto found = methods_.find(name);
         return found == methods_.end() ? nullptr : &found->second.get();
     }
 
-    void addMethod(const std::string &name, scope::FunctionSymbol &symbol);
+    void addMethod(Atom name, scope::FunctionSymbol &symbol);
+
+    /** The methods, in the order they were added. */
+    const gc_ref_vector<ClassMethod> &methods() const {
+        return orderedMethods_;
+    }
 };
 
-class ExpandedClassEntry {
-    gc_ref_vector<type::Type> templateArgs_;
-    type::ClassType &classType_;
+/**
+ * A list of type arguments (i.e. of a template expansion) which may be used as a key in a hash table.  Keys are equal when
+ * each of their types are the same type according to Type::isSameType(...).
+ */
+class TypeArgumentsKey {
+    gc_ref_vector<Type> types_;
+    std::size_t hash_;
 public:
-    ExpandedClassEntry(gc_ref_vector<type::Type> templateArgs, ClassType &classType_)
-        : templateArgs_{templateArgs}, classType_(classType_) { }
+    explicit TypeArgumentsKey(const gc_ref_vector<Type> &types) : types_{types}, hash_{types.size()} {
+        for(const Type &type : types_) {
+            hash_ ^= type.canonicalHash() + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
+        }
+    }
 
-    type::ClassType& classType() const { return classType_; }
+    const gc_ref_vector<Type> &types() const { return types_; }
 
-    bool templateArgsMatch(const gc_ref_vector<type::Type> &otherArgs) const {
-        ASSERT(templateArgs_.size() == otherArgs.size());
+    std::size_t hash() const { return hash_; }
 
-        // O(n)... could be optimized.
-        for(size_t i = 0; i < templateArgs_.size(); ++i) {
-            if(!templateArgs_[i].get().isSameType(otherArgs[i])) {
+    bool operator==(const TypeArgumentsKey &other) const {
+        if(hash_ != other.hash_ || types_.size() != other.types_.size()) {
+            return false;
+        }
+        for(size_t i = 0; i < types_.size(); ++i) {
+            if(!types_[i].get().isSameType(other.types_[i])) {
                 return false;
             }
         }
@@ -410,16 +581,30 @@ public:
     }
 };
 
+}}}
+
+namespace std {
+template<>
+struct hash<anode::front::type::TypeArgumentsKey> {
+    std::size_t operator()(const anode::front::type::TypeArgumentsKey &key) const { return key.hash(); }
+};
+}
+
+namespace anode { namespace front { namespace type {
+
 class GenericType : public Type {
     UniqueId astNodeId_;
     std::string name_;
     std::vector<std::string> templateParameterNames_;
-    gc_vector<ExpandedClassEntry> expandedClasses_;
+    gc_unordered_map<TypeArgumentsKey, ClassType*> expandedClasses_;
 public:
     GenericType(UniqueId astNodeId, std::string name, std::vector<std::string> templateParameterNames)
         : astNodeId_{astNodeId}, name_{name}, templateParameterNames_{templateParameterNames}
     { }
 
+    TypeKind typeKind() const override { return TypeKind::Generic; }
+    static bool classof(const Type *type) { return type->typeKind() == TypeKind::Generic; }
+
     virtual UniqueId astNodeId() const override { return astNodeId_; }
     std::string name() const override { return name_; }
     bool isSameType(const type::Type *otherType) const override { return this == otherType; };
@@ -428,18 +613,13 @@ public:
     std::vector<std::string> templateParameterNames() { return templateParameterNames_; }
     int templateParameterCount() { return (int) templateParameterNames_.size(); }
 
-    ClassType *findExpandedClassType(const gc_ref_vector<type::Type> &templateArgs) {
-        // O(n)... could also be optimized
-        for(const auto &entry : expandedClasses_) {
-            if(entry.templateArgsMatch(templateArgs)) {
-               return &entry.classType();
-            }
-        }
-        return nullptr;
+    ClassType *findExpandedClassType(const gc_ref_vector<type::Type> &templateArgs) const {
+        auto found = expandedClasses_.find(TypeArgumentsKey(templateArgs));
+        return found == expandedClasses_.end() ? nullptr : found->second;
     }
 
     void addExpandedClass(const gc_ref_vector<type::Type> &templateArgs, type::ClassType &classType) {
-        expandedClasses_.emplace_back(templateArgs, classType);
+        expandedClasses_.emplace(TypeArgumentsKey(templateArgs), &classType);
     }
 };
 
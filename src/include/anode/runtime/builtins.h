@@ -1,6 +1,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <string>
 #include <unordered_map>
 
 namespace anode { namespace runtime {
@@ -9,6 +12,7 @@ typedef uint64_t symbolptr_t;
 
 std::unordered_map<std::string, symbolptr_t> getBuiltins();
 
-extern unsigned int AssertPassCount;
+/** Incremented by every thread which executes JITd code, including those executing spawned tasks. */
+extern std::atomic<unsigned int> AssertPassCount;
 
 }}
\ No newline at end of file
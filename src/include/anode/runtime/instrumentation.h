@@ -0,0 +1,30 @@
+#pragma once
+
+#include "anode.h"
+
+#include <cstdint>
+#include <ostream>
+
+namespace anode { namespace runtime { namespace instrumentation {
+
+/**
+ * The counters of instrumented modules (see back::ProfileOptions), which count how many times each function was called
+ * and each destination of each branch was taken.  The increments are not atomic so the counts of code executed by more
+ * than one thread at a time are approximate.
+ */
+
+/**
+ * Writes the counters of every instrumented module loaded so far, one per line:  the count followed by a space and the
+ * name of the counter.  Returns the number of counters written.
+ */
+size_t writeCounters(std::ostream &out);
+
+extern "C" {
+    /**
+     * Invoked by the initialization function of each instrumented module to register its counters, whose names are
+     * separated by newlines.
+     */
+    void anode_register_counters(const char *names, uint64_t *counters, int count);
+}
+
+}}}
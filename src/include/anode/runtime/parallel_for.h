@@ -0,0 +1,33 @@
+#pragma once
+
+#include "anode.h"
+
+#include <cstdint>
+
+namespace anode { namespace runtime {
+
+/**
+ * The function which a parallel for expression emits for its body.  It executes the iterations [begin, end) and, if the
+ * loop is a reduction, combines the value of each iteration with the partial result which is pointed to by partial.
+ */
+typedef void (*loop_chunk_func_t)(void *context, int32_t begin, int32_t end, void *partial);
+
+/** Combines the partial result of a chunk of a reduction (from) with that of the chunk which precedes it (into). */
+typedef void (*loop_combine_func_t)(void *into, void *from);
+
+extern "C" {
+    /**
+     * Executes the iterations [begin, end) of a parallel for on the calling thread and the worker threads and returns once
+     * all of them are complete.  context is passed to each invocation of chunk and allows the body of the loop to access the
+     * local variables of the function containing it.
+     *
+     * For reductions, result points to resultSize bytes which hold the identity of the reduction's operator when this is
+     * invoked and the combined result of every iteration when it returns.  Otherwise combine is nullptr.
+     *
+     * If any iteration throws (i.e. a failed assertion), the exception is rethrown once every chunk is complete.
+     */
+    void anode_parallel_for(loop_chunk_func_t chunk, loop_combine_func_t combine, void *context, int32_t begin, int32_t end,
+                            void *result, uint32_t resultSize);
+}
+
+}}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "anode.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace anode { namespace runtime { namespace profiler {
+
+/**
+ * A sampling profiler which, every time the process has used a fixed amount of CPU time (SIGPROF), records the
+ * instruction pointer of whichever thread is executing and walks its frame pointers to record the return addresses of its
+ * callers.  It requires no permissions, unlike perf.  Symbolizing the addresses is left to the caller, since only the JIT
+ * knows where the functions it generated are.
+ *
+ * Frames of code compiled without frame pointers are missing and may truncate the stack.
+ */
+
+/** The maximum number of frames recorded per sample, the outermost frames of deeper stacks are dropped. */
+const unsigned MaxFrames = 64;
+
+/** Instruction pointers, the innermost first.  All but the first are return addresses. */
+typedef std::vector<uintptr_t> Stack;
+
+/**
+ * Records the bounds of the calling thread's stack.  Without them only the innermost frame of the thread's samples can
+ * be recorded, since walking the frame pointers would risk reading outside of the stack.  Threads which execute JITd
+ * code (the main thread and the task workers) must call this once.
+ */
+void registerThread();
+
+/**
+ * Starts sampling frequency times per second of CPU time until stop() is invoked.  At most capacity samples are kept,
+ * any more are dropped.
+ */
+void start(unsigned frequency, size_t capacity);
+
+/** Stops sampling.  Does nothing if the profiler was not started. */
+void stop();
+
+/** Returns the samples recorded since start(...), which must have been stopped, and the number that were dropped. */
+std::vector<Stack> takeSamples(size_t &droppedCount);
+
+}}}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "anode.h"
+
+namespace anode { namespace runtime {
+
+/**
+ * The function which a spawn expression emits for each spawned call.  It reads the arguments from the frame, invokes the
+ * spawned function and stores its result at the start of the frame.
+ */
+typedef void (*task_func_t)(void *frame);
+
+/** The number of worker threads which execute spawned tasks, which are started if they haven't been already. */
+unsigned workerCount();
+
+/** The index of the calling thread if it is one of the worker threads, otherwise -1. */
+int currentWorkerIndex();
+
+/** The ExecutionContext on behalf of which the calling thread is executing JITd code, or nullptr if there isn't one. */
+void *currentExecutionContext();
+
+/**
+ * Makes an ExecutionContext current for the calling thread for the lifetime of this object.  Each thread has its own
+ * current ExecutionContext:  a spawned task executes with the one which was current for the thread which spawned it.
+ */
+class ExecutionContextScope {
+    void *previous_;
+public:
+    NO_COPY_NO_ASSIGN(ExecutionContextScope)
+    explicit ExecutionContextScope(void *executionContext);
+    ~ExecutionContextScope();
+};
+
+extern "C" {
+    /**
+     * Schedules a call to func with a frame allocated by __malloc__ and returns a handle to the task.  The task is executed
+     * by a pool of worker threads, which is started by the first spawn.
+     */
+    void *anode_spawn(task_func_t func, void *frame);
+
+    /**
+     * Waits for the task to complete, executing other tasks in the meantime, and returns its frame.  Rethrows any exception
+     * thrown by the task (i.e. a failed assertion).
+     */
+    void *anode_join(void *task);
+
+    void *anode_execution_context();
+}
+
+}}
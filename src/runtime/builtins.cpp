@@ -1,4 +1,7 @@
 #include "runtime/builtins.h"
+#include "runtime/tasks.h"
+#include "runtime/parallel_for.h"
+#include "runtime/instrumentation.h"
 
 #include <iostream>
 #include <sstream>
@@ -7,7 +10,7 @@
 
 namespace anode { namespace runtime {
 
-unsigned int AssertPassCount;
+std::atomic<unsigned int> AssertPassCount{0};
 
 extern "C" {
     void assert_pass() {
@@ -26,6 +29,35 @@ extern "C" {
         std::memset(mem, 0, size);
         return (uint64_t) mem;
     }
+
+    /**
+     * Allocates an array:  the length followed by the elements, which begin at elementsOffset.  The GC doesn't need to
+     * scan arrays whose elements don't contain pointers, so those are allocated from the atomic heap.
+     */
+    void *anode_new_array(int length, unsigned int elementSize, unsigned int elementsOffset, bool containsPointers) {
+        if(length < 0) {
+            std::stringstream out;
+            out << "Cannot create an array with a negative length (" << length << ")";
+            throw exception::AnodeNegativeArrayLengthException(out.str());
+        }
+        size_t size = elementsOffset + (size_t) length * elementSize;
+        void *mem;
+        if(containsPointers) {
+            //GC_MALLOC clears the memory for us.
+            mem = GC_MALLOC(size);
+        } else {
+            mem = GC_MALLOC_ATOMIC(size);
+            std::memset(mem, 0, size);
+        }
+        *reinterpret_cast<int*>(mem) = length;
+        return mem;
+    }
+
+    void anode_index_out_of_bounds(char *filename, unsigned int lineNo, int index, int length) {
+        std::stringstream out;
+        out << filename << ":" << lineNo << ": " << "Index " << index << " is out of bounds for an array of length " << length;
+        throw exception::AnodeIndexOutOfBoundsException(out.str());
+    }
 }
 
 std::unordered_map<std::string, symbolptr_t> getBuiltins() {
@@ -34,6 +66,13 @@ std::unordered_map<std::string, symbolptr_t> getBuiltins() {
         { "__assert_failed__", reinterpret_cast<symbolptr_t>(assert_fail) },
         { "__assert_passed__", reinterpret_cast<symbolptr_t>(assert_pass) },
         { "__malloc__", reinterpret_cast<symbolptr_t>(anode_malloc) },
+        { "__spawn__", reinterpret_cast<symbolptr_t>(anode_spawn) },
+        { "__join__", reinterpret_cast<symbolptr_t>(anode_join) },
+        { "__parallel_for__", reinterpret_cast<symbolptr_t>(anode_parallel_for) },
+        { "__new_array__", reinterpret_cast<symbolptr_t>(anode_new_array) },
+        { "__index_out_of_bounds__", reinterpret_cast<symbolptr_t>(anode_index_out_of_bounds) },
+        { "__execution_context__", reinterpret_cast<symbolptr_t>(anode_execution_context) },
+        { "__register_counters__", reinterpret_cast<symbolptr_t>(instrumentation::anode_register_counters) },
 
     };
 
@@ -0,0 +1,43 @@
+#include "runtime/instrumentation.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anode { namespace runtime { namespace instrumentation {
+
+namespace {
+
+struct RegisteredCounter {
+    std::string name;
+    const uint64_t *counter;
+};
+
+std::mutex CountersMutex;
+/** The counters of every instrumented module, which are never unloaded. */
+std::vector<RegisteredCounter> Counters;
+
+}
+
+size_t writeCounters(std::ostream &out) {
+    std::lock_guard<std::mutex> lock{CountersMutex};
+    for(const RegisteredCounter &registered : Counters) {
+        out << *registered.counter << " " << registered.name << "\n";
+    }
+    return Counters.size();
+}
+
+extern "C" {
+    void anode_register_counters(const char *names, uint64_t *counters, int count) {
+        std::lock_guard<std::mutex> lock{CountersMutex};
+        const char *name = names;
+        for(int i = 0; i < count; ++i) {
+            const char *end = name;
+            while(*end && *end != '\n') ++end;
+            Counters.push_back(RegisteredCounter { std::string(name, end), &counters[i] });
+            name = *end ? end + 1 : end;
+        }
+    }
+}
+
+}}}
@@ -0,0 +1,133 @@
+#include "runtime/parallel_for.h"
+#include "runtime/tasks.h"
+#include "common/containers.h"
+#include "common/stats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+namespace anode { namespace runtime {
+
+namespace {
+
+/**
+ * The number of chunks into which the range is initially split for each thread.  More than one so that a thread which
+ * finishes early has something to steal, and a chunk which is stolen is split further (see runSpawnedChunk(...)), so
+ * this can be small.
+ */
+const int64_t ChunksPerThread = 4;
+
+/**
+ * Describes a parallel for.  This lives on the stack of anode_parallel_for(...), which doesn't return until every chunk
+ * is complete.
+ */
+struct ParallelLoop {
+    loop_chunk_func_t chunk;
+    loop_combine_func_t combine;
+    void *context;
+    //The identity of the reduction's operator, with which the partial result of each spawned chunk is initialized.
+    void *identity;
+    uint32_t resultSize;
+};
+
+/** A range of iterations which was spawned as a task, whose frame this is. */
+struct LoopChunk : public gc {
+    const ParallelLoop &loop;
+    const int32_t begin;
+    const int32_t end;
+    const int64_t grainSize;
+    const int spawningWorker;
+    void * const partial;
+
+    LoopChunk(const ParallelLoop &loop, int32_t begin, int32_t end, int64_t grainSize, int spawningWorker, void *partial)
+        : loop{loop}, begin{begin}, end{end}, grainSize{grainSize}, spawningWorker{spawningWorker}, partial{partial} { }
+};
+
+void *newPartialResult(const ParallelLoop &loop) {
+    if(!loop.combine) {
+        return nullptr;
+    }
+    //Reductions are only of scalars, which are not pointers.
+    void *partial = GC_MALLOC_ATOMIC(loop.resultSize);
+    std::memcpy(partial, loop.identity, loop.resultSize);
+    return partial;
+}
+
+void runSpawnedChunk(void *frame);
+
+/**
+ * Splits the range in halves until it is no larger than grainSize, spawning the upper halves and executing what remains
+ * on the calling thread, then joins the spawned chunks and combines their partial results with its own.
+ */
+void runRange(const ParallelLoop &loop, int32_t begin, int32_t end, int64_t grainSize, void *partial) {
+    //The largest upper half is spawned first, so it is the first to be stolen.
+    gc_vector<std::pair<void*, LoopChunk*>> spawned;
+    while((int64_t)end - begin > grainSize) {
+        auto middle = (int32_t)(begin + ((int64_t)end - begin) / 2);
+        auto *chunk = new LoopChunk(loop, middle, end, grainSize, currentWorkerIndex(), newPartialResult(loop));
+        spawned.emplace_back(anode_spawn(runSpawnedChunk, chunk), chunk);
+        end = middle;
+    }
+
+    std::exception_ptr exception;
+    try {
+        loop.chunk(loop.context, begin, end, partial);
+    } catch(...) {
+        exception = std::current_exception();
+    }
+
+    //Joining in the reverse order combines the partial results in the order of their ranges.  Every chunk must be joined,
+    //even after an exception, because they reference the loop.
+    for(auto itr = spawned.rbegin(); itr != spawned.rend(); ++itr) {
+        try {
+            anode_join(itr->first);
+            if(loop.combine && !exception) {
+                loop.combine(partial, itr->second->partial);
+            }
+        } catch(...) {
+            if(!exception) {
+                exception = std::current_exception();
+            }
+        }
+    }
+
+    if(exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void runSpawnedChunk(void *frame) {
+    auto &chunk = *static_cast<LoopChunk*>(frame);
+    int64_t grainSize = chunk.grainSize;
+    //A stolen chunk was taken by a thread which had run out of work, so it is split more finely to balance the load.
+    if(currentWorkerIndex() != chunk.spawningWorker) {
+        grainSize = std::max(grainSize / 2, (int64_t)1);
+    }
+    runRange(chunk.loop, chunk.begin, chunk.end, grainSize, chunk.partial);
+}
+
+}
+
+extern "C" {
+    void anode_parallel_for(loop_chunk_func_t chunk, loop_combine_func_t combine, void *context, int32_t begin, int32_t end,
+                            void *result, uint32_t resultSize) {
+        if(begin >= end) {
+            return;
+        }
+        stats::global().increment("runtime.parallelLoops");
+
+        ParallelLoop loop{chunk, combine, context, nullptr, resultSize};
+        if(combine) {
+            loop.identity = GC_MALLOC_ATOMIC(resultSize);
+            std::memcpy(loop.identity, result, resultSize);
+        }
+
+        int64_t threadCount = workerCount() + 1;
+        int64_t grainSize = std::max(((int64_t)end - begin) / (threadCount * ChunksPerThread), (int64_t)1);
+        runRange(loop, begin, end, grainSize, result);
+    }
+}
+
+}}
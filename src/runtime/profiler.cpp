@@ -0,0 +1,163 @@
+#include "runtime/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <memory>
+#include <thread>
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+namespace anode { namespace runtime { namespace profiler {
+
+namespace {
+
+struct Sample {
+    unsigned frameCount;
+    uintptr_t frames[MaxFrames];
+};
+
+//The samples are preallocated and claimed by incrementing NextSample because the signal handler may not allocate or lock.
+std::unique_ptr<Sample[]> Samples;
+size_t Capacity = 0;
+std::atomic<size_t> NextSample{0};
+bool Started = false;
+bool HandlerInstalled = false;
+
+//The handler remains installed once stop() has been invoked since a signal may still be pending, but it does nothing.
+std::atomic<bool> Sampling{false};
+//The number of threads executing handleSignal(...), which stop() waits for.
+std::atomic<unsigned> ActiveHandlers{0};
+
+thread_local uintptr_t StackLow = 0;
+thread_local uintptr_t StackHigh = 0;
+
+/** Reads the instruction, frame and stack pointers of the interrupted code.  Returns false on unsupported platforms. */
+bool readRegisters(void *context, uintptr_t &instructionPointer, uintptr_t &framePointer, uintptr_t &stackPointer) {
+    const mcontext_t &machineContext = static_cast<ucontext_t*>(context)->uc_mcontext;
+#if defined(__x86_64__)
+    instructionPointer = (uintptr_t)machineContext.gregs[REG_RIP];
+    framePointer = (uintptr_t)machineContext.gregs[REG_RBP];
+    stackPointer = (uintptr_t)machineContext.gregs[REG_RSP];
+    return true;
+#elif defined(__aarch64__)
+    instructionPointer = (uintptr_t)machineContext.pc;
+    framePointer = (uintptr_t)machineContext.regs[29];
+    stackPointer = (uintptr_t)machineContext.sp;
+    return true;
+#else
+    (void)machineContext;
+    (void)instructionPointer;
+    (void)framePointer;
+    (void)stackPointer;
+    return false;
+#endif
+}
+
+void handleSignal(int, siginfo_t *, void *context) {
+    int savedErrno = errno;
+    ActiveHandlers++;
+    size_t index = Sampling ? NextSample.fetch_add(1, std::memory_order_relaxed) : Capacity;
+    if(index < Capacity) {
+        Sample &sample = Samples[index];
+        sample.frameCount = 0;
+        uintptr_t instructionPointer, framePointer, stackPointer;
+        if(readRegisters(context, instructionPointer, framePointer, stackPointer)) {
+            sample.frames[sample.frameCount++] = instructionPointer;
+            //Each frame begins with the caller's frame pointer followed by the return address.  Stacks grow downwards, so
+            //each caller's frame must be above its callee's and within the stack, otherwise this isn't a frame pointer.
+            uintptr_t low = std::max(stackPointer, StackLow);
+            while(sample.frameCount < MaxFrames
+                  && framePointer % sizeof(uintptr_t) == 0
+                  && framePointer >= low
+                  && framePointer + 2 * sizeof(uintptr_t) <= StackHigh) {
+                auto frame = reinterpret_cast<const uintptr_t*>(framePointer);
+                if(frame[1] == 0) break;
+                sample.frames[sample.frameCount++] = frame[1];
+                if(frame[0] <= framePointer) break;
+                framePointer = frame[0];
+            }
+        }
+    }
+    ActiveHandlers--;
+    errno = savedErrno;
+}
+
+void setTimer(unsigned frequency) {
+    itimerval timer{};
+    if(frequency > 0) {
+        timer.it_interval.tv_sec = 0;
+        timer.it_interval.tv_usec = std::max(1000000 / (long)frequency, 1L);
+        timer.it_value = timer.it_interval;
+    }
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+}
+
+void registerThread() {
+    pthread_attr_t attributes;
+    if(pthread_getattr_np(pthread_self(), &attributes) != 0) {
+        return;
+    }
+    void *stackAddress;
+    size_t stackSize;
+    if(pthread_attr_getstack(&attributes, &stackAddress, &stackSize) == 0) {
+        StackLow = (uintptr_t)stackAddress;
+        StackHigh = StackLow + stackSize;
+    }
+    pthread_attr_destroy(&attributes);
+}
+
+void start(unsigned frequency, size_t capacity) {
+    ASSERT(!Started && frequency > 0);
+    //Not initialized, so only the pages which are actually used are committed.
+    Samples.reset(new Sample[capacity]);
+    Capacity = capacity;
+    NextSample = 0;
+
+    if(!HandlerInstalled) {
+        struct sigaction action{};
+        action.sa_sigaction = handleSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        HandlerInstalled = true;
+    }
+    Sampling = true;
+    setTimer(frequency);
+    Started = true;
+}
+
+void stop() {
+    if(!Started) return;
+    setTimer(0);
+    Sampling = false;
+    while(ActiveHandlers > 0) {
+        std::this_thread::yield();
+    }
+    Started = false;
+}
+
+std::vector<Stack> takeSamples(size_t &droppedCount) {
+    ASSERT(!Started);
+    size_t recorded = NextSample.load();
+    size_t count = std::min(recorded, Capacity);
+    droppedCount = recorded - count;
+
+    std::vector<Stack> stacks;
+    stacks.reserve(count);
+    for(size_t i = 0; i < count; ++i) {
+        const Sample &sample = Samples[i];
+        stacks.emplace_back(sample.frames, sample.frames + sample.frameCount);
+    }
+    Samples.reset();
+    Capacity = 0;
+    NextSample = 0;
+    return stacks;
+}
+
+}}}
@@ -0,0 +1,251 @@
+#include "runtime/tasks.h"
+#include "runtime/profiler.h"
+#include "common/thread_pool.h"
+#include "common/stats.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace anode { namespace runtime {
+
+namespace {
+
+thread_local void *CurrentExecutionContext = nullptr;
+
+/** The index of the calling thread's queue if it is a worker thread, otherwise -1. */
+thread_local int WorkerIndex = -1;
+
+/**
+ * A spawned function call.  Tasks are garbage collected:  they are referenced by a TaskQueue until they are started and by
+ * the JITd code which spawned them until they are joined.  The task references its frame, which holds the arguments of the
+ * call and, once the task is complete, its result.
+ *
+ * Inherits from gc_cleanup so that the exception, if any, is released when the task is collected.
+ */
+struct Task : public gc_cleanup {
+    const task_func_t func;
+    void * const frame;
+    void * const executionContext;
+    std::atomic<bool> complete{false};
+    std::exception_ptr exception;
+
+    Task(task_func_t func, void *frame, void *executionContext)
+        : func{func}, frame{frame}, executionContext{executionContext} { }
+};
+
+/**
+ * The tasks spawned by one thread.  The owning thread pushes and pops tasks at the back, so that it executes the most
+ * recently spawned (and most likely to still be in its cache) first, while other threads steal the oldest from the front.
+ */
+class TaskQueue {
+    std::mutex mutex_;
+    //This queue is not itself garbage collected, so its storage must be traceable for the tasks to be reachable.
+    std::deque<Task*, traceable_allocator<Task*>> tasks_;
+public:
+    void push(Task *task) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        tasks_.push_back(task);
+    }
+
+    Task *popNewest() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if(tasks_.empty()) {
+            return nullptr;
+        }
+        Task *task = tasks_.back();
+        tasks_.pop_back();
+        return task;
+    }
+
+    Task *stealOldest() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if(tasks_.empty()) {
+            return nullptr;
+        }
+        Task *task = tasks_.front();
+        tasks_.pop_front();
+        return task;
+    }
+};
+
+stats::AtomicCounter &tasksSpawned() {
+    static stats::AtomicCounter counter{"runtime.tasksSpawned"};
+    return counter;
+}
+
+stats::AtomicCounter &tasksStolen() {
+    static stats::AtomicCounter counter{"runtime.tasksStolen"};
+    return counter;
+}
+
+/**
+ * A work-stealing pool of worker threads, which are registered with the garbage collector.  Each worker has its own
+ * TaskQueue and the threads which aren't workers (i.e. the main thread) share one more.  A thread which is out of work
+ * steals from the other queues and a thread which is joining a task executes other tasks until it is complete.
+ */
+class TaskScheduler {
+    const unsigned workerCount_;
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex sleepMutex_;
+    std::condition_variable wakeUp_;
+    //The number of tasks which are in queues, guarded by sleepMutex_ so that no wake up is missed.
+    unsigned queuedCount_ = 0;
+
+    unsigned ownQueueIndex() const {
+        return WorkerIndex >= 0 ? (unsigned)WorkerIndex : workerCount_;
+    }
+
+    Task *findTask() {
+        unsigned ownIndex = ownQueueIndex();
+        Task *task = queues_[ownIndex]->popNewest();
+        if(!task) {
+            for(size_t i = 1; i < queues_.size() && !task; ++i) {
+                task = queues_[(ownIndex + i) % queues_.size()]->stealOldest();
+            }
+            if(task && stats::global().enabled()) {
+                tasksStolen().increment();
+            }
+        }
+        if(task) {
+            std::lock_guard<std::mutex> lock{sleepMutex_};
+            --queuedCount_;
+        }
+        return task;
+    }
+
+    void run(Task &task) {
+        {
+            ExecutionContextScope scope{task.executionContext};
+            try {
+                task.func(task.frame);
+            } catch(...) {
+                task.exception = std::current_exception();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock{sleepMutex_};
+            task.complete = true;
+        }
+        wakeUp_.notify_all();
+    }
+
+    void workerMain(unsigned index) {
+        GcThreadRegistration registration;
+        profiler::registerThread();
+        WorkerIndex = (int)index;
+        while(true) {
+            if(Task *task = findTask()) {
+                run(*task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{sleepMutex_};
+            wakeUp_.wait(lock, [this] { return queuedCount_ > 0; });
+        }
+    }
+
+public:
+    NO_COPY_NO_ASSIGN(TaskScheduler)
+
+    explicit TaskScheduler(unsigned workerCount) : workerCount_{workerCount} {
+        //Must be called by a registered thread (i.e. the main thread) before any other threads register themselves.
+        GC_allow_register_threads();
+        for(unsigned i = 0; i <= workerCount_; ++i) {
+            queues_.emplace_back(new TaskQueue());
+        }
+        threads_.reserve(workerCount_);
+        for(unsigned i = 0; i < workerCount_; ++i) {
+            threads_.emplace_back([this, i] { workerMain(i); });
+        }
+    }
+
+    unsigned workerCount() const { return workerCount_; }
+
+    void submit(Task &task) {
+        //Counted before it is published, otherwise a thief could take it and decrement queuedCount_ first.
+        {
+            std::lock_guard<std::mutex> lock{sleepMutex_};
+            ++queuedCount_;
+        }
+        queues_[ownQueueIndex()]->push(&task);
+        wakeUp_.notify_one();
+    }
+
+    /** Executes other tasks until the specified task is complete. */
+    void wait(Task &task) {
+        while(!task.complete) {
+            if(Task *other = findTask()) {
+                run(*other);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{sleepMutex_};
+            wakeUp_.wait(lock, [&] { return task.complete || queuedCount_ > 0; });
+        }
+    }
+};
+
+/**
+ * Started by the first spawn and never stopped, since tasks which are never joined may still be executing when the
+ * program exits.
+ */
+TaskScheduler &scheduler() {
+    static TaskScheduler *instance = new TaskScheduler(ThreadPool::defaultThreadCount());
+    return *instance;
+}
+
+}
+
+unsigned workerCount() {
+    return scheduler().workerCount();
+}
+
+int currentWorkerIndex() {
+    return WorkerIndex;
+}
+
+void *currentExecutionContext() {
+    return CurrentExecutionContext;
+}
+
+ExecutionContextScope::ExecutionContextScope(void *executionContext) : previous_{CurrentExecutionContext} {
+    CurrentExecutionContext = executionContext;
+}
+
+ExecutionContextScope::~ExecutionContextScope() {
+    CurrentExecutionContext = previous_;
+}
+
+extern "C" {
+    void *anode_spawn(task_func_t func, void *frame) {
+        Task *task = new Task(func, frame, CurrentExecutionContext);
+        scheduler().submit(*task);
+        if(stats::global().enabled()) {
+            tasksSpawned().increment();
+        }
+        return task;
+    }
+
+    void *anode_join(void *taskPtr) {
+        if(!taskPtr) {
+            throw exception::Exception("Attempted to join a task which was never spawned.");
+        }
+        Task &task = *static_cast<Task*>(taskPtr);
+        scheduler().wait(task);
+        if(task.exception) {
+            std::rethrow_exception(task.exception);
+        }
+        return task.frame;
+    }
+
+    void *anode_execution_context() {
+        return CurrentExecutionContext;
+    }
+}
+
+}}
@@ -0,0 +1,542 @@
+/**
+ * Measures the end-to-end performance of Anode programs, reporting the time spent in each phase separately.
+ *
+ * Usage:  anode_bench [options] files...
+ *
+ * Each file is executed by a new ExecutionContext the specified number of times (following some warm up executions which
+ * are not measured) and the minimum, median and 95th percentile of the wall time of each phase are reported:
+ *
+ *  - parse:  lexing and parsing,
+ *  - analysis:  the front end's passes, see ExecutionContext::prepareModule(...),
+ *  - irEmission:  emitting and verifying the LLVM IR,
+ *  - jitCodegen:  the LLVM optimization passes and generation of machine code and
+ *  - execution:  running the module's initialization function, i.e. the program itself.
+ *
+ * The results may be written as JSON (--json) and compared against a previously written file (--baseline), in which case
+ * the exit code is non-zero if the median of any phase of any benchmark is slower than the baseline's by more than the
+ * threshold.  Since very short phases are noisy, differences smaller than --noise-ms are never considered regressions.
+ *
+ * Where perf_event_open(2) is permitted, the medians of the CPU's cycles, instructions, cache misses and branch misses
+ * counted during each phase are also reported, which are less affected by other processes than the wall time is.
+ *
+ * With --native-dir the reference implementation of each benchmark (see benchmarks/reference) is also executed the same
+ * number of times, so that the execution phase can be compared to native code.
+ */
+
+#include "execute/execute.h"
+#include "front/parse.h"
+#include "common/stats.h"
+#include "common/string.h"
+#include "../anode/cxxopts.h"
+
+#include <gc/gc.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace anode;
+using namespace anode::front;
+
+namespace {
+
+enum Phase : size_t {
+    Parse,
+    Analysis,
+    IrEmission,
+    JitCodegen,
+    Execution,
+    Total,
+    PhaseCount
+};
+
+const char *PhaseNames[PhaseCount] = { "parse", "analysis", "irEmission", "jitCodegen", "execution", "total" };
+
+/** The wall time of a phase and the hardware events counted during it. */
+struct PhaseSample {
+    double ms = 0;
+    stats::CounterValues counters;
+
+    PhaseSample &operator+=(const PhaseSample &other) {
+        ms += other.ms;
+        counters += other.counters;
+        return *this;
+    }
+};
+
+typedef std::array<PhaseSample, PhaseCount> PhaseSamples;
+
+struct Summary {
+    double minMs = 0;
+    double medianMs = 0;
+    double p95Ms = 0;
+    /** The median of each counter. */
+    stats::CounterValues counters;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::array<Summary, PhaseCount> phases;
+    /** The execution time of the reference implementation, if it was run. */
+    bool hasNative = false;
+    Summary native;
+};
+
+double toMilliseconds(stats::clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/** Sums the wall time and counters of the phases collected by stats::global() whose names begin with prefix. */
+PhaseSample collected(const std::string &prefix) {
+    PhaseSample total;
+    for(const stats::PhaseTiming &timing : stats::global().phases()) {
+        if(timing.name.compare(0, prefix.size(), prefix) == 0) {
+            total.ms += toMilliseconds(timing.elapsed);
+            total.counters += timing.counters;
+        }
+    }
+    return total;
+}
+
+/**
+ * Executes the source once.  The JIT is shared by every ExecutionContext, so each execution must have a module name of
+ * its own, which keeps the file's name as a prefix so that its imports are still resolved relative to it.
+ */
+PhaseSamples runOnce(const std::string &filename, const std::string &source, unsigned execution, unsigned optimizationLevel) {
+    //So that garbage left by the previous execution isn't collected during this one.
+    GC_gcollect();
+    stats::Statistics &statistics = stats::global();
+    statistics.reset();
+
+    std::unique_ptr<execute::ExecutionContext> executionContext = execute::createExecutionContext();
+    executionContext->setOptimizationLevel(optimizationLevel);
+    PhaseSamples samples;
+
+    stats::CounterValues startCounters = statistics.readCounters();
+    auto start = stats::clock::now();
+    std::istringstream input{source};
+    ast::Module &module = parseModule(input, string::format("%s#%u", filename.c_str(), execution));
+    stats::CounterValues parsedCounters = statistics.readCounters();
+    auto parsed = stats::clock::now();
+    if(executionContext->prepareModule(&module)) {
+        throw std::runtime_error("Semantic analysis of " + filename + " failed.");
+    }
+    stats::CounterValues preparedCounters = statistics.readCounters();
+    auto prepared = stats::clock::now();
+
+    //Emitting the IR, compiling it and running the initialization function all happen within executeModule(...), each
+    //of which is timed by the back end, the JIT or ExecutionContext.
+    executionContext->executeModule(&module);
+    auto executed = stats::clock::now();
+
+    samples[Parse].ms = toMilliseconds(parsed - start);
+    samples[Parse].counters = parsedCounters - startCounters;
+    samples[Analysis].ms = toMilliseconds(prepared - parsed);
+    samples[Analysis].counters = preparedCounters - parsedCounters;
+    samples[IrEmission] = collected("back.emitModule");
+    samples[JitCodegen] = collected("back.opt.");
+    samples[JitCodegen] += collected("back.codegen");
+    samples[Execution] = collected("execute.initModule");
+    samples[Total].ms = toMilliseconds(executed - start);
+    samples[Total].counters = statistics.readCounters() - startCounters;
+    return samples;
+}
+
+/** The nearest-rank percentile of the sorted samples. */
+double percentile(const std::vector<double> &sorted, double fraction) {
+    size_t rank = (size_t)std::ceil(fraction * sorted.size());
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+/**
+ * Runs the reference implementation of a benchmark, which writes the time taken by its kernel to stdout and exits with a
+ * non-zero status if its result is wrong.
+ */
+double runNative(const std::string &executable) {
+    FILE *output = popen(executable.c_str(), "r");
+    if(!output) {
+        throw std::runtime_error("Couldn't execute " + executable);
+    }
+    double elapsedMs = -1;
+    int scanned = fscanf(output, "%lf", &elapsedMs);
+    if(pclose(output) != 0 || scanned != 1) {
+        throw std::runtime_error(executable + " failed.");
+    }
+    return elapsedMs;
+}
+
+/** The reference implementation of the benchmark in filename (i.e. "benchmarks/fib.an") is named "reference_fib". */
+std::string nativeExecutable(const std::string &nativeDirectory, const std::string &filename) {
+    std::string stem = filename.substr(filename.find_last_of('/') + 1);
+    stem = stem.substr(0, stem.find_last_of('.'));
+    return nativeDirectory + "/reference_" + stem;
+}
+
+/** The median of one of the counters of the samples. */
+uint64_t medianCounter(const std::vector<PhaseSample> &samples, uint64_t stats::CounterValues::*counter) {
+    std::vector<uint64_t> values;
+    for(const PhaseSample &sample : samples) {
+        values.push_back(sample.counters.*counter);
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = (values.size() + 1) / 2;
+    return values[rank - 1];
+}
+
+Summary summarize(const std::vector<PhaseSample> &samples) {
+    std::vector<double> sorted;
+    for(const PhaseSample &sample : samples) {
+        sorted.push_back(sample.ms);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    Summary summary;
+    summary.minMs = sorted.front();
+    summary.medianMs = percentile(sorted, 0.5);
+    summary.p95Ms = percentile(sorted, 0.95);
+    summary.counters.cycles = medianCounter(samples, &stats::CounterValues::cycles);
+    summary.counters.instructions = medianCounter(samples, &stats::CounterValues::instructions);
+    summary.counters.cacheMisses = medianCounter(samples, &stats::CounterValues::cacheMisses);
+    summary.counters.branchMisses = medianCounter(samples, &stats::CounterValues::branchMisses);
+    return summary;
+}
+
+BenchmarkResult runBenchmark(
+    const std::string &filename,
+    unsigned warmups,
+    unsigned iterations,
+    unsigned optimizationLevel,
+    const std::string &nativeDirectory
+) {
+    std::ifstream file{filename};
+    if(!file) {
+        throw std::runtime_error("Couldn't open " + filename);
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string source = text.str();
+
+    std::array<std::vector<PhaseSample>, PhaseCount> samples;
+    for(unsigned i = 0; i < warmups + iterations; ++i) {
+        PhaseSamples execution = runOnce(filename, source, i, optimizationLevel);
+        if(i < warmups) continue;
+        for(size_t phase = 0; phase < PhaseCount; ++phase) {
+            samples[phase].push_back(execution[phase]);
+        }
+    }
+
+    BenchmarkResult result;
+    result.name = filename;
+    for(size_t phase = 0; phase < PhaseCount; ++phase) {
+        result.phases[phase] = summarize(samples[phase]);
+    }
+
+    if(!nativeDirectory.empty()) {
+        std::string executable = nativeExecutable(nativeDirectory, filename);
+        std::vector<PhaseSample> nativeSamples;
+        for(unsigned i = 0; i < warmups + iterations; ++i) {
+            PhaseSample sample;
+            sample.ms = runNative(executable);
+            if(i >= warmups) nativeSamples.push_back(sample);
+        }
+        result.hasNative = true;
+        result.native = summarize(nativeSamples);
+    }
+    return result;
+}
+
+/** The ratio of the median execution time to that of the reference implementation. */
+double executionToNative(const BenchmarkResult &result) {
+    return result.phases[Execution].medianMs / std::max(result.native.medianMs, 0.001);
+}
+
+void writeReportRow(const char *name, const Summary &summary, std::ostream &out) {
+    out << "  " << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(3)
+        << std::setw(12) << summary.minMs << std::setw(12) << summary.medianMs << std::setw(12) << summary.p95Ms << "\n";
+}
+
+void writeCountersReport(const BenchmarkResult &result, std::ostream &out) {
+    out << std::left << std::setw(14) << "  Phase" << std::right << std::setw(16) << "Cycles" << std::setw(16) << "Instructions"
+        << std::setw(6) << "IPC" << std::setw(14) << "Cache misses" << std::setw(14) << "Branch misses" << "\n";
+    for(size_t phase = 0; phase < PhaseCount; ++phase) {
+        const stats::CounterValues &counters = result.phases[phase].counters;
+        out << "  " << std::left << std::setw(12) << PhaseNames[phase] << std::right
+            << std::setw(16) << counters.cycles << std::setw(16) << counters.instructions
+            << std::setw(6) << std::fixed << std::setprecision(2) << counters.ipc()
+            << std::setw(14) << counters.cacheMisses << std::setw(14) << counters.branchMisses << "\n";
+    }
+}
+
+void writeReport(const std::vector<BenchmarkResult> &results, std::ostream &out) {
+    for(const BenchmarkResult &result : results) {
+        out << result.name << "\n";
+        out << std::left << std::setw(14) << "  Phase" << std::right
+            << std::setw(12) << "Min (ms)" << std::setw(12) << "Median (ms)" << std::setw(12) << "p95 (ms)" << "\n";
+        for(size_t phase = 0; phase < PhaseCount; ++phase) {
+            writeReportRow(PhaseNames[phase], result.phases[phase], out);
+        }
+        if(result.hasNative) {
+            writeReportRow("native", result.native, out);
+            out << "  Execution takes " << std::setprecision(2) << executionToNative(result) << "x as long as native.\n";
+        }
+        if(result.phases[Total].counters.any()) {
+            writeCountersReport(result, out);
+        }
+    }
+}
+
+void writeJsonSummary(const Summary &summary, std::ostream &out) {
+    out << std::fixed << std::setprecision(6) << "{\"minMs\": " << summary.minMs << ", \"medianMs\": " << summary.medianMs
+        << ", \"p95Ms\": " << summary.p95Ms;
+    if(summary.counters.any()) {
+        out << ", \"cycles\": " << summary.counters.cycles << ", \"instructions\": " << summary.counters.instructions
+            << ", \"cacheMisses\": " << summary.counters.cacheMisses << ", \"branchMisses\": " << summary.counters.branchMisses;
+    }
+    out << "}";
+}
+
+std::string quoteJson(const std::string &str) {
+    std::string quoted = "\"";
+    for(char c : str) {
+        if(c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void writeJson(const std::vector<BenchmarkResult> &results, unsigned optimizationLevel, unsigned iterations, std::ostream &out) {
+    out << "{\n  \"optimizationLevel\": " << optimizationLevel << ",\n  \"iterations\": " << iterations
+        << ",\n  \"benchmarks\": [";
+    for(size_t i = 0; i < results.size(); ++i) {
+        out << (i ? ",\n" : "\n") << "    {\"name\": " << quoteJson(results[i].name) << ", \"phases\": {";
+        for(size_t phase = 0; phase < PhaseCount; ++phase) {
+            out << (phase ? ",\n" : "\n") << "      " << quoteJson(PhaseNames[phase]) << ": ";
+            writeJsonSummary(results[i].phases[phase], out);
+        }
+        out << "\n    }";
+        if(results[i].hasNative) {
+            out << ",\n    \"native\": ";
+            writeJsonSummary(results[i].native, out);
+            out << ", \"executionToNative\": " << executionToNative(results[i]);
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+/** Just enough of JSON to read back what writeJson(...) writes. */
+struct JsonValue {
+    double number = 0;
+    std::string string;
+    std::vector<std::pair<std::string, JsonValue>> members;
+    std::vector<JsonValue> elements;
+
+    /** Returns nullptr if this is not an object or has no such member. */
+    const JsonValue *member(const std::string &name) const {
+        for(const auto &m : members) {
+            if(m.first == name) return &m.second;
+        }
+        return nullptr;
+    }
+};
+
+class JsonReader {
+    std::istream &in_;
+
+    [[noreturn]] void fail(const std::string &message) {
+        throw std::runtime_error("Malformed baseline: " + message);
+    }
+
+    char next() {
+        in_ >> std::ws;
+        int c = in_.get();
+        if(c == EOF) fail("unexpected end of input");
+        return (char)c;
+    }
+
+    void expect(char expected) {
+        if(next() != expected) fail(std::string("expected '") + expected + "'");
+    }
+
+    bool consumeOptional(char c) {
+        in_ >> std::ws;
+        if(in_.peek() != c) return false;
+        in_.get();
+        return true;
+    }
+
+    std::string readString() {
+        expect('"');
+        std::string str;
+        for(int c = in_.get(); c != '"'; c = in_.get()) {
+            if(c == EOF) fail("unterminated string");
+            if(c == '\\') c = in_.get();
+            str += (char)c;
+        }
+        return str;
+    }
+
+public:
+    explicit JsonReader(std::istream &in) : in_{in} { }
+
+    JsonValue read() {
+        JsonValue value;
+        in_ >> std::ws;
+        int c = in_.peek();
+        if(c == '{') {
+            in_.get();
+            if(!consumeOptional('}')) {
+                do {
+                    std::string name = readString();
+                    expect(':');
+                    value.members.emplace_back(name, read());
+                } while(consumeOptional(','));
+                expect('}');
+            }
+        } else if(c == '[') {
+            in_.get();
+            if(!consumeOptional(']')) {
+                do {
+                    value.elements.push_back(read());
+                } while(consumeOptional(','));
+                expect(']');
+            }
+        } else if(c == '"') {
+            value.string = readString();
+        } else if(!(in_ >> value.number)) {
+            fail("expected a value");
+        }
+        return value;
+    }
+};
+
+/** Returns the number of regressions, each of which is also written to out. */
+unsigned compareWithBaseline(
+    const std::vector<BenchmarkResult> &results,
+    const JsonValue &baseline,
+    double thresholdPercent,
+    double noiseMs,
+    std::ostream &out
+) {
+    const JsonValue *baselineBenchmarks = baseline.member("benchmarks");
+    if(!baselineBenchmarks) {
+        throw std::runtime_error("The baseline has no benchmarks.");
+    }
+    unsigned regressions = 0;
+    for(const BenchmarkResult &result : results) {
+        const JsonValue *baselinePhases = nullptr;
+        for(const JsonValue &benchmark : baselineBenchmarks->elements) {
+            const JsonValue *name = benchmark.member("name");
+            if(name && name->string == result.name) {
+                baselinePhases = benchmark.member("phases");
+            }
+        }
+        if(!baselinePhases) {
+            out << result.name << ": not in the baseline\n";
+            continue;
+        }
+        for(size_t phase = 0; phase < PhaseCount; ++phase) {
+            const JsonValue *baselinePhase = baselinePhases->member(PhaseNames[phase]);
+            const JsonValue *baselineMedian = baselinePhase ? baselinePhase->member("medianMs") : nullptr;
+            if(!baselineMedian) continue;
+
+            double before = baselineMedian->number;
+            double after = result.phases[phase].medianMs;
+            if(after - before > noiseMs && after > before * (1 + thresholdPercent / 100)) {
+                regressions++;
+                out << "REGRESSION " << result.name << " " << PhaseNames[phase] << ": " << std::fixed << std::setprecision(3)
+                    << before << " ms -> " << after << " ms (+" << std::setprecision(1)
+                    << (before > 0 ? (after - before) / before * 100 : 100.0) << "%)\n";
+            }
+        }
+    }
+    return regressions;
+}
+
+}
+
+int main(int argc, char **argv) {
+    GC_INIT();
+
+    cxxopts::Options options("anode_bench", "Measures the time spent in each phase of executing Anode programs.");
+    options.add_options("")
+        ("h,help", "Display this text and exit", cxxopts::value<bool>(), "")
+        ("n,iterations", "Number of measured executions of each file", cxxopts::value<unsigned>()->default_value("10"), "")
+        ("warmup", "Number of executions of each file before those which are measured", cxxopts::value<unsigned>()->default_value("1"), "")
+        ("O,opt-level", "Optimization level, 0-3", cxxopts::value<unsigned>()->default_value("2"), "")
+        ("json", "Write the results to the specified file as JSON", cxxopts::value<std::string>(), "")
+        ("baseline", "Compare the results to the specified JSON file and fail on regressions", cxxopts::value<std::string>(), "")
+        ("threshold", "Percentage by which a median may exceed the baseline's", cxxopts::value<double>()->default_value("10"), "")
+        ("noise-ms", "Differences smaller than this are never regressions", cxxopts::value<double>()->default_value("0.5"), "")
+        ("native-dir", "Compare with the reference implementations in the specified directory", cxxopts::value<std::string>(), "")
+        ("files", "Benchmark programs", cxxopts::value<std::vector<std::string>>(), "");
+    options.parse_positional("files");
+    options.positional_help("files...");
+
+    try {
+        options.parse(argc, argv);
+    } catch(cxxopts::OptionException &exception) {
+        std::cerr << exception.what() << "\n";
+        return 2;
+    }
+    unsigned iterations = options["iterations"].as<unsigned>();
+    if(options["help"].as<bool>() || !options.count("files") || iterations == 0) {
+        std::cout << options.help(options.groups()) << "\n";
+        return options["help"].as<bool>() ? 0 : 2;
+    }
+    unsigned optimizationLevel = options["opt-level"].as<unsigned>();
+
+    //Needed for the back end and the JIT to time their phases.
+    stats::global().setEnabled(true);
+    stats::global().setHardwareCountersEnabled(true);
+    if(!stats::HardwareCounters::forThisThread().available()) {
+        std::cerr << "Hardware counters are unavailable, see /proc/sys/kernel/perf_event_paranoid.\n";
+    }
+
+    std::vector<BenchmarkResult> results;
+    try {
+        for(const std::string &filename : options["files"].as<std::vector<std::string>>()) {
+            results.push_back(runBenchmark(
+                filename, options["warmup"].as<unsigned>(), iterations, optimizationLevel, options["native-dir"].as<std::string>()));
+        }
+    } catch(std::exception &exception) {
+        std::cerr << exception.what() << "\n";
+        return 2;
+    }
+    writeReport(results, std::cout);
+
+    std::string jsonFilename = options["json"].as<std::string>();
+    if(!jsonFilename.empty()) {
+        std::ofstream jsonFile{jsonFilename};
+        if(!jsonFile) {
+            std::cerr << "Couldn't open " << jsonFilename << "\n";
+            return 2;
+        }
+        writeJson(results, optimizationLevel, iterations, jsonFile);
+    }
+
+    std::string baselineFilename = options["baseline"].as<std::string>();
+    if(baselineFilename.empty()) {
+        return 0;
+    }
+    std::ifstream baselineFile{baselineFilename};
+    if(!baselineFile) {
+        std::cerr << "Couldn't open " << baselineFilename << "\n";
+        return 2;
+    }
+    unsigned regressions;
+    try {
+        JsonValue baseline = JsonReader{baselineFile}.read();
+        regressions = compareWithBaseline(
+            results, baseline, options["threshold"].as<double>(), options["noise-ms"].as<double>(), std::cout);
+    } catch(std::exception &exception) {
+        std::cerr << exception.what() << "\n";
+        return 2;
+    }
+    std::cout << regressions << " regression(s) compared to " << baselineFilename << "\n";
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,341 @@
+/**
+ * Reports how the time and memory needed to compile synthetic Anode sources scales with their shape, so that
+ * super-linear behavior (i.e. in symbol lookup, template expansion or the declaration of functions) is noticed before
+ * programs large enough to suffer from it are written.
+ *
+ * Usage:  frontend_scaling [options]
+ *
+ * A source is generated for each of a number of sizes of a single dimension, the others being zero:
+ *
+ *  - functions:  functions, each of which calls the previous one,
+ *  - nesting:  compound expressions nested within each other, each of which declares a variable,
+ *  - genericClasses:  generic classes, each of which is instantiated with two type arguments,
+ *  - templates:  expansions of a template which contains a nested template that it also expands,
+ *  - expressionLength:  terms of a single chain of additions and
+ *  - namespaces:  namespaces, each of which contains a variable and a function.
+ *
+ * Each size is double the previous one.  Each source is parsed, analyzed and compiled (but not optimized) the specified
+ * number of times and the fastest time of each phase is reported along with the bytes allocated from the GC heap and
+ * the number of AST nodes created.  The growth column is the exponent k in time ~ size^k between consecutive sizes, so 1
+ * is linear and 2 quadratic.
+ *
+ * With --emit the source for the specified shape is written to stdout instead, i.e.
+ * `frontend_scaling --emit --functions 100 --namespaces 10`.
+ */
+
+#include "execute/execute.h"
+#include "front/parse.h"
+#include "common/stats.h"
+#include "common/string.h"
+#include "../anode/cxxopts.h"
+
+#include <gc/gc.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace anode;
+using namespace anode::front;
+
+namespace {
+
+enum Dimension : size_t {
+    Functions,
+    Nesting,
+    GenericClasses,
+    Templates,
+    ExpressionLength,
+    Namespaces,
+    DimensionCount
+};
+
+const char *DimensionNames[DimensionCount] = {
+    "functions", "nesting", "genericClasses", "templates", "expressionLength", "namespaces"
+};
+
+/** The size of each dimension at the smallest step, chosen so that each takes roughly the same time. */
+const unsigned BaseSizes[DimensionCount] = { 200, 25, 25, 25, 200, 200 };
+
+typedef std::array<unsigned, DimensionCount> Shape;
+
+/**
+ * Every global symbol is prefixed with prefix because all modules are compiled by the same JIT, which should not see the
+ * same symbol defined twice.
+ */
+std::string generateSource(const Shape &shape, const std::string &prefix) {
+    std::ostringstream source;
+    const std::string &p = prefix;
+
+    for(unsigned i = 0; i < shape[Functions]; ++i) {
+        if(i == 0) {
+            source << "func " << p << "f0:int(a:int) a\n";
+        } else {
+            source << "func " << p << "f" << i << ":int(a:int) " << p << "f" << i - 1 << "(a) + 1\n";
+        }
+    }
+    if(shape[Functions] > 0) {
+        unsigned last = shape[Functions] - 1;
+        source << "assert(" << p << "f" << last << "(0) == " << last << ")\n";
+    }
+
+    for(unsigned i = 0; i < shape[Nesting]; ++i) {
+        std::string indent(i * 4, ' ');
+        source << indent << "{\n" << indent << "    " << p << "v" << i << ":int = ";
+        if(i == 0) {
+            source << "0\n";
+        } else {
+            source << p << "v" << i - 1 << " + 1\n";
+        }
+    }
+    if(shape[Nesting] > 0) {
+        unsigned last = shape[Nesting] - 1;
+        //Refers to the outermost variable too so that the deepest lookup is exercised.
+        source << std::string(shape[Nesting] * 4, ' ')
+               << "assert(" << p << "v" << last << " == " << last << " && " << p << "v0 == 0)\n";
+    }
+    for(unsigned i = shape[Nesting]; i > 0; --i) {
+        source << std::string((i - 1) * 4, ' ') << "}\n";
+    }
+
+    for(unsigned i = 0; i < shape[GenericClasses]; ++i) {
+        std::string className = p + "Box" + std::to_string(i);
+        std::string intVariable = p + "box" + std::to_string(i);
+        std::string floatVariable = p + "floatBox" + std::to_string(i);
+        source << "class " << className << "<T> {\n"
+               << "    value:T\n"
+               << "    next:" << className << "<T>\n"
+               << "}\n"
+               << intVariable << ":" << className << "<int> = new " << className << "<int>()\n"
+               << intVariable << ".value = " << i << "\n"
+               << intVariable << ".next = new " << className << "<int>()\n"
+               << "assert(" << intVariable << ".value == " << i << ")\n"
+               << floatVariable << ":" << className << "<float> = new " << className << "<float>()\n";
+    }
+
+    if(shape[Templates] > 0) {
+        source << "template " << p << "Outer<TOuter> {\n"
+               << "    template Inner<TInner> {\n"
+               << "        func identity:TOuter(n:TInner) n\n"
+               << "    }\n"
+               << "    expand Inner<TOuter>\n"
+               << "}\n";
+    }
+    for(unsigned i = 0; i < shape[Templates]; ++i) {
+        source << "namespace " << p << "t" << i << " expand " << p << "Outer<int>\n"
+               << "assert(" << p << "t" << i << "::identity(" << i << ") == " << i << ")\n";
+    }
+
+    if(shape[ExpressionLength] > 0) {
+        source << p << "chain:int = 0";
+        for(unsigned i = 0; i < shape[ExpressionLength]; ++i) {
+            source << " + 1";
+        }
+        source << "\nassert(" << p << "chain == " << shape[ExpressionLength] << ")\n";
+    }
+
+    for(unsigned i = 0; i < shape[Namespaces]; ++i) {
+        source << "namespace " << p << "n" << i << "::inner {\n"
+               << "    value:int = " << i << "\n"
+               << "    func get:int() value\n"
+               << "}\n"
+               << "assert(" << p << "n" << i << "::inner::get() == " << i << ")\n";
+    }
+    return source.str();
+}
+
+struct Measurement {
+    double parseMs = 0;
+    double analysisMs = 0;
+    double codegenMs = 0;
+    double totalMs = 0;
+    size_t allocatedBytes = 0;
+    unsigned long astNodes = 0;
+};
+
+double toMilliseconds(stats::clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/** The time spent emitting IR and generating machine code, which is timed by the back end and the JIT. */
+double codegenMilliseconds() {
+    double total = 0;
+    for(const stats::PhaseTiming &timing : stats::global().phases()) {
+        if(timing.name == "back.emitModule" || timing.name == "back.codegen" || timing.name.compare(0, 9, "back.opt.") == 0) {
+            total += toMilliseconds(timing.elapsed);
+        }
+    }
+    return total;
+}
+
+Measurement compile(const std::string &source, const std::string &moduleName) {
+    GC_gcollect();
+    stats::global().reset();
+    std::unique_ptr<execute::ExecutionContext> executionContext = execute::createExecutionContext();
+
+    Measurement measurement;
+    size_t allocatedBefore = GC_get_total_bytes();
+    unsigned long nodesBefore = ast::astNodesCreatedCount;
+    auto start = stats::clock::now();
+
+    std::istringstream input{source};
+    ast::Module &module = parseModule(input, moduleName);
+    auto parsed = stats::clock::now();
+    if(executionContext->prepareModule(&module)) {
+        throw std::runtime_error("The generated source " + moduleName + " failed semantic analysis.");
+    }
+    auto prepared = stats::clock::now();
+    //This also runs the module's initialization function, but that executes the assertions only.
+    executionContext->executeModule(&module);
+
+    measurement.parseMs = toMilliseconds(parsed - start);
+    measurement.analysisMs = toMilliseconds(prepared - parsed);
+    measurement.codegenMs = codegenMilliseconds();
+    measurement.totalMs = measurement.parseMs + measurement.analysisMs + measurement.codegenMs;
+    measurement.allocatedBytes = GC_get_total_bytes() - allocatedBefore;
+    measurement.astNodes = ast::astNodesCreatedCount - nodesBefore;
+    return measurement;
+}
+
+/** The fastest of each phase (which may not all be from the same iteration) and the least memory. */
+Measurement best(const Measurement &a, const Measurement &b) {
+    Measurement measurement;
+    measurement.parseMs = std::min(a.parseMs, b.parseMs);
+    measurement.analysisMs = std::min(a.analysisMs, b.analysisMs);
+    measurement.codegenMs = std::min(a.codegenMs, b.codegenMs);
+    measurement.totalMs = std::min(a.totalMs, b.totalMs);
+    measurement.allocatedBytes = std::min(a.allocatedBytes, b.allocatedBytes);
+    measurement.astNodes = std::min(a.astNodes, b.astNodes);
+    return measurement;
+}
+
+/** The exponent k such that after = before * (afterSize / beforeSize) ^ k. */
+double growth(double before, double after, unsigned beforeSize, unsigned afterSize) {
+    if(before <= 0 || after <= 0) return 0;
+    return std::log(after / before) / std::log((double)afterSize / beforeSize);
+}
+
+void measureDimension(Dimension dimension, unsigned scale, unsigned steps, unsigned iterations, double superLinearGrowth) {
+    std::cout << DimensionNames[dimension] << "\n"
+              << std::right << std::setw(10) << "Size" << std::setw(12) << "Parse (ms)" << std::setw(15) << "Analysis (ms)"
+              << std::setw(14) << "Codegen (ms)" << std::setw(12) << "Total (ms)" << std::setw(8) << "Growth"
+              << std::setw(12) << "Alloc (KB)" << std::setw(8) << "Growth" << std::setw(12) << "AST nodes" << "\n";
+
+    static unsigned runCount = 0;
+    Measurement previous;
+    unsigned previousSize = 0;
+    for(unsigned step = 0; step < steps; ++step) {
+        unsigned size = BaseSizes[dimension] * scale << step;
+        Shape shape{};
+        shape[dimension] = size;
+
+        Measurement measurement;
+        for(unsigned i = 0; i < iterations; ++i) {
+            std::string prefix = string::format("s%u_", runCount++);
+            Measurement current = compile(generateSource(shape, prefix), prefix + DimensionNames[dimension]);
+            measurement = i == 0 ? current : best(measurement, current);
+        }
+
+        std::cout << std::setw(10) << size << std::fixed << std::setprecision(3)
+                  << std::setw(12) << measurement.parseMs << std::setw(15) << measurement.analysisMs
+                  << std::setw(14) << measurement.codegenMs << std::setw(12) << measurement.totalMs;
+        if(step == 0) {
+            std::cout << std::setw(8) << "";
+        } else {
+            std::cout << std::setw(8) << std::setprecision(2) << growth(previous.totalMs, measurement.totalMs, previousSize, size);
+        }
+        std::cout << std::setw(12) << std::setprecision(0) << measurement.allocatedBytes / 1024.0;
+        if(step == 0) {
+            std::cout << std::setw(8) << "";
+        } else {
+            std::cout << std::setw(8) << std::setprecision(2)
+                      << growth(previous.allocatedBytes, measurement.allocatedBytes, previousSize, size);
+        }
+        std::cout << std::setw(12) << measurement.astNodes;
+        if(step > 0 && growth(previous.totalMs, measurement.totalMs, previousSize, size) > superLinearGrowth) {
+            std::cout << "  <- super-linear";
+        }
+        std::cout << "\n";
+
+        previous = measurement;
+        previousSize = size;
+    }
+}
+
+}
+
+int main(int argc, char **argv) {
+    GC_INIT();
+
+    cxxopts::Options options("frontend_scaling", "Reports how compilation scales with the shape of the source.");
+    options.add_options("")
+        ("h,help", "Display this text and exit", cxxopts::value<bool>(), "")
+        ("d,dimension", "Measure only the specified dimension", cxxopts::value<std::string>(), "")
+        ("scale", "Multiplies the size of each dimension at the first step", cxxopts::value<unsigned>()->default_value("1"), "")
+        ("steps", "Number of sizes of each dimension, each double the previous", cxxopts::value<unsigned>()->default_value("5"), "")
+        ("n,iterations", "Number of times each source is compiled", cxxopts::value<unsigned>()->default_value("3"), "")
+        ("super-linear", "Growth above which a step is flagged", cxxopts::value<double>()->default_value("1.5"), "");
+    options.add_options("emit")
+        ("emit", "Write the source of the specified shape to stdout instead", cxxopts::value<bool>(), "")
+        ("functions", "Number of functions", cxxopts::value<unsigned>()->default_value("0"), "")
+        ("nesting", "Depth of nested compound expressions", cxxopts::value<unsigned>()->default_value("0"), "")
+        ("generic-classes", "Number of generic classes", cxxopts::value<unsigned>()->default_value("0"), "")
+        ("templates", "Number of template expansions", cxxopts::value<unsigned>()->default_value("0"), "")
+        ("expression-length", "Number of terms of the chain of additions", cxxopts::value<unsigned>()->default_value("0"), "")
+        ("namespaces", "Number of namespaces", cxxopts::value<unsigned>()->default_value("0"), "");
+
+    try {
+        options.parse(argc, argv);
+    } catch(cxxopts::OptionException &exception) {
+        std::cerr << exception.what() << "\n";
+        return 2;
+    }
+    if(options["help"].as<bool>()) {
+        std::cout << options.help(options.groups()) << "\n";
+        return 0;
+    }
+
+    if(options["emit"].as<bool>()) {
+        Shape shape{};
+        shape[Functions] = options["functions"].as<unsigned>();
+        shape[Nesting] = options["nesting"].as<unsigned>();
+        shape[GenericClasses] = options["generic-classes"].as<unsigned>();
+        shape[Templates] = options["templates"].as<unsigned>();
+        shape[ExpressionLength] = options["expression-length"].as<unsigned>();
+        shape[Namespaces] = options["namespaces"].as<unsigned>();
+        std::cout << generateSource(shape, "");
+        return 0;
+    }
+
+    std::string onlyDimension = options["dimension"].as<std::string>();
+    unsigned scale = options["scale"].as<unsigned>();
+    unsigned steps = options["steps"].as<unsigned>();
+    unsigned iterations = options["iterations"].as<unsigned>();
+    if(scale == 0 || steps == 0 || iterations == 0) {
+        std::cerr << "--scale, --steps and --iterations must be greater than 0.\n";
+        return 2;
+    }
+
+    //Needed for the back end and the JIT to time their phases.
+    stats::global().setEnabled(true);
+
+    bool found = false;
+    try {
+        for(size_t dimension = 0; dimension < DimensionCount; ++dimension) {
+            if(!onlyDimension.empty() && onlyDimension != DimensionNames[dimension]) continue;
+            found = true;
+            measureDimension((Dimension)dimension, scale, steps, iterations, options["super-linear"].as<double>());
+        }
+    } catch(std::exception &exception) {
+        std::cerr << exception.what() << "\n";
+        return 1;
+    }
+    if(!found) {
+        std::cerr << "Unknown dimension '" << onlyDimension << "'.\n";
+        return 2;
+    }
+    return 0;
+}
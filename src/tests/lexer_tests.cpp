@@ -30,8 +30,9 @@ gc_vector<Token*> extractAllTokens(const std::string &fromStr) {
 }
 
 TEST_CASE("simple tokens") {
-    auto tokens = extractAllTokens("; ! + - * / = == != > < >= <= ++ -- . : :: ( ) { }"
-                                   "true false while if func cast class assert new alias template expand namespace");
+    auto tokens = extractAllTokens("; ! + - * / = == != > < >= <= ++ -- . .. : :: ( ) { } [ ]"
+                                   "true false while if func cast class assert new alias template expand namespace import spawn join "
+                                   "for in parallel reduce vectorize unroll fpmode");
     int i = 0;
     REQUIRE(tokens[i++]->kind() == TokenKind::END_OF_STATEMENT);
     REQUIRE(tokens[i++]->kind() == TokenKind::OP_NOT);
@@ -49,12 +50,15 @@ TEST_CASE("simple tokens") {
     REQUIRE(tokens[i++]->kind() == TokenKind::OP_INC);
     REQUIRE(tokens[i++]->kind() == TokenKind::OP_DEC);
     REQUIRE(tokens[i++]->kind() == TokenKind::OP_DOT);
+    REQUIRE(tokens[i++]->kind() == TokenKind::OP_RANGE);
     REQUIRE(tokens[i++]->kind() == TokenKind::OP_DEF);
     REQUIRE(tokens[i++]->kind() == TokenKind::OP_NAMESPACE);
     REQUIRE(tokens[i++]->kind() == TokenKind::OPEN_PAREN);
     REQUIRE(tokens[i++]->kind() == TokenKind::CLOSE_PAREN);
     REQUIRE(tokens[i++]->kind() == TokenKind::OPEN_CURLY);
     REQUIRE(tokens[i++]->kind() == TokenKind::CLOSE_CURLY);
+    REQUIRE(tokens[i++]->kind() == TokenKind::OPEN_SQUARE);
+    REQUIRE(tokens[i++]->kind() == TokenKind::CLOSE_SQUARE);
 
     REQUIRE(tokens[i++]->kind() == TokenKind::KW_TRUE);
     REQUIRE(tokens[i++]->kind() == TokenKind::KW_FALSE);
@@ -69,6 +73,16 @@ TEST_CASE("simple tokens") {
     REQUIRE(tokens[i++]->kind() == TokenKind::KW_TEMPLATE);
     REQUIRE(tokens[i++]->kind() == TokenKind::KW_EXPAND);
     REQUIRE(tokens[i++]->kind() == TokenKind::KW_NAMESPACE);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_IMPORT);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_SPAWN);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_JOIN);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_FOR);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_IN);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_PARALLEL);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_REDUCE);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_VECTORIZE);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_UNROLL);
+    REQUIRE(tokens[i++]->kind() == TokenKind::KW_FPMODE);
     REQUIRE(tokens[i++]->kind() == TokenKind::END_OF_INPUT);
 
     REQUIRE(i == tokens.size());
@@ -114,6 +128,15 @@ TEST_CASE("identifiers") {
     REQUIRE(i == tokens.size());
 }
 
+TEST_CASE("identifiers are interned") {
+    auto tokens = extractAllTokens("abc def abc");
+
+    REQUIRE(tokens[0]->atom() == tokens[2]->atom());
+    REQUIRE(tokens[0]->atom() != tokens[1]->atom());
+    REQUIRE(tokens[0]->atom() == Atom("abc"));
+    REQUIRE(tokens[0]->atom().hash() == std::hash<std::string>()("abc"));
+}
+
 
 TEST_CASE("literal integers") {
     std::string helper;
@@ -182,6 +205,34 @@ TEST_CASE("literal float") {
     REQUIRE(i == tokens.size());
 }
 
+TEST_CASE("range between literal integers") {
+    auto tokens = extractAllTokens("0..10 1.5..2");
+
+    int i = 0;
+    Token *token = tokens[i++];
+    REQUIRE(token->kind() == TokenKind::LIT_INT);
+    REQUIRE(token->intValue() == 0);
+
+    REQUIRE(tokens[i++]->kind() == TokenKind::OP_RANGE);
+
+    token = tokens[i++];
+    REQUIRE(token->kind() == TokenKind::LIT_INT);
+    REQUIRE(token->intValue() == 10);
+
+    token = tokens[i++];
+    REQUIRE(token->kind() == TokenKind::LIT_FLOAT);
+    REQUIRE(token->floatValue() == 1.5);
+
+    REQUIRE(tokens[i++]->kind() == TokenKind::OP_RANGE);
+
+    token = tokens[i++];
+    REQUIRE(token->kind() == TokenKind::LIT_INT);
+    REQUIRE(token->intValue() == 2);
+
+    REQUIRE(tokens[i++]->kind() == TokenKind::END_OF_INPUT);
+    REQUIRE(i == tokens.size());
+}
+
 TEST_CASE("single line comment") {
     auto tokens = extractAllTokens("1\n # 10 single 20 line 30 comment \n2");
 
@@ -0,0 +1,174 @@
+/**
+ * Measures the throughput of the lexer and parser in tokens and AST nodes per second.
+ *
+ * Usage:  parser_benchmark [repetitions] [iterations]
+ *
+ * The source which is parsed consists of a representative chunk of code (classes, functions, templates, loops and a
+ * variety of expressions) repeated the specified number of times.  It is parsed the specified number of times and the
+ * fastest iteration is reported, so as to exclude the effects of warming up and collections.
+ */
+
+#include "../front/parser/AnodeParser.h"
+#include "common/stats.h"
+
+#include <gc/gc.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace anode;
+using namespace anode::front;
+using namespace anode::front::parser;
+
+namespace {
+
+const char *ChunkTemplate = R"(
+class Point$ {
+    x:int
+    y:int
+    func lengthSquared:int() x * x + y * y
+}
+
+template TPair$<TFirst, TSecond> {
+    class Pair$ {
+        first:TFirst
+        second:TSecond
+    }
+}
+
+func fibonacci$:int(n:int) {
+    a:int = 0
+    b:int = 1
+    i:int = 0
+    while(i < n) {
+        temp:int = a + b
+        a = b
+        b = temp
+        i = i + 1
+    }
+    a
+}
+
+func classify$:int(value:float, threshold:float) {
+    if(value > threshold && !(value == 0.0)) 1 else if(value < 0.0 - threshold || value == threshold) 2 else 3
+}
+
+p$:Point$ = new Point$()
+p$.x = fibonacci$(10) * 3 + (7 - 2) / 5
+p$.y = cast<int>(1.5 * 2.0)
+assert(p$.lengthSquared() >= 0)
+)";
+
+std::string generateSource(unsigned repetitions) {
+    std::string source;
+    for(unsigned i = 0; i < repetitions; ++i) {
+        std::string chunk = ChunkTemplate;
+        std::string suffix = std::to_string(i);
+        size_t position;
+        while((position = chunk.find('$')) != std::string::npos) {
+            chunk.replace(position, 1, suffix);
+        }
+        source += chunk;
+    }
+    return source;
+}
+
+struct Measurement {
+    stats::clock::duration elapsed = stats::clock::duration::max();
+    stats::clock::duration lexTime = stats::clock::duration::zero();
+    unsigned long tokens = 0;
+    unsigned long nodes = 0;
+};
+
+Measurement lexOnly(const std::string &source) {
+    std::istringstream input{source};
+    SourceReader reader{"benchmark", input};
+    error::ErrorStream errorStream{std::cerr};
+    AnodeLexer lexer{reader, errorStream};
+
+    Measurement measurement;
+    auto start = stats::clock::now();
+    while(lexer.nextToken().kind() != TokenKind::END_OF_INPUT) { }
+    measurement.elapsed = stats::clock::now() - start;
+    measurement.lexTime = measurement.elapsed;
+    measurement.tokens = lexer.tokenCount();
+    return measurement;
+}
+
+Measurement lexAndParse(const std::string &source) {
+    std::istringstream input{source};
+    SourceReader reader{"benchmark", input};
+    error::ErrorStream errorStream{std::cerr};
+    AnodeLexer lexer{reader, errorStream};
+    AnodeParser parser{lexer, errorStream};
+
+    Measurement measurement;
+    unsigned long nodesBefore = ast::astNodesCreatedCount;
+    auto start = stats::clock::now();
+    parser.parseModule();
+    measurement.elapsed = stats::clock::now() - start;
+    measurement.lexTime = lexer.lexTime();
+    measurement.tokens = lexer.tokenCount();
+    measurement.nodes = ast::astNodesCreatedCount - nodesBefore;
+
+    if(errorStream.errorCount() > 0) {
+        std::cerr << "The benchmark source failed to parse.\n";
+        std::exit(1);
+    }
+    return measurement;
+}
+
+double perSecond(unsigned long count, stats::clock::duration elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? count / seconds : 0;
+}
+
+void report(const char *phase, unsigned long tokens, unsigned long nodes, stats::clock::duration elapsed) {
+    std::cout << std::left << std::setw(16) << phase
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << std::chrono::duration<double, std::milli>(elapsed).count() << " ms"
+              << std::setprecision(0)
+              << std::setw(16) << perSecond(tokens, elapsed) << " tokens/s";
+    if(nodes > 0) {
+        std::cout << std::setw(16) << perSecond(nodes, elapsed) << " nodes/s";
+    }
+    std::cout << "\n";
+}
+
+}
+
+int main(int argc, char **argv) {
+    GC_INIT();
+    //Needed for the time spent lexing to be measured separately from the time spent parsing.
+    stats::global().setEnabled(true);
+
+    unsigned repetitions = argc > 1 ? (unsigned)std::atoi(argv[1]) : 1000;
+    unsigned iterations = argc > 2 ? (unsigned)std::atoi(argv[2]) : 5;
+    if(repetitions == 0 || iterations == 0) {
+        std::cerr << "Usage: parser_benchmark [repetitions] [iterations]\n";
+        return 1;
+    }
+
+    std::string source = generateSource(repetitions);
+
+    Measurement bestLex;
+    Measurement bestParse;
+    for(unsigned i = 0; i < iterations; ++i) {
+        Measurement lex = lexOnly(source);
+        if(lex.elapsed < bestLex.elapsed) bestLex = lex;
+
+        Measurement parse = lexAndParse(source);
+        if(parse.elapsed < bestParse.elapsed) bestParse = parse;
+    }
+
+    std::cout << source.size() << " bytes, " << bestParse.tokens << " tokens, " << bestParse.nodes << " AST nodes, best of "
+              << iterations << " iteration(s)\n";
+    report("lex", bestLex.tokens, 0, bestLex.elapsed);
+    //The lexer is driven by the parser, so the time spent lexing can be excluded to measure the parser alone.
+    report("parse", bestParse.tokens, bestParse.nodes, bestParse.elapsed - bestParse.lexTime);
+    report("lex + parse", bestParse.tokens, bestParse.nodes, bestParse.elapsed);
+    return 0;
+}
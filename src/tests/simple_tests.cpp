@@ -1,6 +1,9 @@
 #include "front/ErrorStream.h"
 #include "execute/execute.h"
 #include "back/compile.h"
+#include "front/module_interface.h"
+#include "front/parse.h"
+#include "common/content_hash.h"
 #include "test_util.h"
 
 //#define CATCH_CONFIG_FAST_COMPILE
@@ -8,6 +11,9 @@
 #include "catch.hpp"
 
 #include <common/stacktrace.h>
+#include <common/stats.h>
+
+#include <set>
 
 using namespace anode;
 using namespace anode::front;
@@ -878,6 +884,58 @@ TEST_CASE("assert") {
     REQUIRE_NOTHROW(exec("assert(1.0)"));
 }
 
+TEST_CASE("spawn and join") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    auto src = R"(
+            func square:int(n:int) n * n
+            t:task<int> = spawn square(12)
+            join(t)
+        )";
+    REQUIRE(test<int>(ec, src) == 144);
+
+    //A failed assertion within a task is rethrown by the thread which joins it.
+    exec(ec, "func fails:void() assert(false)");
+    REQUIRE_THROWS_AS(exec(ec, "f:task<void> = spawn fails() join(f)"), exception::AnodeAssertionFailedException);
+    REQUIRE_NOTHROW(exec(ec, "spawn fails()"));
+}
+
+TEST_CASE("parallel for") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    REQUIRE(test<int>(ec, "parallel for(i in 0..100000) reduce(+) 1") == 100000);
+
+    //A failed assertion within any iteration is rethrown once every chunk is complete.
+    REQUIRE_THROWS_AS(exec(ec, "parallel for(i in 0..100000) assert(i < 50000)"), exception::AnodeAssertionFailedException);
+}
+
+TEST_CASE("arrays are bounds checked") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    exec(ec, "a:int[] = new int[10]");
+    REQUIRE(test<int>(ec, "a[9] = 9") == 9);
+    REQUIRE(test<int>(ec, "a[9]") == 9);
+    REQUIRE_THROWS_AS(exec(ec, "a[10]"), exception::AnodeIndexOutOfBoundsException);
+    REQUIRE_THROWS_AS(exec(ec, "a[-1] = 1"), exception::AnodeIndexOutOfBoundsException);
+    REQUIRE_THROWS_AS(exec(ec, "new int[-1]"), exception::AnodeNegativeArrayLengthException);
+}
+
+TEST_CASE("vectors loaded from and stored to arrays are bounds checked") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    exec(ec, "a:float[] = new float[6]");
+    REQUIRE(test<float>(ec, "float4(a, 2)[3]") == 0.0f);
+    REQUIRE_THROWS_AS(exec(ec, "float4(a, 3)"), exception::AnodeIndexOutOfBoundsException);
+    REQUIRE_THROWS_AS(exec(ec, "float4(a, -1)"), exception::AnodeIndexOutOfBoundsException);
+    REQUIRE_THROWS_AS(exec(ec, "store(a, 4, float4(1.0))"), exception::AnodeIndexOutOfBoundsException);
+    REQUIRE_THROWS_AS(exec(ec, "i:int = 4 float4(1.0)[i]"), exception::AnodeIndexOutOfBoundsException);
+}
+
+TEST_CASE("floating point reductions may be reassociated in fast mode") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    ec->setFloatingPointMode(ast::FloatingPointMode::Fast);
+    exec(ec, "func sum:float(n:int) for(i in 0..n) reduce(+) vectorize cast<float>(i)");
+    //Every partial sum is an integer small enough to be exact, so the order of the additions doesn't matter.
+    REQUIRE(test<float>(ec, "sum(100)") == 4950.0f);
+    REQUIRE(test<float>(ec, "func scale:float(x:float) fpmode(precise) x * 0.5 scale(3.0)") == 1.5f);
+}
+
 TEST_CASE("dynamically allocated class") {
     std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
     exec(ec, "class C { f:int } c:C = new C()");
@@ -885,3 +943,189 @@ TEST_CASE("dynamically allocated class") {
     REQUIRE(test<int>(ec, "c.f") == 1024);
 }
 
+
+TEST_CASE("statistics are collected only when enabled") {
+    stats::Statistics &statistics = stats::global();
+    statistics.reset();
+    exec("1 + 2");
+    REQUIRE(statistics.phases().empty());
+
+    statistics.setEnabled(true);
+    exec("func add:int(a:int, b:int) a + b add(1, 2)");
+    statistics.setEnabled(false);
+
+    auto hasPhase = [&](const std::string &name) {
+        for(const stats::PhaseTiming &timing : statistics.phases()) {
+            if(timing.name == name) return timing.count > 0;
+        }
+        return false;
+    };
+    REQUIRE(hasPhase("front.lex"));
+    REQUIRE(hasPhase("front.parse"));
+    REQUIRE(hasPhase("front.pass.ResolveSymbols"));
+    REQUIRE(hasPhase("back.emitModule"));
+    REQUIRE(hasPhase("back.verifyModule"));
+    REQUIRE(hasPhase("back.codegen"));
+
+    std::vector<stats::ModuleStatistics> modules = statistics.modules();
+    REQUIRE(modules.size() == 1);
+    auto moduleStatistic = [&](const std::string &name) {
+        for(const auto &value : modules.front().values) {
+            if(value.first == name) return value.second;
+        }
+        return 0ul;
+    };
+    REQUIRE(moduleStatistic("tokens") > 0);
+    REQUIRE(moduleStatistic("astNodesParsed") > 0);
+    REQUIRE(moduleStatistic("irInstructionsEmitted") > 0);
+    REQUIRE(moduleStatistic("machineCodeBytes") > 0);
+    statistics.reset();
+}
+
+TEST_CASE("instrumented modules count function calls and branches") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    execute::setInstrumentationEnabled(true);
+    exec(ec, "func countAboveTwo:int(n:int) { total:int = 0 for(i in 0..n) if(i > 2) total = total + 1 total }");
+    REQUIRE(test<int>(ec, "countAboveTwo(10) + countAboveTwo(0)") == 7);
+    execute::setInstrumentationEnabled(false);
+
+    std::stringstream profile;
+    REQUIRE(execute::writeInstrumentationProfile(profile) > 0);
+    //The names of the counters begin with the fully qualified name of the function.
+    auto count = [&](const std::string &suffix) {
+        profile.clear();
+        profile.seekg(0);
+        unsigned long value;
+        std::string name;
+        while(profile >> value && std::getline(profile, name)) {
+            if(name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                return value;
+            }
+        }
+        return 0ul;
+    };
+    REQUIRE(count("countAboveTwo;entry") == 2);
+    REQUIRE(count("countAboveTwo;forGuard.0.true") == 1);
+    REQUIRE(count("countAboveTwo;forGuard.0.false") == 1);
+    REQUIRE(count("countAboveTwo;forLatch.0.true") == 9);
+    REQUIRE(count("countAboveTwo;if.0.true") == 7);
+    REQUIRE(count("countAboveTwo;if.0.false") == 3);
+
+    //The functions emitted for parallel for expressions have the same name in every module.
+    std::stringstream twoModules;
+    execute::setInstrumentationEnabled(true);
+    exec(ec, "parallel for(i in 0..10) reduce(+) (? i > 2; 1; 0)");
+    exec(ec, "parallel for(i in 0..10) reduce(+) (? i > 2; 1; 0)");
+    execute::setInstrumentationEnabled(false);
+    execute::writeInstrumentationProfile(twoModules);
+    std::set<std::string> names;
+    std::string line;
+    while(std::getline(twoModules, line)) {
+        REQUIRE(names.insert(line.substr(line.find(' ') + 1)).second);
+    }
+
+    //The count precedes the name, which may contain spaces.
+    std::istringstream malformed{"countAboveTwo;entry 2\n"};
+    REQUIRE_THROWS_AS(execute::useInstrumentationProfile(malformed), execute::ExecutionException);
+    std::istringstream repeated{"1 module;countAboveTwo;entry\n2 module;countAboveTwo;entry\n"};
+    REQUIRE_THROWS_AS(execute::useInstrumentationProfile(repeated), execute::ExecutionException);
+}
+
+TEST_CASE("module interface round trip") {
+    std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+    std::string src = R"(
+        class Point {
+            x:int
+            y:int
+            func sum:int() x + y
+        }
+        origin:Point = new Point()
+        func distance:int(p:Point) p.sum()
+        template TAdd<T> func add:T(a:T, b:T) a + b
+    )";
+    ast::Module &module = parseModule(src, "geometry.an");
+    REQUIRE(!ec->prepareModule(&module));
+
+    interface::CompiledModule compiled;
+    compiled.sourceText = src;
+    compiled.sourceHash = contentHash(src);
+    compiled.code = "code";
+    compiled.objectTriple = "triple";
+    compiled.object = "object";
+    std::ostringstream out;
+    uint64_t interfaceHash = interface::writeModuleInterface(module, compiled, out);
+    std::string data = out.str();
+
+    interface::ModuleInterfaceReader reader{data.data(), data.size()};
+    REQUIRE(reader.moduleName() == "geometry.an");
+    REQUIRE(reader.sourceHash() == contentHash(src));
+    REQUIRE(reader.interfaceHash() == interfaceHash);
+    REQUIRE(reader.imports().empty());
+    REQUIRE(reader.templateSources().size() == 1);
+    REQUIRE(std::string(reader.code(), reader.codeSize()) == "code");
+    REQUIRE(reader.objectTriple() == "triple");
+    REQUIRE(std::string(reader.object(), reader.objectSize()) == "object");
+
+    ast::AnodeWorld world;
+    reader.importSymbols(world);
+    scope::SymbolTable &globals = world.globalScope();
+
+    scope::Symbol *pointSymbol = globals.findSymbolInCurrentScope(Atom("Point"));
+    REQUIRE(pointSymbol);
+    type::ClassType *pointType = tryUpcast<type::ClassType>(&pointSymbol->type());
+    REQUIRE(pointType);
+    REQUIRE(pointType->fields().size() == 2);
+    REQUIRE(pointType->findMethod(Atom("sum")));
+
+    scope::Symbol *originSymbol = globals.findSymbolInCurrentScope(Atom("origin"));
+    REQUIRE(originSymbol);
+    REQUIRE(originSymbol->isExternal());
+    REQUIRE(&originSymbol->type() == pointType);
+
+    scope::Symbol *distanceSymbol = globals.findSymbolInCurrentScope(Atom("distance"));
+    REQUIRE(distanceSymbol);
+    REQUIRE(distanceSymbol->isExternal());
+
+    REQUIRE_THROWS_AS(interface::ModuleInterfaceReader(data.data(), 3), interface::InterfaceException);
+
+    //A symbol which is already defined prevents every symbol from being imported, not only those read after it.
+    ast::AnodeWorld conflicting;
+    conflicting.globalScope().addSymbol(*new scope::VariableSymbol(Atom("distance"), type::ScalarType::Int32));
+    REQUIRE_THROWS_AS(reader.importSymbols(conflicting), interface::InterfaceException);
+    REQUIRE(!conflicting.globalScope().findSymbolInCurrentScope(Atom("Point")));
+    REQUIRE(!conflicting.globalScope().findSymbolInCurrentScope(Atom("origin")));
+}
+
+TEST_CASE("module interface hash changes only when the interface does") {
+    auto interfaceHashOf = [](const std::string &src, const std::string &code) {
+        std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+        ast::Module &module = parseModule(src, "library.an");
+        REQUIRE(!ec->prepareModule(&module));
+        interface::CompiledModule compiled;
+        compiled.sourceText = src;
+        compiled.code = code;
+        std::ostringstream out;
+        return interface::writeModuleInterface(module, compiled, out);
+    };
+
+    uint64_t original = interfaceHashOf("func f:int(a:int) a + 1", "code");
+    REQUIRE(interfaceHashOf("func f:int(a:int) a + 1", "other code") == original);
+    REQUIRE(interfaceHashOf("func f:int(a:int) a * 2", "code") == original);
+    REQUIRE(interfaceHashOf("func f:float(a:int) a + 1", "code") != original);
+    REQUIRE(interfaceHashOf("func g:int(a:int) a + 1", "code") != original);
+    REQUIRE(interfaceHashOf("func f:int(a:int) a + 1 v:int = 1", "code") != original);
+}
+
+TEST_CASE("modules are only cached when their interfaces export everything") {
+    auto exportsAll = [](const std::string &src) {
+        std::shared_ptr<execute::ExecutionContext> ec = execute::createExecutionContext();
+        ast::Module &module = parseModule(src, "cached.an");
+        REQUIRE(!ec->prepareModule(&module));
+        return interface::exportsAllSymbols(module);
+    };
+
+    REQUIRE(exportsAll("v:int = 1 func f:int() v class C { c:int }"));
+    REQUIRE(exportsAll("template T<A> func f:A(a:A) a"));
+    REQUIRE(!exportsAll("namespace n { v:int = 1 }"));
+    REQUIRE(!exportsAll("class W<T> { t:T } w:W<int> = new W<int>()"));
+}